@@ -515,7 +515,11 @@ Ax88179Reset (
 
   if (EFI_ERROR(Status)) goto err;
 
-  Val = 12; //AX88179_BULKIN_SIZE_INK - 1;
+  //
+  //  The device sends up to (RXBINQSIZE + 4) KB in one bulk-in transfer,
+  //  so size the RX queue to fill, but not overflow, BulkInbuf
+  //
+  Val = AX88179_BULKIN_SIZE_INK - 4;
   Status =  Ax88179MacWrite (RXBINQSIZE,
                               0x01,
                               NicDevice,
@@ -1040,3 +1044,94 @@ done:
 no_pkt:
    return Status;
 }
+
+
+/**
+  Send the frames batched by SN_Transmit in a single bulk-out transfer.
+
+  The frames' caller buffers become available to SN_GetStatus whether
+  or not the transfer succeeds; a lost frame is recovered by the
+  protocols above.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+  @retval EFI_SUCCESS         The batch was sent, or was empty.
+  @retval EFI_NOT_READY       The transfer timed out.
+  @retval EFI_DEVICE_ERROR    The transfer failed.
+
+**/
+EFI_STATUS
+Ax88179TxFlush (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  EFI_USB_IO_PROTOCOL *UsbIo;
+  EFI_STATUS          Status;
+  UINTN               TransferLength;
+  UINT32              TransferStatus;
+  TX_PACKET           *LastPacket;
+
+  if (NicDevice->TxBatchLength == 0) {
+    return EFI_SUCCESS;
+  }
+
+  gBS->SetTimer (NicDevice->TxFlushTimer, TimerCancel, 0);
+
+  //
+  //  A transfer that is a multiple of the max packet size would need a
+  //  zero length packet to end it.  Pad it instead, and tell the device
+  //  to discard the padding after the last frame.
+  //
+  if ((NicDevice->TxBatchLength % NicDevice->UsbMaxPktSize) == 0) {
+    LastPacket = (TX_PACKET *) &NicDevice->TxBatch[NicDevice->TxLastPacket];
+    LastPacket->TxHdr2 |= TXHDR2_PADDING;
+    ZeroMem (&NicDevice->TxBatch[NicDevice->TxBatchLength], sizeof (UINT32));
+    NicDevice->TxBatchLength += sizeof (UINT32);
+  }
+
+  TransferLength = NicDevice->TxBatchLength;
+
+  //
+  //  Work around USB bus driver bug where a timeout set by receive
+  //  succeeds but the timeout expires immediately after, causing the
+  //  transmit operation to timeout.
+  //
+  UsbIo = NicDevice->UsbIo;
+  Status = UsbIo->UsbBulkTransfer (UsbIo,
+                                     BULK_OUT_ENDPOINT,
+                                     NicDevice->TxBatch,
+                                     &TransferLength,
+                                     0xfffffffe,
+                                     &TransferStatus);
+
+  NicDevice->TxBatchLength = 0;
+  NicDevice->TxPendingHead = NicDevice->TxTail;
+
+  if (!EFI_ERROR (Status)) {
+    Status = EFI_SUCCESS;
+  } else if (EFI_TIMEOUT == Status && EFI_USB_ERR_TIMEOUT == TransferStatus) {
+    Status = EFI_NOT_READY;
+  } else {
+    Status = EFI_DEVICE_ERROR;
+  }
+
+  return Status;
+}
+
+/**
+  Timer notification that sends a partly filled transmit batch, so a
+  frame is never held back for longer than AX88179_TX_FLUSH_DELAY.
+
+  @param [in] Event           The timer event
+  @param [in] Context         Pointer to the NIC_DEVICE structure
+
+**/
+VOID
+EFIAPI
+Ax88179TxFlushTimer (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  )
+{
+  Ax88179TxFlush ((NIC_DEVICE *) Context);
+}
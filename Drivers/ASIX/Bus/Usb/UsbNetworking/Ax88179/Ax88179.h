@@ -69,10 +69,15 @@
 #define USB_NETWORK_CLASS   0x09    ///<  USB Network class code
 #define USB_BUS_TIMEOUT     1000    ///<  USB timeout in milliseconds
 
-#define AX88179_BULKIN_SIZE_INK     2
+#define AX88179_BULKIN_SIZE_INK     16  ///<  One bulk-in URB holds a whole aggregated RX burst
 #define AX88179_MAX_BULKIN_SIZE    (1024 * AX88179_BULKIN_SIZE_INK)
 #define AX88179_MAX_PKT_SIZE  2048
 
+#define AX88179_TX_BATCH_SIZE      (16 * 1024)  ///<  Frames are packed into one bulk-out of up to this size
+#define AX88179_TX_RING_SIZE       32           ///<  Transmit buffers tracked until recycled, power of 2
+#define AX88179_TX_FLUSH_DELAY     10000        ///<  Latest a batched frame is sent, in 100ns units
+#define TXHDR2_PADDING             0x80008000   ///<  Device discards the padding after this frame
+
 #define HC_DEBUG        0
 #define ADD_MACPATHNOD  1
 #define BULKIN_TIMEOUT  3 //5000
@@ -279,14 +284,20 @@ typedef struct {
   UINT8                     *CurPktHdrOff;
   UINT8                     *CurPktOff;
 
-  TX_PACKET                 *TxTest;
+  UINT8                     *TxBatch;           ///<  Frames waiting to go out in the next bulk-out
+  UINTN                     TxBatchLength;
+  UINTN                     TxLastPacket;       ///<  Offset in TxBatch of the last frame's header
+  VOID                      *TxRing[AX88179_TX_RING_SIZE];  ///<  Caller buffers, recycled then pending
+  UINTN                     TxRecycleHead;      ///<  Oldest transmitted buffer not yet returned by GetStatus
+  UINTN                     TxPendingHead;      ///<  Oldest buffer still in TxBatch
+  UINTN                     TxTail;
+  EFI_EVENT                 TxFlushTimer;
 
   INT8                      MulticastHash[8];
   EFI_MAC_ADDRESS           MAC;
 
   UINT16                    CurMediumStatus;
   UINT16                    CurRxControl;
-  VOID *                    TxBuffer;
 
   EFI_DEVICE_PATH_PROTOCOL  *MyDevPath;
   BOOLEAN                   Grub_f;
@@ -1049,5 +1060,17 @@ Ax88179BulkIn(
   IN NIC_DEVICE *NicDevice
 );
 
+EFI_STATUS
+Ax88179TxFlush (
+  IN NIC_DEVICE *NicDevice
+  );
+
+VOID
+EFIAPI
+Ax88179TxFlushTimer (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  );
+
 
 #endif  //  AX88179_H_
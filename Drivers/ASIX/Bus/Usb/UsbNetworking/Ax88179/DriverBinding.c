@@ -277,8 +277,12 @@ ERR:
     gBS->FreePool (NicDevice->BulkInbuf);
   }
 
-  if (NicDevice->TxTest != NULL) {
-    gBS->FreePool (NicDevice->TxTest);
+  if (NicDevice->TxBatch != NULL) {
+    gBS->FreePool (NicDevice->TxBatch);
+  }
+
+  if (NicDevice->TxFlushTimer != NULL) {
+    gBS->CloseEvent (NicDevice->TxFlushTimer);
   }
 
   if (NicDevice->MyDevPath != NULL) {
@@ -441,8 +445,12 @@ DriverStop (
         gBS->FreePool (NicDevice->BulkInbuf);
       }
 
-      if (NicDevice->TxTest != NULL) {
-        gBS->FreePool (NicDevice->TxTest);
+      if (NicDevice->TxBatch != NULL) {
+        gBS->FreePool (NicDevice->TxBatch);
+      }
+
+      if (NicDevice->TxFlushTimer != NULL) {
+        gBS->CloseEvent (NicDevice->TxFlushTimer);
       }
 
       if (NicDevice->MyDevPath != NULL) {
@@ -133,9 +133,20 @@ SN_GetStatus (
     //
     NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
-    if ((TxBuf != NULL) && (NicDevice->TxBuffer != NULL)) {
-      *TxBuf = NicDevice->TxBuffer;
-      NicDevice->TxBuffer = NULL;
+    if (TxBuf != NULL) {
+      //
+      // Only when nothing is left to recycle, send anything still batched
+      // so that its buffers can be recycled
+      //
+      if (NicDevice->TxRecycleHead == NicDevice->TxPendingHead) {
+        Ax88179TxFlush (NicDevice);
+      }
+
+      if (NicDevice->TxRecycleHead != NicDevice->TxPendingHead) {
+        *TxBuf = NicDevice->TxRing[NicDevice->TxRecycleHead++ & (AX88179_TX_RING_SIZE - 1)];
+      } else {
+        *TxBuf = NULL;
+      }
     }
 
     Mode = SimpleNetwork->Mode;
@@ -566,6 +577,11 @@ SN_Receive (
         //  Attempt to do bulk in
         //
         if (NicDevice->PktCnt == 0) {
+          //
+          //  Anything waiting to be sent is most likely what the peer
+          //  is waiting for before it sends more
+          //
+          Ax88179TxFlush (NicDevice);
           Status = Ax88179BulkIn(NicDevice);
           if (EFI_ERROR(Status))
             goto  no_pkt;
@@ -998,10 +1014,29 @@ SN_Setup (
   }
 
   Status = gBS->AllocatePool (EfiBootServicesData,
-                               sizeof (TX_PACKET),
-                               (VOID **) &NicDevice->TxTest);
+                               AX88179_TX_BATCH_SIZE,
+                               (VOID **) &NicDevice->TxBatch);
   if (EFI_ERROR (Status)) {
     gBS->FreePool (NicDevice->BulkInbuf);
+    NicDevice->BulkInbuf = NULL;
+    return Status;
+  }
+
+  NicDevice->TxBatchLength = 0;
+  NicDevice->TxRecycleHead = 0;
+  NicDevice->TxPendingHead = 0;
+  NicDevice->TxTail = 0;
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                             TPL_CALLBACK,
+                             Ax88179TxFlushTimer,
+                             NicDevice,
+                             &NicDevice->TxFlushTimer);
+  if (EFI_ERROR (Status)) {
+    gBS->FreePool (NicDevice->BulkInbuf);
+    NicDevice->BulkInbuf = NULL;
+    gBS->FreePool (NicDevice->TxBatch);
+    NicDevice->TxBatch = NULL;
   }
 
   //
@@ -1340,6 +1375,15 @@ SN_Shutdown (
       //
       NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
+      //
+      // Pending transmits are lost
+      //
+      gBS->SetTimer (NicDevice->TxFlushTimer, TimerCancel, 0);
+      NicDevice->TxBatchLength = 0;
+      NicDevice->TxRecycleHead = 0;
+      NicDevice->TxPendingHead = 0;
+      NicDevice->TxTail = 0;
+
       Status = Ax88179MacAddressGet (NicDevice, &Mode->PermanentAddress.Addr[0]);
       if (!EFI_ERROR (Status)) {
         //
@@ -1423,10 +1467,9 @@ SN_Transmit (
   ETHERNET_HEADER         *Header;
   EFI_SIMPLE_NETWORK_MODE *Mode;
   NIC_DEVICE              *NicDevice;
-  EFI_USB_IO_PROTOCOL     *UsbIo;
+  TX_PACKET               *TxPacket;
   EFI_STATUS              Status;
   UINTN                   TransferLength;
-  UINT32                  TransferStatus;
   UINT16                  Type = 0;
   EFI_TPL                 TplPrevious;
 
@@ -1466,17 +1509,39 @@ SN_Transmit (
           Status = EFI_INVALID_PARAMETER;
           goto EXIT;
         }
+        if (BufferSize > AX88179_MAX_PKT_SIZE) {
+          Status = EFI_INVALID_PARAMETER;
+          goto EXIT;
+        }
         //
-        //  Copy the packet into the USB buffer
+        //  The buffer is only returned by GetStatus once it is recycled
         //
-        // Buffer starting with 14 bytes 0
-        CopyMem (&NicDevice->TxTest->Data[0], Buffer, BufferSize);
-        NicDevice->TxTest->TxHdr1 = (UINT32) BufferSize;
-        NicDevice->TxTest->TxHdr2 = 0;
+        if ((NicDevice->TxTail - NicDevice->TxRecycleHead) >= AX88179_TX_RING_SIZE) {
+          Status = EFI_NOT_READY;
+          goto EXIT;
+        }
         //
-        //  Transmit the packet
+        //  Send the batch first if this frame, its header and the
+        //  padding Ax88179TxFlush may add do not fit
         //
-        Header = (ETHERNET_HEADER *) &NicDevice->TxTest->Data[0];
+        if ((NicDevice->TxBatchLength + sizeof (TxPacket->TxHdr1) + sizeof (TxPacket->TxHdr2)
+             + ALIGN_VALUE (MAX (BufferSize, MIN_ETHERNET_PKT_SIZE), sizeof (UINT32))
+             + sizeof (UINT32)) > AX88179_TX_BATCH_SIZE) {
+          Status = Ax88179TxFlush (NicDevice);
+          if (EFI_ERROR (Status)) {
+            goto EXIT;
+          }
+        }
+        //
+        //  Append the packet to the batch
+        //
+        // Buffer starting with 14 bytes 0
+        TxPacket = (TX_PACKET *) &NicDevice->TxBatch[NicDevice->TxBatchLength];
+        CopyMem (&TxPacket->Data[0], Buffer, BufferSize);
+        TxPacket->TxHdr1 = (UINT32) BufferSize;
+        TxPacket->TxHdr2 = 0;
+
+        Header = (ETHERNET_HEADER *) &TxPacket->Data[0];
         if (HeaderSize != 0) {
           if (DestAddr != NULL) {
             CopyMem (&Header->DestAddr, DestAddr, PXE_HWADDR_LEN_ETHER);
@@ -1495,36 +1560,32 @@ SN_Transmit (
           Header->Type = Type;
         }
 
-        if (NicDevice->TxTest->TxHdr1 < MIN_ETHERNET_PKT_SIZE) {
-          NicDevice->TxTest->TxHdr1 = MIN_ETHERNET_PKT_SIZE;
-          ZeroMem (&NicDevice->TxTest->Data[BufferSize],
+        if (TxPacket->TxHdr1 < MIN_ETHERNET_PKT_SIZE) {
+          TxPacket->TxHdr1 = MIN_ETHERNET_PKT_SIZE;
+          ZeroMem (&TxPacket->Data[BufferSize],
                     MIN_ETHERNET_PKT_SIZE - BufferSize);
         }
 
-        TransferLength = sizeof (NicDevice->TxTest->TxHdr1)
-                       + sizeof (NicDevice->TxTest->TxHdr2)
-                       + NicDevice->TxTest->TxHdr1;
         //
-        //  Work around USB bus driver bug where a timeout set by receive
-        //  succeeds but the timeout expires immediately after, causing the
-        //  transmit operation to timeout.
+        //  Each frame header in the batch starts on a 32-bit boundary
         //
-        UsbIo = NicDevice->UsbIo;
-        Status = UsbIo->UsbBulkTransfer (UsbIo,
-                                           BULK_OUT_ENDPOINT,
-                                           &NicDevice->TxTest->TxHdr1,
-                                           &TransferLength,
-                                           0xfffffffe,
-                                           &TransferStatus);
-
-        if (!EFI_ERROR(Status) && !EFI_ERROR(Status)) {
-          NicDevice->TxBuffer = Buffer;
-          Status = EFI_SUCCESS;
-        } else if (EFI_TIMEOUT == Status && EFI_USB_ERR_TIMEOUT == TransferStatus) {
-          Status = EFI_NOT_READY;
-        } else {
-          Status = EFI_DEVICE_ERROR;
+        TransferLength = ALIGN_VALUE (TxPacket->TxHdr1, sizeof (UINT32));
+        ZeroMem (&TxPacket->Data[TxPacket->TxHdr1], TransferLength - TxPacket->TxHdr1);
+
+        NicDevice->TxLastPacket = NicDevice->TxBatchLength;
+        NicDevice->TxBatchLength += sizeof (TxPacket->TxHdr1)
+                                  + sizeof (TxPacket->TxHdr2)
+                                  + TransferLength;
+        NicDevice->TxRing[NicDevice->TxTail++ & (AX88179_TX_RING_SIZE - 1)] = Buffer;
+
+        //
+        //  Frames that follow closely are packed into the same bulk-out;
+        //  the timer bounds how long the first of them waits
+        //
+        if (NicDevice->TxTail - NicDevice->TxPendingHead == 1) {
+          gBS->SetTimer (NicDevice->TxFlushTimer, TimerRelative, AX88179_TX_FLUSH_DELAY);
         }
+        Status = EFI_SUCCESS;
       } else {
         //
         // No packets available.
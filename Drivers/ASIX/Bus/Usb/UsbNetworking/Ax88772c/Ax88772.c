@@ -1064,6 +1064,116 @@ Ax88772GetLinkStatus (
 
 }
 
+/**
+  Interrupt endpoint completion routine.
+
+  Caches the link state reported by the device and flags a change so
+  that the next ::SN_GetStatus reads the negotiated speed and duplex.
+
+  @param [in] Data            Status report from the interrupt endpoint
+  @param [in] DataLength      Length of the status report
+  @param [in] Context         Pointer to the NIC_DEVICE structure
+  @param [in] Result          USB transfer result
+
+  @retval EFI_SUCCESS          The report was processed
+  @retval EFI_DEVICE_ERROR     The transfer failed and monitoring stopped
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+Ax88772LinkMonitorCallback (
+  IN VOID   *Data,
+  IN UINTN  DataLength,
+  IN VOID   *Context,
+  IN UINT32 Result
+  )
+{
+  NIC_DEVICE *NicDevice;
+  UINT8      LinkStatus;
+  BOOLEAN    LinkUp;
+
+  NicDevice = (NIC_DEVICE *) Context;
+
+  if (Result != EFI_USB_NOERROR) {
+    //
+    //  Fall back to reading the PHY from SN_GetStatus
+    //
+    Ax88772StopLinkMonitor (NicDevice);
+    return EFI_DEVICE_ERROR;
+  }
+
+  if ((Data == NULL) || (DataLength <= INT_LINK_OFFSET)) {
+    return EFI_SUCCESS;
+  }
+
+  LinkStatus = ((UINT8 *) Data)[INT_LINK_OFFSET];
+  LinkUp = (BOOLEAN) (((LinkStatus & INT_PPLS_LINK) != 0) &&
+                      ((LinkStatus & INT_CABOFF_UNPLUG) == 0));
+
+  if (LinkUp != NicDevice->LinkUp) {
+    NicDevice->LinkChanged = TRUE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+Ax88772StartLinkMonitor (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  EFI_USB_IO_PROTOCOL *UsbIo;
+  EFI_STATUS          Status;
+
+  if (NicDevice->LinkMonitorActive) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  //  Read the PHY once to pick up the current state
+  //
+  NicDevice->LinkChanged = TRUE;
+
+  UsbIo = NicDevice->UsbIo;
+  Status = UsbIo->UsbAsyncInterruptTransfer (UsbIo,
+                                              USB_ENDPOINT_DIR_IN | INTERRUPT_ENDPOINT,
+                                              TRUE,
+                                              INT_POLL_INTERVAL,
+                                              INT_DATA_SIZE,
+                                              Ax88772LinkMonitorCallback,
+                                              NicDevice);
+  if (!EFI_ERROR (Status)) {
+    NicDevice->LinkMonitorActive = TRUE;
+  }
+
+  return Status;
+}
+
+VOID
+Ax88772StopLinkMonitor (
+  IN NIC_DEVICE *NicDevice
+  )
+{
+  EFI_USB_IO_PROTOCOL *UsbIo;
+
+  if (!NicDevice->LinkMonitorActive) {
+    return;
+  }
+
+  NicDevice->LinkMonitorActive = FALSE;
+  NicDevice->LinkChanged = TRUE;
+
+  UsbIo = NicDevice->UsbIo;
+  UsbIo->UsbAsyncInterruptTransfer (UsbIo,
+                                     USB_ENDPOINT_DIR_IN | INTERRUPT_ENDPOINT,
+                                     FALSE,
+                                     0,
+                                     0,
+                                     NULL,
+                                     NULL);
+}
+
 #if RXTHOU
 EFI_STATUS
 Ax88772BulkIn(
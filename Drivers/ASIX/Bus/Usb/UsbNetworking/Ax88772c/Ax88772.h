@@ -236,6 +236,16 @@
 #define BULK_IN_ENDPOINT                2       ///<  Receive endpoint
 #define BULK_OUT_ENDPOINT               3       ///<  Transmit endpoint
 
+//------------------------------
+//  Interrupt Endpoint Data
+//------------------------------
+
+#define INT_DATA_SIZE                   8       ///<  Size of the status report on the interrupt endpoint
+#define INT_POLL_INTERVAL               100     ///<  Interrupt endpoint polling interval in milliseconds
+#define INT_LINK_OFFSET                 2       ///<  Offset of the link status byte
+  #define INT_PPLS_LINK                   0x01    ///<  1 = Primary PHY link up
+  #define INT_CABOFF_UNPLUG               0x80    ///<  1 = Cable unplugged
+
 //------------------------------
 //  PHY Registers
 //------------------------------
@@ -354,6 +364,8 @@ typedef struct {
   BOOLEAN                   FullDuplex;         ///<  Current duplex
   BOOLEAN                   LinkUp;             ///<  Current link state
   UINTN                     PollCount;          ///<  Number of times the autonegotiation status was polled
+  BOOLEAN                   LinkMonitorActive;  ///<  Interrupt endpoint is reporting link changes
+  BOOLEAN                   LinkChanged;        ///<  Link change reported since the PHY was last read
   UINT16                    CurRxControl;
   VOID                      *TxBuffer;
   //
@@ -912,6 +924,34 @@ Ax88772GetLinkStatus (
   IN NIC_DEVICE *NicDevice
 ) ;
 
+/**
+  Start monitoring the link state through the interrupt endpoint.
+
+  While the monitor is active, ::SN_GetStatus only reads the PHY when
+  the device reports a link change.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+  @retval EFI_SUCCESS          The asynchronous transfer was queued
+  @retval other                The link state is polled instead
+
+**/
+EFI_STATUS
+Ax88772StartLinkMonitor (
+  IN NIC_DEVICE *NicDevice
+  );
+
+/**
+  Stop monitoring the link state through the interrupt endpoint.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+**/
+VOID
+Ax88772StopLinkMonitor (
+  IN NIC_DEVICE *NicDevice
+  );
+
 //------------------------------------------------------------------------------
 // EFI Component Name Protocol Support
 //------------------------------------------------------------------------------
@@ -422,6 +422,8 @@ DriverStop (
 
     NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
 
+    Ax88772StopLinkMonitor (NicDevice);
+
     gBS->CloseProtocol (
               Controller,
               &gEfiUsbIoProtocolGuid,
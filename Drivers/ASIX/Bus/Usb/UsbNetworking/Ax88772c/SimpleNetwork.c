@@ -146,6 +146,14 @@ SN_GetStatus (
       }
 
 #if REPORTLINK
+      //
+      //  Only go to the PHY when the interrupt endpoint reported a
+      //  change, while negotiation is still in progress, or when the
+      //  endpoint is not being monitored
+      //
+      if (!NicDevice->LinkMonitorActive || NicDevice->LinkChanged ||
+          (NicDevice->LinkUp && !NicDevice->Complete)) {
+        NicDevice->LinkChanged = FALSE;
 #else
       if (!NicDevice->LinkUp || !NicDevice->Complete) {
 #endif
@@ -165,6 +173,7 @@ SN_GetStatus (
         } else {
           Mode->MediaPresent = FALSE;
         }
+      }
 #else
         if (NicDevice->LinkUp && NicDevice->Complete) {
           Mode->MediaPresent = TRUE;
@@ -363,6 +372,7 @@ SN_Initialize (
           Mode->MediaPresentSupported = TRUE;
           NicDevice = DEV_FROM_SIMPLE_NETWORK (SimpleNetwork);
           Mode->MediaPresent = Ax88772GetLinkStatus (NicDevice);
+          Ax88772StartLinkMonitor (NicDevice);
         }
       } else {
         Status = EFI_UNSUPPORTED;
@@ -1355,6 +1365,8 @@ SN_Shutdown (
       //
       // Stop the adapter
       //
+      Ax88772StopLinkMonitor (DEV_FROM_SIMPLE_NETWORK (SimpleNetwork));
+
       RxFilter = Mode->ReceiveFilterSetting;
       Mode->ReceiveFilterSetting = 0;
       Status = SN_Reset (SimpleNetwork, FALSE);
@@ -69,6 +69,177 @@ CheckBounds (
   return EFI_SUCCESS;
 }
 
+/**
+ * Return the number of pixels by which the union of two rectangles exceeds the sum of their areas.
+ * Used to pick which rectangles to merge when the dirty list is full.
+ * @param A
+ * @param B
+ * @param Union   Receives the bounding rectangle of A and B
+ * @return
+ */
+STATIC UINTN
+DirtyRectUnion (
+    IN CONST DISPLAYLINK_DIRTY_RECT *A,
+    IN CONST DISPLAYLINK_DIRTY_RECT *B,
+    OUT DISPLAYLINK_DIRTY_RECT *Union
+    )
+{
+  UINTN X2;
+  UINTN Y2;
+  UINTN UnionArea;
+  UINTN Areas;
+
+  X2 = MAX (A->X + A->Width, B->X + B->Width);
+  Y2 = MAX (A->Y + A->Height, B->Y + B->Height);
+  Union->X = MIN (A->X, B->X);
+  Union->Y = MIN (A->Y, B->Y);
+  Union->Width = X2 - Union->X;
+  Union->Height = Y2 - Union->Y;
+
+  UnionArea = Union->Width * Union->Height;
+  Areas = (A->Width * A->Height) + (B->Width * B->Height);
+  return (UnionArea > Areas) ? UnionArea - Areas : 0;
+}
+
+/**
+ * Check whether two rectangles overlap or share an edge, in which case merging them costs nothing.
+ * @param A
+ * @param B
+ * @return
+ */
+STATIC BOOLEAN
+DirtyRectsTouch (
+    IN CONST DISPLAYLINK_DIRTY_RECT *A,
+    IN CONST DISPLAYLINK_DIRTY_RECT *B
+    )
+{
+  return (A->X <= B->X + B->Width) && (B->X <= A->X + A->Width) &&
+         (A->Y <= B->Y + B->Height) && (B->Y <= A->Y + A->Height);
+}
+
+/**
+ * Forget all the dirty areas of the screen, e.g. after they have been sent to the device.
+ * @param UsbDisplayLinkDev
+ */
+VOID
+DlGopClearDirtyRects (
+    IN USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
+    )
+{
+  UsbDisplayLinkDev->NumDirtyRects = 0;
+}
+
+/**
+ * Make the next screen update resend the whole screen, whether or not its contents have changed,
+ * e.g. because the device's copy of the frame can no longer be trusted.
+ * Raises to TPL_NOTIFY, as Blt updates the same dirty list, so this is safe to call from any TPL up to that.
+ * @param UsbDisplayLinkDev
+ */
+VOID
+DlGopRequestFullScreenUpdate (
+    IN USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
+    )
+{
+  EFI_TPL OriginalTPL;
+
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  UsbDisplayLinkDev->FullScreenUpdatePending = TRUE;
+  DlGopAddDirtyRect (
+    UsbDisplayLinkDev,
+    0,
+    0,
+    UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution,
+    UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->VerticalResolution);
+  gBS->RestoreTPL (OriginalTPL);
+}
+
+/**
+ * Record an area of the screen that needs to be sent in the next screen update.
+ * Rectangles that overlap or touch are coalesced. If the list is full, the pair of rectangles whose
+ * bounding box wastes the fewest pixels is merged to make room.
+ * Must be called at TPL_NOTIFY, the TPL at which Blt updates the dirty list.
+ * @param UsbDisplayLinkDev
+ * @param X
+ * @param Y
+ * @param Width
+ * @param Height
+ */
+VOID
+DlGopAddDirtyRect (
+    IN USB_DISPLAYLINK_DEV* UsbDisplayLinkDev,
+    IN UINTN X,
+    IN UINTN Y,
+    IN UINTN Width,
+    IN UINTN Height
+    )
+{
+  DISPLAYLINK_DIRTY_RECT New;
+  DISPLAYLINK_DIRTY_RECT Union;
+  DISPLAYLINK_DIRTY_RECT *Rects;
+  DISPLAYLINK_DIRTY_RECT Candidates[DISPLAYLINK_MAX_DIRTY_RECTS + 1];
+  UINTN Index;
+  UINTN Other;
+  UINTN Cost;
+  UINTN BestCost;
+  UINTN BestA;
+  UINTN BestB;
+
+  if (Width == 0 || Height == 0) {
+    return;
+  }
+
+  Rects = UsbDisplayLinkDev->DirtyRects;
+  New.X = X;
+  New.Y = Y;
+  New.Width = Width;
+  New.Height = Height;
+
+  // Keep absorbing existing rectangles until the new one no longer touches any of them
+  Index = 0;
+  while (Index < UsbDisplayLinkDev->NumDirtyRects) {
+    if (DirtyRectsTouch (&Rects[Index], &New)) {
+      DirtyRectUnion (&Rects[Index], &New, &New);
+      Rects[Index] = Rects[--UsbDisplayLinkDev->NumDirtyRects];
+      Index = 0;
+    } else {
+      Index++;
+    }
+  }
+
+  if (UsbDisplayLinkDev->NumDirtyRects == DISPLAYLINK_MAX_DIRTY_RECTS) {
+    CopyMem (Candidates, Rects, sizeof (UsbDisplayLinkDev->DirtyRects));
+    Candidates[DISPLAYLINK_MAX_DIRTY_RECTS] = New;
+
+    BestCost = MAX_UINTN;
+    BestA = 0;
+    BestB = 1;
+    for (Index = 0; Index < DISPLAYLINK_MAX_DIRTY_RECTS; Index++) {
+      for (Other = Index + 1; Other <= DISPLAYLINK_MAX_DIRTY_RECTS; Other++) {
+        Cost = DirtyRectUnion (&Candidates[Index], &Candidates[Other], &Union);
+        if (Cost < BestCost) {
+          BestCost = Cost;
+          BestA = Index;
+          BestB = Other;
+        }
+      }
+    }
+
+    UsbDisplayLinkDev->NumDirtyRects = 0;
+    for (Index = 0; Index <= DISPLAYLINK_MAX_DIRTY_RECTS; Index++) {
+      if (Index != BestA && Index != BestB) {
+        Rects[UsbDisplayLinkDev->NumDirtyRects++] = Candidates[Index];
+      }
+    }
+
+    // The merged rectangle may now touch others, so insert it the normal way.
+    DirtyRectUnion (&Candidates[BestA], &Candidates[BestB], &New);
+    DlGopAddDirtyRect (UsbDisplayLinkDev, New.X, New.Y, New.Width, New.Height);
+    return;
+  }
+
+  Rects[UsbDisplayLinkDev->NumDirtyRects++] = New;
+}
+
 /**
  * Update the local copy of the Frame Buffer. This local copy is periodically transmitted to the
  * DisplayLink device (via DlGopSendScreenUpdate)
@@ -101,6 +272,12 @@ BuildBackBuffer (
 {
   UINTN H;
   UINTN W;
+
+  // Update the store of the areas of the screen that are "dirty" - that we need to send in the next screen update.
+  if (BltOperation != EfiBltVideoToBltBuffer) {
+    DlGopAddDirtyRect (UsbDisplayLinkDev, DestinationX, DestinationY, Width, Height);
+  }
+
   switch (BltOperation) {
   case EfiBltVideoToBltBuffer:
   {
@@ -121,14 +298,6 @@ BuildBackBuffer (
 
   case EfiBltBufferToVideo:
   {
-    // Update the store of the area of the screen that is "dirty" - that we need to send in the next screen update.
-    if (DestinationY < UsbDisplayLinkDev->LastY1) {
-      UsbDisplayLinkDev->LastY1 = DestinationY;
-    }
-    if ((DestinationY + Height) > UsbDisplayLinkDev->LastY2) {
-      UsbDisplayLinkDev->LastY2 = DestinationY + Height;
-    }
-
     EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Blt;
     EFI_GRAPHICS_OUTPUT_BLT_PIXEL* DstB;
     Blt = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)(((UINT8 *)BltBuffer) + (SourceY * BltBufferStride) + SourceX * sizeof *Blt);
@@ -247,99 +416,180 @@ DlGopSendTestPattern (
   DlUsbBulkWrite (UsbDisplayLinkDev, DstBuf, 1, &USBStatus);
   FreePool (DstBuf);
 
+  // The pattern has overwritten the whole frame on the device, so the next screen update must resend all of it.
+  DlGopRequestFullScreenUpdate (UsbDisplayLinkDev);
+
   return Status;
 }
 
 
 /**
- * Transfer the latest copy of the Blt buffer over USB to the DisplayLink device
+ * Convert the dirty areas of the back buffer into the RGB888 transfer buffer
  * @param UsbDisplayLinkDev
- * @return
+ * @return The number of scanlines, counting from the top of the screen, that differ from what the device was last sent
  */
-EFI_STATUS
-DlGopSendScreenUpdate (
+STATIC UINTN
+ConvertDirtyRects (
     IN USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
     )
 {
-  EFI_STATUS Status;
-  UINT32 USBStatus;
-  Status = EFI_SUCCESS;
+  DISPLAYLINK_DIRTY_RECT* Rect;
+  UINTN ScreenWidth;
+  UINTN LastLine;
+  UINTN Index;
+  UINTN H;
+
+  ScreenWidth = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution;
+  LastLine = 0;
+
+  for (Index = 0; Index < UsbDisplayLinkDev->NumDirtyRects; Index++) {
+    Rect = &UsbDisplayLinkDev->DirtyRects[Index];
+
+    for (H = Rect->Y; H < Rect->Y + Rect->Height; H++) {
+      // A BLT that rewrites the same pixels (e.g. a full repaint of a menu) leaves the line unchanged,
+      // and need not extend the frame.
+      if (DlConvertBgrxToRgb888 (
+            UsbDisplayLinkDev->Screen + (H * ScreenWidth) + Rect->X,
+            UsbDisplayLinkDev->TransferBuffer + (((H * ScreenWidth) + Rect->X) * DISPLAYLINK_BYTES_PER_PIXEL),
+            Rect->Width)) {
+        LastLine = MAX (LastLine, H + 1);
+      }
+    }
+  }
+
+  return LastLine;
+}
+
+/**
+ * Snapshot the dirty areas of the back buffer into the transfer buffer and start streaming a new frame.
+ * @param UsbDisplayLinkDev
+ * @return TRUE if there is a frame to send
+ */
+STATIC BOOLEAN
+StartScreenUpdate (
+    IN USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
+    )
+{
+  EFI_TPL OriginalTPL;
+  UINTN Width;
+  UINTN Height;
+
+  Width = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution;
+  Height = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->VerticalResolution;
+
+  // Lock out Blt only while the dirty list is read and the dirty areas are converted. Anything BLTted
+  // while the frame is being streamed goes into the dirty list for the next frame and cannot tear this one.
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
 
   // If it has been a while since we sent an update, send a full screen.
   // This allows us to update a hot-plugged monitor quickly.
   if (UsbDisplayLinkDev->TimeSinceLastScreenUpdate > DISPLAYLINK_FULL_SCREEN_UPDATE_PERIOD) {
-    UsbDisplayLinkDev->LastY1 = 0;
-    UsbDisplayLinkDev->LastY2 = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution - 1;
+    DlGopRequestFullScreenUpdate (UsbDisplayLinkDev);
   }
 
   // If there has been no BLT since the last update/poll, drop out quietly.
-  if (UsbDisplayLinkDev->LastY2 < UsbDisplayLinkDev->LastY1) {
+  if (UsbDisplayLinkDev->NumDirtyRects == 0) {
+    gBS->RestoreTPL (OriginalTPL);
     UsbDisplayLinkDev->TimeSinceLastScreenUpdate += (DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD / 1000);  // Convert us to ms
-    return EFI_SUCCESS;
+    return FALSE;
   }
 
   UsbDisplayLinkDev->TimeSinceLastScreenUpdate = 0;
 
-  EFI_TPL OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  UsbDisplayLinkDev->FrameLastLine = ConvertDirtyRects (UsbDisplayLinkDev);
+  if (UsbDisplayLinkDev->FullScreenUpdatePending) {
+    UsbDisplayLinkDev->FrameLastLine = Height;
+    UsbDisplayLinkDev->FullScreenUpdatePending = FALSE;
+  }
+  DlGopClearDirtyRects (UsbDisplayLinkDev);
+  gBS->RestoreTPL (OriginalTPL);
+
+  // Every dirty pixel matched what the device already has
+  if (UsbDisplayLinkDev->FrameLastLine == 0) {
+    return FALSE;
+  }
+
+  UsbDisplayLinkDev->FrameNextLine = 0;
+  UsbDisplayLinkDev->FrameInProgress = TRUE;
+  return TRUE;
+}
 
+/**
+ * Transfer the dirty areas of the Blt buffer over USB to the DisplayLink device.
+ * At most DISPLAYLINK_SLICE_MAX_BYTES are sent per call; FrameInProgress stays set until the whole frame has gone,
+ * and the caller should call again after DISPLAYLINK_SLICE_TIMER_PERIOD.
+ * @param UsbDisplayLinkDev
+ * @return
+ */
+EFI_STATUS
+DlGopSendScreenUpdate (
+    IN USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
+    )
+{
+  EFI_STATUS Status;
+  UINT32 USBStatus;
   UINTN DataLen;
-  UINTN Width;
-  UINTN Height;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcPtr;
-  UINT8* DstPtr;
-  UINT8 DstBuffer[1920 * 3]; // Get rid of the magic numbers at some point
-                             // Could also use a buffer allocated at runtime to store the line, stored in the USB_DISPLAYLINK_DEV structure.
+  UINTN SliceBytes;
+  UINT8* LinePtr;
   UINTN H;
 
-  DataLen = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution * 3; // Send 1 line @ 24 bits per pixel
-  Width = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution;
-  Height = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->VerticalResolution;
-  SrcPtr = UsbDisplayLinkDev->Screen;
-  DstPtr = DstBuffer;
-
-  for (H = 0; H < Height; H++) {
-    DstPtr = DstBuffer;
-
-    UINTN W;
-    for (W = 0; W < Width; W++) {
-      // Need to swap round the RGB values
-      DstPtr[0] = ((UINT8 *)SrcPtr)[2];
-      DstPtr[1] = ((UINT8 *)SrcPtr)[1];
-      DstPtr[2] = ((UINT8 *)SrcPtr)[0];
-      SrcPtr++;
-      DstPtr += 3;
-    }
+  Status = EFI_SUCCESS;
 
-    Status = DlUsbBulkWrite (UsbDisplayLinkDev, DstBuffer, DataLen, &USBStatus);
+  if (UsbDisplayLinkDev->Screen == NULL || UsbDisplayLinkDev->TransferBuffer == NULL) {
+    return EFI_NOT_READY;
+  }
+
+  if (!UsbDisplayLinkDev->FrameInProgress && !StartScreenUpdate (UsbDisplayLinkDev)) {
+    return EFI_SUCCESS;
+  }
+
+  // The device keeps the previous frame, and scanlines are always sent in order from the top of the screen.
+  // The frame can therefore be terminated straight after the last damaged scanline - everything below it is unchanged.
+  DataLen = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution * DISPLAYLINK_BYTES_PER_PIXEL; // Send 1 line @ 24 bits per pixel
+  SliceBytes = 0;
+
+  for (H = UsbDisplayLinkDev->FrameNextLine; H < UsbDisplayLinkDev->FrameLastLine && SliceBytes < DISPLAYLINK_SLICE_MAX_BYTES; H++) {
+    LinePtr = UsbDisplayLinkDev->TransferBuffer + (H * DataLen);
+    Status = DlUsbBulkWrite (UsbDisplayLinkDev, LinePtr, DataLen, &USBStatus);
 
     // USBStatus values defined in usbio.h, e.g. EFI_USB_ERR_TIMEOUT 0x40
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Screen update - USB bulk transfer of pixel data failed. Line %d len %d, failure code %r USB status x%x\n", H, DataLen, Status, USBStatus));
       break;
     }
+    SliceBytes += DataLen;
+
     // Need an extra DlUsbBulkWrite if the data length is divisible by USB MaxPacketSize. This spare data will just get written into the (invisible) stride area.
     // Note that the API doesn't let us do a bulk write of 0.
     if ((DataLen & (UsbDisplayLinkDev->BulkOutEndpointDescriptor.MaxPacketSize - 1)) == 0) {
-      Status = DlUsbBulkWrite (UsbDisplayLinkDev, DstBuffer, 2, &USBStatus);
+      Status = DlUsbBulkWrite (UsbDisplayLinkDev, LinePtr, 2, &USBStatus);
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "Screen update - USB bulk transfer of pixel data failed. Line %d len %d, failure code %r USB status x%x\n", H, DataLen, Status, USBStatus));
         break;
       }
+      SliceBytes += 2;
     }
   }
 
-  if (!EFI_ERROR (Status)) {
-    // If we've successfully transmitted the frame, reset the values that store which area of the screen has been BLTted to.
-    // If we haven't succeeded, this will mean we'll try to resend it after the next poll period.
-    UsbDisplayLinkDev->LastY2 = 0;
-    UsbDisplayLinkDev->LastY1 = (UINTN)-1;
+  UsbDisplayLinkDev->FrameNextLine = H;
+  UsbDisplayLinkDev->DataSent += SliceBytes;
+
+  if (EFI_ERROR (Status)) {
+    // The snapshot has already been taken off the dirty list and converted, so the device's copy is now unknown.
+    // This will mean we'll resend the whole screen after the next poll period.
+    DlGopRequestFullScreenUpdate (UsbDisplayLinkDev);
+  } else if (H < UsbDisplayLinkDev->FrameLastLine) {
+    // More of this frame to come in the next slice
+    return EFI_SUCCESS;
+  } else {
+    UsbDisplayLinkDev->FramesSent++;
   }
 
   // Payload with length of 1 to terminate the frame
   // We need to do this even if we had an error, to indicate to the DL device that it should now expect a new frame.
-  DlUsbBulkWrite (UsbDisplayLinkDev, DstBuffer, 1, &USBStatus);
-
-  gBS->RestoreTPL (OriginalTPL);
+  DlUsbBulkWrite (UsbDisplayLinkDev, UsbDisplayLinkDev->TransferBuffer, 1, &USBStatus);
+  UsbDisplayLinkDev->DataSent++;
+  UsbDisplayLinkDev->FrameInProgress = FALSE;
 
   return Status;
 }
@@ -446,6 +696,7 @@ DisplayLinkSetMode (
   USB_DISPLAYLINK_DEV *UsbDisplayLinkDev;
   EFI_STATUS Status;
   CONST struct VideoMode *VideoMode;
+  EFI_TPL OriginalTPL;
 
   UsbDisplayLinkDev = USB_DISPLAYLINK_DEV_FROM_GRAPHICS_OUTPUT_PROTOCOL(Gop);
 
@@ -486,6 +737,30 @@ DisplayLinkSetMode (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  //
+  // Allocate the RGB888 copy of the back buffer that is sent to the device
+  //
+  if (UsbDisplayLinkDev->TransferBuffer != NULL) {
+    FreePool (UsbDisplayLinkDev->TransferBuffer);
+  }
+
+  UsbDisplayLinkDev->TransferBuffer = (UINT8*)AllocateZeroPool (
+    Gop->Mode->Info->HorizontalResolution *
+    Gop->Mode->Info->VerticalResolution *
+    DISPLAYLINK_BYTES_PER_PIXEL);
+
+  if (UsbDisplayLinkDev->TransferBuffer == NULL) {
+    FreePool (UsbDisplayLinkDev->Screen);
+    UsbDisplayLinkDev->Screen = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  DlGopClearDirtyRects (UsbDisplayLinkDev);
+  UsbDisplayLinkDev->FrameInProgress = FALSE;
+  UsbDisplayLinkDev->FullScreenUpdatePending = TRUE;
+  gBS->RestoreTPL (OriginalTPL);
+
   DEBUG ((DEBUG_INFO, "Video mode %d selected by BIOS - %d x %d.\n", ModeNumber, VideoMode->HActive, VideoMode->VActive));
   // Wait until we are sure that we can set the video mode before we tell the firmware
   Status = DlUsbSendControlWriteMessage (UsbDisplayLinkDev, SET_VIDEO_MODE, 0, VideoMode, sizeof (struct VideoMode));
@@ -0,0 +1,94 @@
+/**
+ * @file PixelConversion.c
+ * @brief Conversion of GOP BLT pixels to the RGB888 format sent to the DisplayLink device.
+ *
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+**/
+
+#include "UsbDisplayLink.h"
+
+#include <Library/BaseLib.h>
+
+/**
+ * Pack one BLT pixel (B, G, R, X in memory) into the low 24 bits of a UINT32 holding R, G, B in memory order.
+ * @param Pixel
+ * @return
+ */
+STATIC inline UINT32
+BgrxToRgb (
+    IN UINT32 Pixel
+    )
+{
+  return SwapBytes32 (Pixel) >> 8;
+}
+
+/**
+ * Convert a run of BLT pixels to RGB888, as expected by the DisplayLink device, and report whether
+ * the destination actually changed. The destination holds the pixels last sent to the device, so this
+ * doubles as a delta check against the previous frame.
+ *
+ * Pixels are converted four at a time: four 32-bit source pixels become three 32-bit destination words,
+ * which keeps the loop to word-sized loads and stores instead of three byte stores per pixel.
+ *
+ * @param Src        Source pixels
+ * @param Dst        RGB888 destination, 3 bytes per pixel. Need not be aligned.
+ * @param NumPixels  Number of pixels to convert
+ * @return TRUE if any byte of Dst was changed
+ */
+BOOLEAN
+DlConvertBgrxToRgb888 (
+    IN CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Src,
+    IN OUT UINT8 *Dst,
+    IN UINTN NumPixels
+    )
+{
+  CONST UINT32 *SrcPtr;
+  UINT32 P0;
+  UINT32 P1;
+  UINT32 P2;
+  UINT32 P3;
+  UINT32 W0;
+  UINT32 W1;
+  UINT32 W2;
+  UINT32 Diff;
+  UINTN Index;
+
+  SrcPtr = (CONST UINT32 *)Src;
+  Diff = 0;
+
+  for (Index = 0; Index + 4 <= NumPixels; Index += 4) {
+    P0 = BgrxToRgb (SrcPtr[0]);
+    P1 = BgrxToRgb (SrcPtr[1]);
+    P2 = BgrxToRgb (SrcPtr[2]);
+    P3 = BgrxToRgb (SrcPtr[3]);
+
+    W0 = P0 | (P1 << 24);
+    W1 = (P1 >> 8) | (P2 << 16);
+    W2 = (P2 >> 16) | (P3 << 8);
+
+    Diff |= (ReadUnaligned32 ((UINT32 *)&Dst[0]) ^ W0) |
+            (ReadUnaligned32 ((UINT32 *)&Dst[4]) ^ W1) |
+            (ReadUnaligned32 ((UINT32 *)&Dst[8]) ^ W2);
+
+    WriteUnaligned32 ((UINT32 *)&Dst[0], W0);
+    WriteUnaligned32 ((UINT32 *)&Dst[4], W1);
+    WriteUnaligned32 ((UINT32 *)&Dst[8], W2);
+
+    SrcPtr += 4;
+    Dst += 4 * DISPLAYLINK_BYTES_PER_PIXEL;
+  }
+
+  for (; Index < NumPixels; Index++) {
+    P0 = BgrxToRgb (*SrcPtr++);
+    Diff |= (Dst[0] ^ (UINT8)P0) | (Dst[1] ^ (UINT8)(P0 >> 8)) | (Dst[2] ^ (UINT8)(P0 >> 16));
+    Dst[0] = (UINT8)P0;
+    Dst[1] = (UINT8)(P0 >> 8);
+    Dst[2] = (UINT8)(P0 >> 16);
+    Dst += DISPLAYLINK_BYTES_PER_PIXEL;
+  }
+
+  return Diff != 0;
+}
@@ -159,8 +159,7 @@ InitializeUsbDisplayLinkDevice (
   Gop->Mode->FrameBufferSize = 0;
 
   // Prevent DlGopSendScreenUpdate from running until we are sure that the video mode is set
-  UsbDisplayLinkDev->LastY2 = 0;
-  UsbDisplayLinkDev->LastY1 = (UINTN)-1;
+  DlGopClearDirtyRects (UsbDisplayLinkDev);
 
   return EFI_SUCCESS;
 }
@@ -438,6 +437,12 @@ DisplayLinkCopyFromPrimaryGopDevice (
   EFI_HANDLE *HandleBuffer;
   UINTN HandleIndex;
   EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *FrameBuffer;
+  UINTN Width;
+  UINTN Height;
+  UINTN Delta;
+  UINTN Line;
+  UINTN RunStart;
 
   gBS->LocateHandleBuffer (
     ByProtocol,
@@ -450,28 +455,37 @@ DisplayLinkCopyFromPrimaryGopDevice (
     gBS->HandleProtocol (HandleBuffer[HandleIndex], &gEfiGraphicsOutputProtocolGuid, (VOID**)&Gop);
     if (Gop != &UsbDisplayLinkDev->GraphicsOutputProtocol && Gop->Mode->FrameBufferBase != (EFI_PHYSICAL_ADDRESS)(UINTN)NULL) {
 
-    // See if we need to do a screen update - calculate a really noddy hash to see if any screen updates have happened.
-    STATIC UINT32 prevframeBufferHash = 0; // 4 bytes per pixel
-    UINT32 currFrameBufferHash = 0;
-    UINTN i;
-    for (i = 0; i < (Gop->Mode->Info->HorizontalResolution * Gop->Mode->Info->VerticalResolution); i++) {
-      currFrameBufferHash += ((UINT32*)(UINTN)Gop->Mode->FrameBufferBase)[i];
-    }
-
-    if (currFrameBufferHash != prevframeBufferHash) {
-      prevframeBufferHash = currFrameBufferHash;
-
-      DisplayLinkBlt (
-        &UsbDisplayLinkDev->GraphicsOutputProtocol,
-        (EFI_GRAPHICS_OUTPUT_BLT_PIXEL*)(UINTN)Gop->Mode->FrameBufferBase,
-        EfiBltBufferToVideo,
-        0,
-        0,
-        0,
-        0,
-        Gop->Mode->Info->HorizontalResolution,
-        Gop->Mode->Info->VerticalResolution,
-        0);
+      // Compare each line of the primary frame buffer with our back buffer, and only BLT runs of lines that differ.
+      // This replaces a checksum of the whole frame buffer followed by a full screen BLT.
+      Width = MIN (Gop->Mode->Info->HorizontalResolution, UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution);
+      Height = MIN (Gop->Mode->Info->VerticalResolution, UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->VerticalResolution);
+      Delta = Gop->Mode->Info->PixelsPerScanLine * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+      FrameBuffer = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL*)(UINTN)Gop->Mode->FrameBufferBase;
+      RunStart = 0;
+
+      for (Line = 0; Line <= Height; Line++) {
+        if (Line < Height &&
+            CompareMem (
+              FrameBuffer + (Line * Gop->Mode->Info->PixelsPerScanLine),
+              UsbDisplayLinkDev->Screen + (Line * UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->PixelsPerScanLine),
+              Width * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)) != 0) {
+          continue;
+        }
+
+        if (Line > RunStart) {
+          DisplayLinkBlt (
+            &UsbDisplayLinkDev->GraphicsOutputProtocol,
+            FrameBuffer,
+            EfiBltBufferToVideo,
+            0,
+            RunStart,
+            0,
+            RunStart,
+            Width,
+            Line - RunStart,
+            Delta);
+        }
+        RunStart = Line + 1;
       }
       break;
     }
@@ -524,6 +538,11 @@ DisplayLinkPeriodicTimer (
     return;
   }
 
+  // Carry on streaming the frame in progress before looking for new screen contents
+  if (UsbDisplayLinkDev->FrameInProgress) {
+    goto SendUpdate;
+  }
+
 #ifdef COPY_PIXELS_FROM_PRIMARY_GOP_DEVICE
   DisplayLinkCopyFromPrimaryGopDevice (UsbDisplayLinkDev);
 #endif // COPY_PIXELS_FROM_PRIMARY_GOP_DEVICE
@@ -533,7 +552,9 @@ DisplayLinkPeriodicTimer (
 
     if (Count++ % 50 == 0) {
       DlGopPrintTextToScreen (&UsbDisplayLinkDev->GraphicsOutputProtocol, 32, 48, (CONST CHAR16*)L"  Bandwidth: %d MB/s    ", UsbDisplayLinkDev->DataSent * 10000000 / DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD / 50 / 1024 / 1024);
+      DlGopPrintTextToScreen (&UsbDisplayLinkDev->GraphicsOutputProtocol, 32, 64, (CONST CHAR16*)L"  Bytes/frame: %d    ", (UsbDisplayLinkDev->FramesSent == 0) ? 0 : UsbDisplayLinkDev->DataSent / UsbDisplayLinkDev->FramesSent);
       UsbDisplayLinkDev->DataSent = 0;
+      UsbDisplayLinkDev->FramesSent = 0;
     }
   }
 
@@ -549,11 +570,16 @@ DisplayLinkPeriodicTimer (
 
   }
 
-  // Send the latest version of the frame buffer to the DL device over USB
+SendUpdate:
+  // Send the next slice of the latest version of the frame buffer to the DL device over USB
   DlGopSendScreenUpdate (UsbDisplayLinkDev);
 
-  // Restart the timer now we've finished
-  Status = gBS->SetTimer (UsbDisplayLinkDev->TimerEvent, TimerRelative, DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD);
+  // Restart the timer now we've finished. If the frame is only partly sent, come back for the next slice
+  // as soon as the rest of the firmware has had a chance to run.
+  Status = gBS->SetTimer (
+                  UsbDisplayLinkDev->TimerEvent,
+                  TimerRelative,
+                  UsbDisplayLinkDev->FrameInProgress ? DISPLAYLINK_SLICE_TIMER_PERIOD : DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to create timer.\n"));
   }
@@ -1065,6 +1091,11 @@ UsbDisplayLinkDriverBindingStop (
     UsbDisplayLinkDev->Screen = NULL;
   }
 
+  if (UsbDisplayLinkDev->TransferBuffer != NULL) {
+    FreePool (UsbDisplayLinkDev->TransferBuffer);
+    UsbDisplayLinkDev->TransferBuffer = NULL;
+  }
+
   if (UsbDisplayLinkDev->GraphicsOutputProtocol.Mode) {
     if (UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info) {
       FreePool (UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info);
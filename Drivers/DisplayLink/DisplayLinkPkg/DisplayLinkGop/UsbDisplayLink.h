@@ -42,6 +42,10 @@
 #define DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD  ((UINTN)1000000) // 0.1s in us
 #define DISPLAYLINK_FULL_SCREEN_UPDATE_PERIOD   ((UINTN)30000) // 3s in ticks
 
+// A frame is streamed to the device in slices, so that the timer callback never holds the CPU for a whole frame.
+#define DISPLAYLINK_SLICE_TIMER_PERIOD          ((UINTN)10000) // 1ms, in 100ns units
+#define DISPLAYLINK_SLICE_MAX_BYTES             ((UINTN)(4 * USB_TRANSFER_LENGTH))
+
 #define DISPLAYLINK_FIXED_VERTICAL_REFRESH_RATE ((UINT16)60)
 
 // Requests to read values from the firmware
@@ -65,6 +69,19 @@ typedef struct {
 
 #define GRAPHICS_OUTPUT_INVALID_MODE_NUMBER 0xffff
 
+#define DISPLAYLINK_BYTES_PER_PIXEL             3
+#define DISPLAYLINK_MAX_DIRTY_RECTS             8
+
+/**
+ *  An area of the back buffer that has been BLTted to since the last screen update.
+ */
+typedef struct {
+  UINTN                      X;
+  UINTN                      Y;
+  UINTN                      Width;
+  UINTN                      Height;
+} DISPLAYLINK_DIRTY_RECT;
+
 /**
  *  Device instance of USB display.
  */
@@ -85,10 +102,16 @@ typedef struct {
   EFI_EVENT                     DriverExitBootServicesEvent;
   BOOLEAN                       ShowBandwidth;                 /** Debugging - show the bandwidth on the screen */
   BOOLEAN                       ShowTestPattern;               /** Show a colourbar pattern instead of the BLTd contents of the framebuffer */
-  UINTN                         LastY1;                        /** Used to track if we can do a partial screen update */
-  UINTN                         LastY2;
   UINTN                         LastWidth;
   UINTN                         TimeSinceLastScreenUpdate;     /** Do a full screen update every (x) seconds */
+  DISPLAYLINK_DIRTY_RECT        DirtyRects[DISPLAYLINK_MAX_DIRTY_RECTS]; /** Areas of the screen to send in the next screen update */
+  UINTN                         NumDirtyRects;
+  UINT8                         *TransferBuffer;               /** RGB888 copy of the back buffer, as sent to the device */
+  UINTN                         FramesSent;                    /** Debug - used to track the bytes sent per frame */
+  BOOLEAN                       FullScreenUpdatePending;       /** Resend every scanline in the next frame, even if unchanged */
+  BOOLEAN                       FrameInProgress;               /** A frame has been snapshotted into TransferBuffer and is being streamed */
+  UINTN                         FrameNextLine;                 /** Next scanline of the frame in progress to send */
+  UINTN                         FrameLastLine;                 /** The frame in progress ends after this many scanlines */
 } USB_DISPLAYLINK_DEV;
 
 #define USB_DISPLAYLINK_DEV_SIGNATURE SIGNATURE_32 ('d', 'l', 'i', 'n')
@@ -224,6 +247,32 @@ DlGopSendScreenUpdate (
   USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
 );
 
+VOID
+DlGopAddDirtyRect (
+  USB_DISPLAYLINK_DEV* UsbDisplayLinkDev,
+  UINTN X,
+  UINTN Y,
+  UINTN Width,
+  UINTN Height
+);
+
+VOID
+DlGopClearDirtyRects (
+  USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
+);
+
+VOID
+DlGopRequestFullScreenUpdate (
+  USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
+);
+
+BOOLEAN
+DlConvertBgrxToRgb888 (
+  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Src,
+  UINT8 *Dst,
+  UINTN NumPixels
+);
+
 
 /* ******************************************* */
 /* ********  USB interface functions  ******** */
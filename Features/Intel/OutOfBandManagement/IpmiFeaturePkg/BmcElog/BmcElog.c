@@ -14,6 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/IpmiCommandLib.h>
+#include <Library/IpmiAsyncCommandLib.h>
 
 EFI_STATUS
 EFIAPI
@@ -198,6 +199,45 @@ Returns:
   return EFI_SUCCESS;
 }
 
+VOID
+EFIAPI
+SelInfoCallback (
+  IN EFI_STATUS  Status,
+  IN UINT8       *ResponseData,
+  IN UINT32      ResponseDataSize,
+  IN VOID        *Context
+  )
+/*++
+
+  Routine Description:
+    Completion of the queued Get SEL Info command.
+
+  Arguments:
+    Status           - Status of the command
+    ResponseData     - IPMI_GET_SEL_INFO_RESPONSE from the BMC
+    ResponseDataSize - Size of ResponseData
+    Context          - Not used
+
+  Returns:
+    None
+
+--*/
+{
+  IPMI_GET_SEL_INFO_RESPONSE  *SelInfo;
+  UINT8                       SelIsFull;
+
+  if (EFI_ERROR (Status) || ResponseDataSize < sizeof (*SelInfo)) {
+    return;
+  }
+  SelInfo = (IPMI_GET_SEL_INFO_RESPONSE *)ResponseData;
+
+  //
+  // Check the Bit7 of the OperationByte if SEL is OverFlow.
+  //
+  SelIsFull = (SelInfo->OperationSupport & 0x80);
+  DEBUG ((DEBUG_INFO, "SelIsFull - 0x%x\n", SelIsFull));
+}
+
 EFI_STATUS
 EFIAPI
 CheckIfSelIsFull (
@@ -218,19 +258,23 @@ CheckIfSelIsFull (
 --*/
 {
   EFI_STATUS                  Status;
-  UINT8                       SelIsFull;
-  IPMI_GET_SEL_INFO_RESPONSE  SelInfo;
 
-  Status = IpmiGetSelInfo (&SelInfo);
+  //
+  // Nothing waits for the answer, so let the command go out in the background.
+  //
+  Status = IpmiSubmitCommandAsync (
+             IPMI_NETFN_STORAGE,
+             IPMI_STORAGE_GET_SEL_INFO,
+             NULL,
+             0,
+             sizeof (IPMI_GET_SEL_INFO_RESPONSE),
+             SelInfoCallback,
+             NULL,
+             NULL
+             );
   if (EFI_ERROR (Status)) {
     return EFI_DEVICE_ERROR;
   }
 
-  //
-  // Check the Bit7 of the OperationByte if SEL is OverFlow.
-  //
-  SelIsFull = (SelInfo.OperationSupport & 0x80);
-  DEBUG ((DEBUG_INFO, "SelIsFull - 0x%x\n", SelIsFull));
-
   return EFI_SUCCESS;
 }
@@ -0,0 +1,31 @@
+/** @file
+  GUID HOB caching the BMC identity (Get Device ID and Get Self Test Results).
+
+  The HOB is built and filled in by PeiIpmiInit, and is read-only afterwards.
+  IpmiGetCachedDeviceId() and IpmiGetCachedSelfTestResult() in
+  DxeIpmiBmcInfoLib serve DXE requests from it, until
+  IpmiInvalidateBmcInfoCache() is called after a BMC reset or update.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _IPMI_BMC_INFO_HOB_H_
+#define _IPMI_BMC_INFO_HOB_H_
+
+#include <IndustryStandard/Ipmi.h>
+
+#define IPMI_BMC_INFO_HOB_GUID \
+  { 0x64f9a224, 0x798a, 0x43ba, { 0xa4, 0xba, 0xf2, 0x8f, 0xcf, 0x30, 0x1e, 0x80 } }
+
+extern EFI_GUID gIpmiBmcInfoHobGuid;
+
+typedef struct {
+  BOOLEAN                         DeviceIdValid;
+  BOOLEAN                         SelfTestResultValid;
+  IPMI_GET_DEVICE_ID_RESPONSE     DeviceId;
+  IPMI_SELF_TEST_RESULT_RESPONSE  SelfTestResult;
+} IPMI_BMC_INFO_HOB;
+
+#endif
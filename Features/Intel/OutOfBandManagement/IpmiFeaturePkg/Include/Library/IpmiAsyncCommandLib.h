@@ -0,0 +1,85 @@
+/** @file
+  This library queues IPMI commands and sends them to the BMC from a timer
+  event, so that non-critical traffic does not hold up driver dispatch.
+
+  Commands are sent one per timer tick, in submission order, at TPL_CALLBACK.
+  Each exchange with the BMC runs at IPMI_COMMAND_TPL, like the ones sent
+  through the DXE IpmiCommandLib, so exchanges of different drivers never
+  interleave. Anything still queued at ReadyToBoot is sent before the boot
+  continues, and no command is accepted after that.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _IPMI_ASYNC_COMMAND_LIB_H_
+#define _IPMI_ASYNC_COMMAND_LIB_H_
+
+#include <Uefi.h>
+#include <IndustryStandard/Ipmi.h>
+
+/**
+  Called at TPL_CALLBACK once a queued command has been sent.
+
+  The callback may queue further commands.
+
+  @param[in] Status            Status returned by IpmiSubmitCommand().
+  @param[in] ResponseData      Response from the BMC. Only valid during the callback.
+  @param[in] ResponseDataSize  Size of the response in bytes.
+  @param[in] Context           Context passed to IpmiSubmitCommandAsync().
+**/
+typedef
+VOID
+(EFIAPI *IPMI_ASYNC_COMMAND_CALLBACK) (
+  IN EFI_STATUS  Status,
+  IN UINT8       *ResponseData,
+  IN UINT32      ResponseDataSize,
+  IN VOID        *Context
+  );
+
+/**
+  Queue an IPMI command.
+
+  The request data is copied, so the caller's buffer may go away once this
+  returns.
+
+  @param[in] NetFunction       Net function of the command.
+  @param[in] Command           IPMI command number.
+  @param[in] RequestData       Command request data, or NULL.
+  @param[in] RequestDataSize   Size of the request data in bytes.
+  @param[in] ResponseDataSize  Size of the response buffer to provide, in bytes.
+  @param[in] Callback          Called when the command has been sent, or NULL.
+  @param[in] Context           Passed to Callback.
+  @param[in] Event             Signaled after Callback returns, or NULL.
+
+  @retval EFI_SUCCESS            The command is queued.
+  @retval EFI_INVALID_PARAMETER  RequestData is NULL and RequestDataSize is not zero.
+  @retval EFI_ACCESS_DENIED      The queue was flushed at ReadyToBoot, no more
+                                 commands are accepted.
+  @retval EFI_OUT_OF_RESOURCES   Not enough memory to queue the command.
+  @retval Others                 The drain timer could not be started.
+**/
+EFI_STATUS
+EFIAPI
+IpmiSubmitCommandAsync (
+  IN UINT8                        NetFunction,
+  IN UINT8                        Command,
+  IN UINT8                        *RequestData,     OPTIONAL
+  IN UINT32                       RequestDataSize,
+  IN UINT32                       ResponseDataSize,
+  IN IPMI_ASYNC_COMMAND_CALLBACK  Callback,         OPTIONAL
+  IN VOID                         *Context,         OPTIONAL
+  IN EFI_EVENT                    Event             OPTIONAL
+  );
+
+/**
+  Send all queued commands now, and wait for them to complete.
+**/
+VOID
+EFIAPI
+IpmiAsyncCommandFlush (
+  VOID
+  );
+
+#endif
@@ -0,0 +1,63 @@
+/** @file
+  This library provides the BMC Device ID and self test results.
+
+  The results are read from the BMC info HOB built by PeiIpmiInit, or from the
+  BMC if the HOB does not hold them, and are kept for the rest of the module.
+  A driver that resets the BMC or updates its firmware calls
+  IpmiInvalidateBmcInfoCache(), so every module asks the BMC again.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _IPMI_BMC_INFO_LIB_H_
+#define _IPMI_BMC_INFO_LIB_H_
+
+#include <Uefi.h>
+#include <IndustryStandard/Ipmi.h>
+
+/**
+  Get the BMC Device ID, sending Get Device ID only if it is not known yet.
+
+  @param[out] DeviceId  The Get Device ID response.
+
+  @retval EFI_SUCCESS   DeviceId is filled in.
+  @retval Others        The command failed, see IpmiGetDeviceId().
+**/
+EFI_STATUS
+EFIAPI
+IpmiGetCachedDeviceId (
+  OUT IPMI_GET_DEVICE_ID_RESPONSE  *DeviceId
+  );
+
+/**
+  Get the BMC self test results, sending Get Self Test Results only if they
+  are not known yet.
+
+  @param[out] SelfTestResult  The Get Self Test Results response.
+
+  @retval EFI_SUCCESS   SelfTestResult is filled in.
+  @retval Others        The command failed, see IpmiGetSelfTestResult().
+**/
+EFI_STATUS
+EFIAPI
+IpmiGetCachedSelfTestResult (
+  OUT IPMI_SELF_TEST_RESULT_RESPONSE   *SelfTestResult
+  );
+
+/**
+  Forget the BMC Device ID and self test results, in this module and in every
+  other module using this library, including the copy in the BMC info HOB.
+
+  Call this after resetting the BMC or updating its firmware. The next
+  IpmiGetCachedDeviceId() or IpmiGetCachedSelfTestResult() call sends the
+  command to the BMC.
+**/
+VOID
+EFIAPI
+IpmiInvalidateBmcInfoCache (
+  VOID
+  );
+
+#endif
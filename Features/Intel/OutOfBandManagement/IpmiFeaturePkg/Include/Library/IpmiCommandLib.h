@@ -12,6 +12,14 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Uefi.h>
 #include <IndustryStandard/Ipmi.h>
 
+///
+/// In DXE, every IPMI exchange runs at this TPL from the first byte sent to the
+/// last byte received. All drivers share the one BMC interface, which can only
+/// carry one exchange at a time, and nothing sends IPMI commands above this TPL,
+/// so no other exchange can start until the current one is complete.
+///
+#define IPMI_COMMAND_TPL  TPL_NOTIFY
+
 //
 // NetFnApp
 //
@@ -12,8 +12,47 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/IpmiCommandLib.h>
+#include <Library/IpmiBmcInfoLib.h>
+#include <Library/IpmiAsyncCommandLib.h>
 #include <IndustryStandard/Ipmi.h>
 
+VOID
+EFIAPI
+FruInventoryAreaInfoCallback (
+  IN EFI_STATUS  Status,
+  IN UINT8       *ResponseData,
+  IN UINT32      ResponseDataSize,
+  IN VOID        *Context
+  )
+/*++
+
+Routine Description:
+
+  Completion of the queued Get FRU Inventory Area Info command.
+
+Arguments:
+
+  Status           - Status of the command
+  ResponseData     - IPMI_GET_FRU_INVENTORY_AREA_INFO_RESPONSE from the BMC
+  ResponseDataSize - Size of ResponseData
+  Context          - Not used
+
+Returns:
+
+  None
+
+--*/
+{
+  IPMI_GET_FRU_INVENTORY_AREA_INFO_RESPONSE  *GetFruInventoryAreaInfoResponse;
+
+  if (EFI_ERROR (Status) || ResponseDataSize < sizeof (*GetFruInventoryAreaInfoResponse)) {
+    DEBUG((DEBUG_ERROR, "!!! IpmiFru  IpmiGetFruInventoryAreaInfo Status=%x\n", Status));
+    return;
+  }
+  GetFruInventoryAreaInfoResponse = (IPMI_GET_FRU_INVENTORY_AREA_INFO_RESPONSE *)ResponseData;
+  DEBUG((DEBUG_ERROR, "!!! IpmiFru  InventoryAreaSize=%x\n", GetFruInventoryAreaInfoResponse->InventoryAreaSize));
+}
+
 EFI_STATUS
 EFIAPI
 InitializeFru (
@@ -40,12 +79,11 @@ Returns:
   EFI_STATUS                                 Status;
   IPMI_GET_DEVICE_ID_RESPONSE                ControllerInfo;
   IPMI_GET_FRU_INVENTORY_AREA_INFO_REQUEST   GetFruInventoryAreaInfoRequest;
-  IPMI_GET_FRU_INVENTORY_AREA_INFO_RESPONSE  GetFruInventoryAreaInfoResponse;
 
   //
   //  Get all the SDR Records from BMC and retrieve the Record ID from the structure for future use.
   //
-  Status = IpmiGetDeviceId (&ControllerInfo);
+  Status = IpmiGetCachedDeviceId (&ControllerInfo);
   if (EFI_ERROR (Status)) {
     DEBUG((DEBUG_ERROR, "!!! IpmiFru  IpmiGetDeviceId Status=%x\n", Status));
     return Status;
@@ -55,12 +93,20 @@ Returns:
 
   if (ControllerInfo.DeviceSupport.Bits.FruInventorySupport) {
     GetFruInventoryAreaInfoRequest.DeviceId = 0;
-    Status = IpmiGetFruInventoryAreaInfo (&GetFruInventoryAreaInfoRequest, &GetFruInventoryAreaInfoResponse);
+    Status = IpmiSubmitCommandAsync (
+               IPMI_NETFN_STORAGE,
+               IPMI_STORAGE_GET_FRU_INVENTORY_AREAINFO,
+               (UINT8 *)&GetFruInventoryAreaInfoRequest,
+               sizeof (GetFruInventoryAreaInfoRequest),
+               sizeof (IPMI_GET_FRU_INVENTORY_AREA_INFO_RESPONSE),
+               FruInventoryAreaInfoCallback,
+               NULL,
+               NULL
+               );
     if (EFI_ERROR (Status)) {
       DEBUG((DEBUG_ERROR, "!!! IpmiFru  IpmiGetFruInventoryAreaInfo Status=%x\n", Status));
       return Status;
     }
-    DEBUG((DEBUG_ERROR, "!!! IpmiFru  InventoryAreaSize=%x\n", GetFruInventoryAreaInfoResponse.InventoryAreaSize));
   }
 
   return EFI_SUCCESS;
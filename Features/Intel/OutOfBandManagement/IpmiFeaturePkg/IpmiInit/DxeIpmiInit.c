@@ -11,6 +11,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DebugLib.h>
 #include <Library/TimerLib.h>
 #include <Library/IpmiCommandLib.h>
+#include <Library/IpmiBmcInfoLib.h>
 
 #define BMC_TIMEOUT          30  // [s] How long shall BIOS wait for BMC
 #define BMC_KCS_TIMEOUT      5   // [s] Single KSC request timeout
@@ -45,7 +46,7 @@ Returns:
   //
   // Get the SELF TEST Results.
   //
-  Status = IpmiGetSelfTestResult (&TestResult);
+  Status = IpmiGetCachedSelfTestResult (&TestResult);
   if (EFI_ERROR(Status)) {
     DEBUG((DEBUG_ERROR, "\n[IPMI] BMC does not respond (status: %r)!\n\n", Status));
     return Status;
@@ -87,7 +88,7 @@ Returns:
   // Get the device ID information for the BMC.
   //
   do {
-    Status = IpmiGetDeviceId (&BmcInfo);
+    Status = IpmiGetCachedDeviceId (&BmcInfo);
     if (!EFI_ERROR(Status)) {
       break;
     }
@@ -142,6 +143,12 @@ IpmiInterfaceInit (
     // Get the SELF TEST Results.
     //
     GetSelfTest ();
+  } else if (!EFI_ERROR(Status)) {
+    //
+    // The BMC firmware is being updated, the Device ID read so far describes
+    // the update firmware. Have the drivers ask the BMC again once it is done.
+    //
+    IpmiInvalidateBmcInfoCache ();
   }
 
   return EFI_SUCCESS;
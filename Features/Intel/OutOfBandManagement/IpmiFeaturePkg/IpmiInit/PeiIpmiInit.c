@@ -8,16 +8,20 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <PiPei.h>
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/HobLib.h>
 #include <Library/TimerLib.h>
 #include <Library/IpmiCommandLib.h>
+#include <Guid/IpmiBmcInfoHob.h>
 
 #define BMC_TIMEOUT_PEI      50  // [s] How long shall BIOS wait for BMC
 #define BMC_KCS_TIMEOUT      5   // [s] Single KSC request timeout
 
 EFI_STATUS
 GetDeviceId (
-  OUT BOOLEAN *UpdateMode
+  OUT BOOLEAN            *UpdateMode,
+  IN  IPMI_BMC_INFO_HOB  *BmcInfoHob   OPTIONAL
   )
 /*++
 
@@ -26,6 +30,8 @@ Routine Description:
   Mode.  If it is, then report it to the error manager.
 
 Arguments:
+  UpdateMode    - Set to TRUE if the BMC is in Force Update Mode.
+  BmcInfoHob    - The BMC info HOB to store the response in, or NULL.
 
 Returns:
   Status
@@ -63,6 +69,10 @@ Returns:
     BmcInfo.FirmwareRev1.Bits.MajorFirmwareRev,
     BmcInfo.MinorFirmwareRev
     ));
+  if (BmcInfoHob != NULL && BmcInfo.CompletionCode == IPMI_COMP_CODE_NORMAL) {
+    CopyMem (&BmcInfoHob->DeviceId, &BmcInfo, sizeof (BmcInfo));
+    BmcInfoHob->DeviceIdValid = TRUE;
+  }
   *UpdateMode = (BOOLEAN)BmcInfo.FirmwareRev1.Bits.UpdateMode;
   return Status;
 }
@@ -83,14 +93,35 @@ PeimIpmiInterfaceInit (
   IN CONST EFI_PEI_SERVICES     **PeiServices
   )
 {
-  BOOLEAN      UpdateMode;
-  EFI_STATUS   Status;
+  BOOLEAN                         UpdateMode;
+  EFI_STATUS                      Status;
+  IPMI_BMC_INFO_HOB               *BmcInfoHob;
+  IPMI_SELF_TEST_RESULT_RESPONSE  TestResult;
+
+  //
+  // Build the BMC identity HOB, so DXE drivers do not have to ask the BMC again.
+  //
+  BmcInfoHob = BuildGuidHob (&gIpmiBmcInfoHobGuid, sizeof (*BmcInfoHob));
+  if (BmcInfoHob != NULL) {
+    ZeroMem (BmcInfoHob, sizeof (*BmcInfoHob));
+  }
 
   DEBUG ((DEBUG_INFO, "IPMI Peim:Get BMC Device Id\n"));
 
   //
   // Get the Device ID and check if the system is in Force Update mode.
   //
-  Status = GetDeviceId (&UpdateMode);
+  Status = GetDeviceId (&UpdateMode, BmcInfoHob);
+  if (!EFI_ERROR (Status) && !UpdateMode && BmcInfoHob != NULL) {
+    //
+    // Get the SELF TEST Results, so DXE does not have to.
+    //
+    if (!EFI_ERROR (IpmiGetSelfTestResult (&TestResult)) &&
+        TestResult.CompletionCode == IPMI_COMP_CODE_NORMAL) {
+      DEBUG ((DEBUG_INFO, "[IPMI] BMC self-test result: %02X-%02X\n", TestResult.Result, TestResult.Param));
+      CopyMem (&BmcInfoHob->SelfTestResult, &TestResult, sizeof (TestResult));
+      BmcInfoHob->SelfTestResultValid = TRUE;
+    }
+  }
   return Status;
 }
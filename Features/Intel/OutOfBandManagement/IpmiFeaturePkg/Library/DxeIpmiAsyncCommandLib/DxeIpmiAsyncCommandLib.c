@@ -0,0 +1,299 @@
+/** @file
+  IPMI command queue drained from a timer event.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IpmiLib.h>
+#include <Library/IpmiAsyncCommandLib.h>
+#include <Library/IpmiCommandLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#define IPMI_ASYNC_DRAIN_INTERVAL   (10 * 1000 * 10)  // 10ms in 100ns units
+
+#define IPMI_ASYNC_COMMAND_SIGNATURE  SIGNATURE_32 ('I', 'A', 'C', 'Q')
+
+typedef struct {
+  UINT32                       Signature;
+  LIST_ENTRY                   Link;
+  UINT8                        NetFunction;
+  UINT8                        Command;
+  UINT32                       RequestDataSize;
+  UINT32                       ResponseDataSize;
+  IPMI_ASYNC_COMMAND_CALLBACK  Callback;
+  VOID                         *Context;
+  EFI_EVENT                    Event;
+  //
+  // Request data, followed by room for the response.
+  //
+  UINT8                        Data[1];
+} IPMI_ASYNC_COMMAND;
+
+#define IPMI_ASYNC_COMMAND_FROM_LINK(a) \
+  CR (a, IPMI_ASYNC_COMMAND, Link, IPMI_ASYNC_COMMAND_SIGNATURE)
+
+STATIC LIST_ENTRY  mIpmiAsyncQueue = INITIALIZE_LIST_HEAD_VARIABLE (mIpmiAsyncQueue);
+STATIC EFI_EVENT   mIpmiAsyncTimer;
+STATIC EFI_EVENT   mIpmiAsyncReadyToBoot;
+STATIC BOOLEAN     mIpmiAsyncTimerRunning;
+STATIC BOOLEAN     mIpmiAsyncClosed;
+
+/**
+  Send the command at the head of the queue, if any.
+
+  @retval TRUE   A command was sent.
+  @retval FALSE  The queue is empty.
+**/
+STATIC
+BOOLEAN
+IpmiAsyncSendNext (
+  VOID
+  )
+{
+  EFI_TPL             OldTpl;
+  EFI_TPL             QueueTpl;
+  IPMI_ASYNC_COMMAND  *Entry;
+  UINT8               *ResponseData;
+  UINT32              ResponseDataSize;
+  EFI_STATUS          Status;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  if (IsListEmpty (&mIpmiAsyncQueue)) {
+    if (mIpmiAsyncTimerRunning) {
+      gBS->SetTimer (mIpmiAsyncTimer, TimerCancel, 0);
+      mIpmiAsyncTimerRunning = FALSE;
+    }
+    gBS->RestoreTPL (OldTpl);
+    return FALSE;
+  }
+
+  Entry = IPMI_ASYNC_COMMAND_FROM_LINK (GetFirstNode (&mIpmiAsyncQueue));
+  RemoveEntryList (&Entry->Link);
+
+  ResponseData     = Entry->Data + Entry->RequestDataSize;
+  ResponseDataSize = Entry->ResponseDataSize;
+
+  //
+  // The drain timers of all drivers using this library, and synchronous
+  // commands sent through IpmiCommandLib, share one BMC interface. Hold
+  // IPMI_COMMAND_TPL for the whole exchange, as IpmiCommandLib does, so
+  // that none of them can start another exchange until this one completes.
+  //
+  QueueTpl = gBS->RaiseTPL (IPMI_COMMAND_TPL);
+  Status = IpmiSubmitCommand (
+             Entry->NetFunction,
+             Entry->Command,
+             (Entry->RequestDataSize != 0) ? Entry->Data : NULL,
+             Entry->RequestDataSize,
+             ResponseData,
+             &ResponseDataSize
+             );
+  gBS->RestoreTPL (QueueTpl);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[IPMI] Queued command %02X:%02X failed: %r\n", Entry->NetFunction, Entry->Command, Status));
+  }
+
+  if (Entry->Callback != NULL) {
+    Entry->Callback (Status, ResponseData, ResponseDataSize, Entry->Context);
+  }
+  if (Entry->Event != NULL) {
+    gBS->SignalEvent (Entry->Event);
+  }
+  FreePool (Entry);
+
+  gBS->RestoreTPL (OldTpl);
+  return TRUE;
+}
+
+/**
+  Timer notification: send one queued command per tick.
+
+  @param[in] Event    The drain timer.
+  @param[in] Context  Not used.
+**/
+STATIC
+VOID
+EFIAPI
+IpmiAsyncTimerNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  IpmiAsyncSendNext ();
+}
+
+/**
+  Close the drain timer and ReadyToBoot events if no command is queued, so a
+  caller that failed to queue anything can be unloaded.
+**/
+STATIC
+VOID
+IpmiAsyncCloseIdleEvents (
+  VOID
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  if (mIpmiAsyncTimer != NULL && IsListEmpty (&mIpmiAsyncQueue)) {
+    gBS->SetTimer (mIpmiAsyncTimer, TimerCancel, 0);
+    mIpmiAsyncTimerRunning = FALSE;
+    gBS->CloseEvent (mIpmiAsyncTimer);
+    mIpmiAsyncTimer = NULL;
+    gBS->CloseEvent (mIpmiAsyncReadyToBoot);
+    mIpmiAsyncReadyToBoot = NULL;
+  }
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  ReadyToBoot notification: do not leave commands behind, and do not accept
+  new ones, so no command reaches the BMC once the boot has started.
+
+  @param[in] Event    The ReadyToBoot event.
+  @param[in] Context  Not used.
+**/
+STATIC
+VOID
+EFIAPI
+IpmiAsyncReadyToBootNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  //
+  // Callbacks run by the flush may still queue commands, they are sent too.
+  //
+  IpmiAsyncCommandFlush ();
+
+  mIpmiAsyncClosed = TRUE;
+  IpmiAsyncCloseIdleEvents ();
+}
+
+/**
+  Queue an IPMI command.
+
+  The request data is copied, so the caller's buffer may go away once this
+  returns.
+
+  @param[in] NetFunction       Net function of the command.
+  @param[in] Command           IPMI command number.
+  @param[in] RequestData       Command request data, or NULL.
+  @param[in] RequestDataSize   Size of the request data in bytes.
+  @param[in] ResponseDataSize  Size of the response buffer to provide, in bytes.
+  @param[in] Callback          Called when the command has been sent, or NULL.
+  @param[in] Context           Passed to Callback.
+  @param[in] Event             Signaled after Callback returns, or NULL.
+
+  @retval EFI_SUCCESS            The command is queued.
+  @retval EFI_INVALID_PARAMETER  RequestData is NULL and RequestDataSize is not zero.
+  @retval EFI_ACCESS_DENIED      The queue was flushed at ReadyToBoot, no more
+                                 commands are accepted.
+  @retval EFI_OUT_OF_RESOURCES   Not enough memory to queue the command.
+  @retval Others                 The drain timer could not be started.
+**/
+EFI_STATUS
+EFIAPI
+IpmiSubmitCommandAsync (
+  IN UINT8                        NetFunction,
+  IN UINT8                        Command,
+  IN UINT8                        *RequestData,     OPTIONAL
+  IN UINT32                       RequestDataSize,
+  IN UINT32                       ResponseDataSize,
+  IN IPMI_ASYNC_COMMAND_CALLBACK  Callback,         OPTIONAL
+  IN VOID                         *Context,         OPTIONAL
+  IN EFI_EVENT                    Event             OPTIONAL
+  )
+{
+  EFI_STATUS          Status;
+  EFI_TPL             OldTpl;
+  IPMI_ASYNC_COMMAND  *Entry;
+
+  if (RequestData == NULL && RequestDataSize != 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mIpmiAsyncClosed) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  if (mIpmiAsyncTimer == NULL) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    IpmiAsyncTimerNotify,
+                    NULL,
+                    &mIpmiAsyncTimer
+                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    Status = EfiCreateEventReadyToBootEx (
+               TPL_CALLBACK,
+               IpmiAsyncReadyToBootNotify,
+               NULL,
+               &mIpmiAsyncReadyToBoot
+               );
+    if (EFI_ERROR (Status)) {
+      gBS->CloseEvent (mIpmiAsyncTimer);
+      mIpmiAsyncTimer = NULL;
+      return Status;
+    }
+  }
+
+  Entry = AllocateZeroPool (OFFSET_OF (IPMI_ASYNC_COMMAND, Data) + RequestDataSize + ResponseDataSize);
+  if (Entry == NULL) {
+    IpmiAsyncCloseIdleEvents ();
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Entry->Signature        = IPMI_ASYNC_COMMAND_SIGNATURE;
+  Entry->NetFunction      = NetFunction;
+  Entry->Command          = Command;
+  Entry->RequestDataSize  = RequestDataSize;
+  Entry->ResponseDataSize = ResponseDataSize;
+  Entry->Callback         = Callback;
+  Entry->Context          = Context;
+  Entry->Event            = Event;
+  if (RequestDataSize != 0) {
+    CopyMem (Entry->Data, RequestData, RequestDataSize);
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  InsertTailList (&mIpmiAsyncQueue, &Entry->Link);
+  Status = EFI_SUCCESS;
+  if (!mIpmiAsyncTimerRunning) {
+    Status = gBS->SetTimer (mIpmiAsyncTimer, TimerPeriodic, IPMI_ASYNC_DRAIN_INTERVAL);
+    if (EFI_ERROR (Status)) {
+      RemoveEntryList (&Entry->Link);
+      FreePool (Entry);
+      IpmiAsyncCloseIdleEvents ();
+    } else {
+      mIpmiAsyncTimerRunning = TRUE;
+    }
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
+}
+
+/**
+  Send all queued commands now, and wait for them to complete.
+**/
+VOID
+EFIAPI
+IpmiAsyncCommandFlush (
+  VOID
+  )
+{
+  while (IpmiAsyncSendNext ()) {
+  }
+}
@@ -0,0 +1,162 @@
+/** @file
+  BMC Device ID and self test results for DXE modules.
+
+  The BMC info HOB from PeiIpmiInit is only read. The results, from the HOB or
+  from the BMC, are kept in module globals, so each module asks the BMC at most
+  once for each of them, until IpmiInvalidateBmcInfoCache() bumps
+  PcdIpmiBmcInfoGeneration. Each module then drops its copy, and the HOB is not
+  used any more.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/IpmiCommandLib.h>
+#include <Library/IpmiBmcInfoLib.h>
+#include <Library/PcdLib.h>
+
+#include <IndustryStandard/Ipmi.h>
+#include <Guid/IpmiBmcInfoHob.h>
+
+STATIC BOOLEAN                         mBmcInfoHobChecked;
+STATIC UINT32                          mBmcInfoGeneration;
+STATIC BOOLEAN                         mDeviceIdValid;
+STATIC BOOLEAN                         mSelfTestResultValid;
+STATIC IPMI_GET_DEVICE_ID_RESPONSE     mDeviceId;
+STATIC IPMI_SELF_TEST_RESULT_RESPONSE  mSelfTestResult;
+
+/**
+  Drop the results of an older BMC info generation, then copy the results held
+  by the BMC info HOB, once, as long as no module has invalidated them.
+**/
+STATIC
+VOID
+ReadBmcInfoHob (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE  *GuidHob;
+  IPMI_BMC_INFO_HOB  *BmcInfo;
+  UINT32             Generation;
+
+  Generation = PcdGet32 (PcdIpmiBmcInfoGeneration);
+  if (Generation != mBmcInfoGeneration) {
+    mBmcInfoGeneration   = Generation;
+    mBmcInfoHobChecked   = TRUE;
+    mDeviceIdValid       = FALSE;
+    mSelfTestResultValid = FALSE;
+    return;
+  }
+
+  if (mBmcInfoHobChecked) {
+    return;
+  }
+  mBmcInfoHobChecked = TRUE;
+
+  GuidHob = GetFirstGuidHob (&gIpmiBmcInfoHobGuid);
+  if (GuidHob == NULL) {
+    return;
+  }
+  BmcInfo = GET_GUID_HOB_DATA (GuidHob);
+  if (BmcInfo->DeviceIdValid) {
+    CopyMem (&mDeviceId, &BmcInfo->DeviceId, sizeof (mDeviceId));
+    mDeviceIdValid = TRUE;
+  }
+  if (BmcInfo->SelfTestResultValid) {
+    CopyMem (&mSelfTestResult, &BmcInfo->SelfTestResult, sizeof (mSelfTestResult));
+    mSelfTestResultValid = TRUE;
+  }
+}
+
+/**
+  Get the BMC Device ID, sending Get Device ID only if it is not known yet.
+
+  @param[out] DeviceId  The Get Device ID response.
+
+  @retval EFI_SUCCESS   DeviceId is filled in.
+  @retval Others        The command failed, see IpmiGetDeviceId().
+**/
+EFI_STATUS
+EFIAPI
+IpmiGetCachedDeviceId (
+  OUT IPMI_GET_DEVICE_ID_RESPONSE  *DeviceId
+  )
+{
+  EFI_STATUS  Status;
+
+  ReadBmcInfoHob ();
+  if (mDeviceIdValid) {
+    CopyMem (DeviceId, &mDeviceId, sizeof (*DeviceId));
+    return EFI_SUCCESS;
+  }
+
+  Status = IpmiGetDeviceId (DeviceId);
+  if (!EFI_ERROR (Status) && DeviceId->CompletionCode == IPMI_COMP_CODE_NORMAL) {
+    CopyMem (&mDeviceId, DeviceId, sizeof (mDeviceId));
+    mDeviceIdValid = TRUE;
+  }
+  return Status;
+}
+
+/**
+  Get the BMC self test results, sending Get Self Test Results only if they
+  are not known yet.
+
+  @param[out] SelfTestResult  The Get Self Test Results response.
+
+  @retval EFI_SUCCESS   SelfTestResult is filled in.
+  @retval Others        The command failed, see IpmiGetSelfTestResult().
+**/
+EFI_STATUS
+EFIAPI
+IpmiGetCachedSelfTestResult (
+  OUT IPMI_SELF_TEST_RESULT_RESPONSE   *SelfTestResult
+  )
+{
+  EFI_STATUS  Status;
+
+  ReadBmcInfoHob ();
+  if (mSelfTestResultValid) {
+    CopyMem (SelfTestResult, &mSelfTestResult, sizeof (*SelfTestResult));
+    return EFI_SUCCESS;
+  }
+
+  Status = IpmiGetSelfTestResult (SelfTestResult);
+  if (!EFI_ERROR (Status) && SelfTestResult->CompletionCode == IPMI_COMP_CODE_NORMAL) {
+    CopyMem (&mSelfTestResult, SelfTestResult, sizeof (mSelfTestResult));
+    mSelfTestResultValid = TRUE;
+  }
+  return Status;
+}
+
+/**
+  Forget the BMC Device ID and self test results, in this module and in every
+  other module using this library, including the copy in the BMC info HOB.
+
+  Call this after resetting the BMC or updating its firmware. The next
+  IpmiGetCachedDeviceId() or IpmiGetCachedSelfTestResult() call sends the
+  command to the BMC.
+**/
+VOID
+EFIAPI
+IpmiInvalidateBmcInfoCache (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  mBmcInfoGeneration   = PcdGet32 (PcdIpmiBmcInfoGeneration) + 1;
+  mBmcInfoHobChecked   = TRUE;
+  mDeviceIdValid       = FALSE;
+  mSelfTestResultValid = FALSE;
+
+  Status = PcdSet32S (PcdIpmiBmcInfoGeneration, mBmcInfoGeneration);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[IPMI] Other modules keep the old BMC info: %r\n", Status));
+  }
+}
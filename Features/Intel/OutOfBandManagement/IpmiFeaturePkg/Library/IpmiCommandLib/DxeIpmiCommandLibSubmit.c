@@ -0,0 +1,65 @@
+/** @file
+  IPMI Command - transport access serialized across DXE drivers.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/IpmiCommandLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#include "IpmiCommandLibInternal.h"
+
+/**
+  Send an IPMI command to the BMC and wait for the response.
+
+  The whole exchange runs at IPMI_COMMAND_TPL, so that no timer event of this
+  or any other driver, like the one draining IpmiSubmitCommandAsync() queues,
+  can start another exchange on the BMC interface while this one is in flight.
+
+  @param[in]      NetFunction       Net function of the command.
+  @param[in]      Command           IPMI command number.
+  @param[in]      RequestData       Command request data.
+  @param[in]      RequestDataSize   Size of the request data in bytes.
+  @param[out]     ResponseData      Buffer for the response data.
+  @param[in, out] ResponseDataSize  Size of the response buffer on input, size
+                                    of the response on output, in bytes.
+
+  @retval EFI_SUCCESS  The command completed.
+  @retval Others       Status returned by IpmiSubmitCommand().
+**/
+EFI_STATUS
+IpmiCommandLibSubmit (
+  IN     UINT8     NetFunction,
+  IN     UINT8     Command,
+  IN     UINT8     *RequestData,
+  IN     UINT32    RequestDataSize,
+  OUT    UINT8     *ResponseData,
+  IN OUT UINT32    *ResponseDataSize
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+  BOOLEAN     Raised;
+
+  Raised = (EfiGetCurrentTpl () < IPMI_COMMAND_TPL);
+  if (Raised) {
+    OldTpl = gBS->RaiseTPL (IPMI_COMMAND_TPL);
+  }
+
+  Status = IpmiSubmitCommand (
+             NetFunction,
+             Command,
+             RequestData,
+             RequestDataSize,
+             ResponseData,
+             ResponseDataSize
+             );
+
+  if (Raised) {
+    gBS->RestoreTPL (OldTpl);
+  }
+  return Status;
+}
@@ -0,0 +1,39 @@
+/** @file
+  Internal definitions shared by the IPMI command library instances.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _IPMI_COMMAND_LIB_INTERNAL_H_
+#define _IPMI_COMMAND_LIB_INTERNAL_H_
+
+#include <Uefi.h>
+#include <Library/IpmiLib.h>
+
+/**
+  Send an IPMI command to the BMC and wait for the response.
+
+  @param[in]      NetFunction       Net function of the command.
+  @param[in]      Command           IPMI command number.
+  @param[in]      RequestData       Command request data.
+  @param[in]      RequestDataSize   Size of the request data in bytes.
+  @param[out]     ResponseData      Buffer for the response data.
+  @param[in, out] ResponseDataSize  Size of the response buffer on input, size
+                                    of the response on output, in bytes.
+
+  @retval EFI_SUCCESS  The command completed.
+  @retval Others       Status returned by IpmiSubmitCommand().
+**/
+EFI_STATUS
+IpmiCommandLibSubmit (
+  IN     UINT8     NetFunction,
+  IN     UINT8     Command,
+  IN     UINT8     *RequestData,
+  IN     UINT32    RequestDataSize,
+  OUT    UINT8     *ResponseData,
+  IN OUT UINT32    *ResponseDataSize
+  );
+
+#endif
@@ -9,7 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiPei.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
-#include <Library/IpmiLib.h>
+#include "IpmiCommandLibInternal.h"
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -23,7 +23,7 @@ IpmiGetDeviceId (
   UINT32                       DataSize;
 
   DataSize = sizeof(*DeviceId);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_GET_DEVICE_ID,
              NULL,
@@ -44,7 +44,7 @@ IpmiGetSelfTestResult (
   UINT32                       DataSize;
 
   DataSize = sizeof(*SelfTestResult);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_GET_SELFTEST_RESULTS,
              NULL,
@@ -65,7 +65,7 @@ IpmiResetWatchdogTimer (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_RESET_WATCHDOG_TIMER,
              NULL,
@@ -87,7 +87,7 @@ IpmiSetWatchdogTimer (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_SET_WATCHDOG_TIMER,
              (VOID *)SetWatchdogTimer,
@@ -108,7 +108,7 @@ IpmiGetWatchdogTimer (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetWatchdogTimer);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_GET_WATCHDOG_TIMER,
              NULL,
@@ -130,7 +130,7 @@ IpmiSetBmcGlobalEnables (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_SET_BMC_GLOBAL_ENABLES,
              (VOID *)SetBmcGlobalEnables,
@@ -151,7 +151,7 @@ IpmiGetBmcGlobalEnables (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetBmcGlobalEnables);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_GET_BMC_GLOBAL_ENABLES,
              NULL,
@@ -173,7 +173,7 @@ IpmiClearMessageFlags (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_CLEAR_MESSAGE_FLAGS,
              (VOID *)ClearMessageFlagsRequest,
@@ -194,7 +194,7 @@ IpmiGetMessageFlags (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetMessageFlagsResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_GET_MESSAGE_FLAGS,
              NULL,
@@ -214,7 +214,7 @@ IpmiGetMessage (
 {
   EFI_STATUS                   Status;
 
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_GET_MESSAGE,
              NULL,
@@ -236,7 +236,7 @@ IpmiSendMessage (
 {
   EFI_STATUS                   Status;
 
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_APP,
              IPMI_APP_SEND_MESSAGE,
              (VOID *)SendMessageRequest,
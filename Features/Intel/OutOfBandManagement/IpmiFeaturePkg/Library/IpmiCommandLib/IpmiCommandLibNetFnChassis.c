@@ -9,7 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiPei.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
-#include <Library/IpmiLib.h>
+#include "IpmiCommandLibInternal.h"
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -24,7 +24,7 @@ IpmiGetChassisCapabilities (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetChassisCapabilitiesResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_CHASSIS,
              IPMI_CHASSIS_GET_CAPABILITIES,
              NULL,
@@ -45,7 +45,7 @@ IpmiGetChassisStatus (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetChassisStatusResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_CHASSIS,
              IPMI_CHASSIS_GET_STATUS,
              NULL,
@@ -67,7 +67,7 @@ IpmiChassisControl (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_CHASSIS,
              IPMI_CHASSIS_CONTROL,
              (VOID *)ChassisControlRequest,
@@ -89,7 +89,7 @@ IpmiSetPowerRestorePolicy (
   UINT32                       DataSize;
 
   DataSize = sizeof(*ChassisControlResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_CHASSIS,
              IPMI_CHASSIS_SET_POWER_RESTORE_POLICY,
              (VOID *)ChassisControlRequest,
@@ -9,7 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiPei.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
-#include <Library/IpmiLib.h>
+#include "IpmiCommandLibInternal.h"
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -25,7 +25,7 @@ IpmiGetFruInventoryAreaInfo (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetFruInventoryAreaInfoResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_GET_FRU_INVENTORY_AREAINFO,
              (VOID *)GetFruInventoryAreaInfoRequest,
@@ -46,7 +46,7 @@ IpmiReadFruData (
 {
   EFI_STATUS                   Status;
 
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_READ_FRU_DATA,
              (VOID *)ReadFruDataRequest,
@@ -69,7 +69,7 @@ IpmiWriteFruData (
   UINT32                       DataSize;
 
   DataSize = sizeof(*WriteFruDataResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_WRITE_FRU_DATA,
              (VOID *)WriteFruDataRequest,
@@ -90,7 +90,7 @@ IpmiGetSelInfo (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetSelInfoResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_GET_SEL_INFO,
              NULL,
@@ -111,7 +111,7 @@ IpmiGetSelEntry (
 {
   EFI_STATUS                   Status;
 
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_GET_SEL_ENTRY,
              (VOID *)GetSelEntryRequest,
@@ -133,7 +133,7 @@ IpmiAddSelEntry (
   UINT32                       DataSize;
 
   DataSize = sizeof(*AddSelEntryResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_ADD_SEL_ENTRY,
              (VOID *)AddSelEntryRequest,
@@ -156,7 +156,7 @@ IpmiPartialAddSelEntry (
   UINT32                       DataSize;
 
   DataSize = sizeof(*PartialAddSelEntryResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_PARTIAL_ADD_SEL_ENTRY,
              (VOID *)PartialAddSelEntryRequest,
@@ -178,7 +178,7 @@ IpmiClearSel (
   UINT32                       DataSize;
 
   DataSize = sizeof(*ClearSelResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_CLEAR_SEL,
              (VOID *)ClearSelRequest,
@@ -199,7 +199,7 @@ IpmiGetSelTime (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetSelTimeResponse);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_GET_SEL_TIME,
              NULL,
@@ -221,7 +221,7 @@ IpmiSetSelTime (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_SET_SEL_TIME,
              (VOID *)SetSelTimeRequest,
@@ -242,7 +242,7 @@ IpmiGetSdrRepositoryInfo (
   UINT32                       DataSize;
 
   DataSize = sizeof(*GetSdrRepositoryInfoResp);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_GET_SDR_REPOSITORY_INFO,
              NULL,
@@ -263,7 +263,7 @@ IpmiGetSdr (
 {
   EFI_STATUS                   Status;
 
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_STORAGE,
              IPMI_STORAGE_GET_SDR,
              (VOID *)GetSdrRequest,
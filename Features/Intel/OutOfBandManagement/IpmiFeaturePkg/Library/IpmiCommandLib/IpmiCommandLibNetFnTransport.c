@@ -9,7 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiPei.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
-#include <Library/IpmiLib.h>
+#include "IpmiCommandLibInternal.h"
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -25,7 +25,7 @@ IpmiSolActivating (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_TRANSPORT,
              IPMI_TRANSPORT_SOL_ACTIVATING,
              (VOID *)SolActivatingRequest,
@@ -48,7 +48,7 @@ IpmiSetSolConfigurationParameters (
   UINT32                       DataSize;
 
   DataSize = sizeof(*CompletionCode);
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_TRANSPORT,
              IPMI_TRANSPORT_SET_SOL_CONFIG_PARAM,
              (VOID *)SetConfigurationParametersRequest,
@@ -69,7 +69,7 @@ IpmiGetSolConfigurationParameters (
 {
   EFI_STATUS                   Status;
 
-  Status = IpmiSubmitCommand (
+  Status = IpmiCommandLibSubmit (
              IPMI_NETFN_TRANSPORT,
              IPMI_TRANSPORT_GET_SOL_CONFIG_PARAM,
              (VOID *)GetConfigurationParametersRequest,
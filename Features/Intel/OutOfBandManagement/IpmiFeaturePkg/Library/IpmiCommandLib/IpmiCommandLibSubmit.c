@@ -0,0 +1,43 @@
+/** @file
+  IPMI Command - transport access for phases without concurrent callers.
+
+Copyright (c) 2026, agent <agent@local>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "IpmiCommandLibInternal.h"
+
+/**
+  Send an IPMI command to the BMC and wait for the response.
+
+  @param[in]      NetFunction       Net function of the command.
+  @param[in]      Command           IPMI command number.
+  @param[in]      RequestData       Command request data.
+  @param[in]      RequestDataSize   Size of the request data in bytes.
+  @param[out]     ResponseData      Buffer for the response data.
+  @param[in, out] ResponseDataSize  Size of the response buffer on input, size
+                                    of the response on output, in bytes.
+
+  @retval EFI_SUCCESS  The command completed.
+  @retval Others       Status returned by IpmiSubmitCommand().
+**/
+EFI_STATUS
+IpmiCommandLibSubmit (
+  IN     UINT8     NetFunction,
+  IN     UINT8     Command,
+  IN     UINT8     *RequestData,
+  IN     UINT32    RequestDataSize,
+  OUT    UINT8     *ResponseData,
+  IN OUT UINT32    *ResponseDataSize
+  )
+{
+  return IpmiSubmitCommand (
+           NetFunction,
+           Command,
+           RequestData,
+           RequestDataSize,
+           ResponseData,
+           ResponseDataSize
+           );
+}
@@ -14,9 +14,22 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/IpmiCommandLib.h>
+#include <Library/IpmiAsyncCommandLib.h>
 #include <IndustryStandard/Ipmi.h>
 
 #define SOL_CMD_RETRY_COUNT           10
+#define SOL_CMD_RETRY_INTERVAL        (100 * 1000 * 10)  // 100ms in 100ns units
+
+typedef struct {
+  IPMI_GET_SOL_CONFIGURATION_PARAMETERS_REQUEST  Request;
+  UINT8                                          RetryCount;
+  EFI_EVENT                                      RetryEvent;
+} SOL_STATUS_QUERY;
+
+EFI_STATUS
+QueueSOLStatusQuery (
+  IN SOL_STATUS_QUERY                  *Query
+  );
 
 /*++
 
@@ -125,6 +138,134 @@ SetSOLParams (
   return Status;
 }
 
+VOID
+EFIAPI
+SOLStatusRetryNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+/*++
+
+Routine Description:
+
+    Send a failed SOL enable status query again, 100ms after it failed,
+    the same spacing as the stall in GetSOLStatus. Once the IPMI queue no
+    longer accepts commands, at ReadyToBoot, the query is given up.
+
+Arguments:
+    Event           - The retry timer.
+    Context         - The SOL_STATUS_QUERY to send.
+Returns:
+    None
+
+--*/
+{
+  SOL_STATUS_QUERY  *Query;
+  EFI_STATUS        Status;
+
+  Query  = (SOL_STATUS_QUERY *)Context;
+  Status = QueueSOLStatusQuery (Query);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to get channel %x SOL status from BMC!, status is %x\n", Query->Request.ChannelNumber.Bits.ChannelNumber, Status));
+    gBS->CloseEvent (Query->RetryEvent);
+    Query->RetryEvent = NULL;
+  }
+}
+
+VOID
+EFIAPI
+SOLStatusCallback (
+  IN EFI_STATUS  Status,
+  IN UINT8       *ResponseData,
+  IN UINT32      ResponseDataSize,
+  IN VOID        *Context
+  )
+/*++
+
+Routine Description:
+
+    Completion of a queued SOL enable status query. Failed queries, including
+    a non-zero completion code, are sent again after 100ms, up to
+    SOL_CMD_RETRY_COUNT times.
+
+Arguments:
+    Status           - Status of the command.
+    ResponseData     - IPMI_GET_SOL_CONFIGURATION_PARAMETERS_RESPONSE from BMC.
+    ResponseDataSize - Size of ResponseData.
+    Context          - The SOL_STATUS_QUERY that was sent.
+Returns:
+    None
+
+--*/
+{
+  SOL_STATUS_QUERY                                *Query;
+  IPMI_GET_SOL_CONFIGURATION_PARAMETERS_RESPONSE  *Response;
+  UINT8                                           Channel;
+
+  Query   = (SOL_STATUS_QUERY *)Context;
+  Channel = Query->Request.ChannelNumber.Bits.ChannelNumber;
+
+  Response = (IPMI_GET_SOL_CONFIGURATION_PARAMETERS_RESPONSE *)ResponseData;
+  if (!EFI_ERROR (Status) &&
+      ResponseDataSize > OFFSET_OF (IPMI_GET_SOL_CONFIGURATION_PARAMETERS_RESPONSE, ParameterData) &&
+      Response->CompletionCode == IPMI_COMP_CODE_NORMAL) {
+    DEBUG ((DEBUG_ERROR, "SOL enabling status for channel %x is %x\n", Channel, Response->ParameterData[0]));
+    return;
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = EFI_DEVICE_ERROR;
+  }
+  if (++Query->RetryCount < SOL_CMD_RETRY_COUNT) {
+    if (Query->RetryEvent == NULL) {
+      Status = gBS->CreateEvent (
+                      EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                      TPL_CALLBACK,
+                      SOLStatusRetryNotify,
+                      Query,
+                      &Query->RetryEvent
+                      );
+    }
+    if (Query->RetryEvent != NULL) {
+      Status = gBS->SetTimer (Query->RetryEvent, TimerRelative, SOL_CMD_RETRY_INTERVAL);
+      if (!EFI_ERROR (Status)) {
+        return;
+      }
+    }
+  }
+  DEBUG ((DEBUG_ERROR, "Failed to get channel %x SOL status from BMC!, status is %x\n", Channel, Status));
+}
+
+EFI_STATUS
+QueueSOLStatusQuery (
+  IN SOL_STATUS_QUERY                  *Query
+  )
+/*++
+
+Routine Description:
+
+    Queue a Get SOL Configuration Parameters command for Query.
+
+Arguments:
+    Query           - Channel and parameter to read.
+Returns:
+    EFI_SUCCESS     - The command is queued.
+    Others          - The command could not be queued.
+
+--*/
+{
+  return IpmiSubmitCommandAsync (
+           IPMI_NETFN_TRANSPORT,
+           IPMI_TRANSPORT_GET_SOL_CONFIG_PARAM,
+           (UINT8 *)&Query->Request,
+           sizeof (Query->Request),
+           sizeof (IPMI_GET_SOL_CONFIGURATION_PARAMETERS_RESPONSE),
+           SOLStatusCallback,
+           Query,
+           NULL
+           );
+}
+
 EFI_STATUS
 EFIAPI
 SolStatusEntryPoint (
@@ -147,18 +288,41 @@ SolStatusEntryPoint (
 
 --*/
 {
-  EFI_STATUS  Status = EFI_SUCCESS;
-  UINT8       Channel;
-  BOOLEAN     SolEnabled = FALSE;
+  EFI_STATUS        Status = EFI_SUCCESS;
+  UINT8             Channel;
+  SOL_STATUS_QUERY  *Queries;
+  BOOLEAN           Queued;
+
+  //
+  // The status is only reported, so the queries go out in the background
+  // instead of holding up dispatch. Queries stay allocated for the retries.
+  //
+  if (PcdGet8 (PcdMaxSOLChannels) == 0) {
+    return EFI_SUCCESS;
+  }
+  Queries = AllocateZeroPool (PcdGet8 (PcdMaxSOLChannels) * sizeof (*Queries));
+  if (Queries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
 
+  Queued = FALSE;
   for (Channel = 1; Channel <= PcdGet8 (PcdMaxSOLChannels); Channel++) {
-    Status = GetSOLStatus (Channel, IPMI_SOL_CONFIGURATION_PARAMETER_SOL_ENABLE, &SolEnabled);
-    if (Status == EFI_SUCCESS) {
-      DEBUG ((DEBUG_ERROR, "SOL enabling status for channel %x is %x\n", Channel, SolEnabled));
-    } else {
+    Queries[Channel - 1].Request.ChannelNumber.Bits.ChannelNumber = Channel;
+    Queries[Channel - 1].Request.ParameterSelector                = IPMI_SOL_CONFIGURATION_PARAMETER_SOL_ENABLE;
+    Status = QueueSOLStatusQuery (&Queries[Channel - 1]);
+    if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Failed to get channel %x SOL status from BMC!, status is %x\n", Channel, Status));
+    } else {
+      Queued = TRUE;
     }
   }
 
+  //
+  // Queued queries call back into this image, so it must stay loaded.
+  //
+  if (Queued) {
+    return EFI_SUCCESS;
+  }
+  FreePool (Queries);
   return Status;
 }
@@ -827,6 +827,9 @@ VkApiStart (
   VkContext->VkBodyBltStartY                    = 0;
   VkContext->VkBodyBltHeight                    = 0;
   VkContext->VkBodyBltWidth                     = 0;
+  VkContext->VkBodySampleRow                    = 0;
+  VkContext->CheckBltBuffer                     = NULL;
+  VkContext->CheckBltBufferSize                 = 0;
   VkContext->IconBltBuffer                      = NULL;
   VkContext->IconBltSize                        = 0;
   VkContext->IconReDrawCheck                    = 0;
@@ -991,6 +994,12 @@ VkApiStop (
     }
   }
 
+  if (VkContext->CheckBltBuffer != NULL) {
+    FreePool (VkContext->CheckBltBuffer);
+    VkContext->CheckBltBuffer     = NULL;
+    VkContext->CheckBltBufferSize = 0;
+  }
+
   DEBUG ((DEBUG_VK_ROUTINE_ENTRY_EXIT, "VkApiStop End\n"));
 }
 
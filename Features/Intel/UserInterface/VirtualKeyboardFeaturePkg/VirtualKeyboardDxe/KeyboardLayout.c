@@ -1129,6 +1129,92 @@ KeyboardLayoutHandler (
   return Status;
 }
 
+/**
+  Get the scratch blt buffer used to read back the screen, growing it if needed.
+
+  @param[in] VkContext      Address of an VK_CONTEXT structure.
+  @param[in] BltSize        Size of blt needed.
+
+  @retval Address of the scratch blt buffer, or NULL if allocate memory failed.
+
+**/
+STATIC
+EFI_GRAPHICS_OUTPUT_BLT_PIXEL *
+GetCheckBltBuffer (
+  IN VK_CONTEXT *VkContext,
+  IN UINTN      BltSize
+  )
+{
+  if (BltSize > VkContext->CheckBltBufferSize) {
+    if (VkContext->CheckBltBuffer != NULL) {
+      FreePool (VkContext->CheckBltBuffer);
+    }
+    VkContext->CheckBltBuffer     = AllocatePool (BltSize);
+    VkContext->CheckBltBufferSize = (VkContext->CheckBltBuffer != NULL) ? BltSize : 0;
+  }
+
+  return VkContext->CheckBltBuffer;
+}
+
+/**
+  Cheap check whether the screen beneath the keyboard body may have changed.
+
+  Only every VK_BODY_SAMPLE_STRIDE-th row is read back and compared with the
+  compound buffer. A change spanning at least VK_BODY_SAMPLE_STRIDE rows, like
+  a screen clear or a console scroll, is caught on the next poll. The starting
+  row moves on every call, so a narrower change is caught within
+  VK_BODY_SAMPLE_STRIDE polls.
+
+  @param[in] VkContext      Address of an VK_CONTEXT structure.
+
+  @retval TRUE              A sampled row differs, or it could not be checked.
+  @retval FALSE             All sampled rows match the compound buffer.
+
+**/
+STATIC
+BOOLEAN
+IsVkBodySampleChanged (
+  IN VK_CONTEXT *VkContext
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBuffer;
+  UINTN                         RowSize;
+  UINTN                         Row;
+
+  RowSize   = VkContext->VkBodyBltWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  BltBuffer = GetCheckBltBuffer (VkContext, RowSize);
+  if (BltBuffer == NULL) {
+    return TRUE;
+  }
+
+  VkContext->VkBodySampleRow %= VK_BODY_SAMPLE_STRIDE;
+
+  for (Row = VkContext->VkBodySampleRow; Row < VkContext->VkBodyBltHeight; Row += VK_BODY_SAMPLE_STRIDE) {
+    Status = VkContext->GraphicsOutput->Blt (
+                                          VkContext->GraphicsOutput,
+                                          BltBuffer,
+                                          EfiBltVideoToBltBuffer,
+                                          VkContext->VkBodyBltStartX,
+                                          VkContext->VkBodyBltStartY + Row,
+                                          0,
+                                          0,
+                                          VkContext->VkBodyBltWidth,
+                                          1,
+                                          RowSize
+                                          );
+    if (EFI_ERROR (Status)) {
+      return TRUE;
+    }
+    if (CompareMem (BltBuffer, VkContext->VkBodyCompoundBltBuffer + Row * VkContext->VkBodyBltWidth, RowSize) != 0) {
+      return TRUE;
+    }
+  }
+
+  VkContext->VkBodySampleRow++;
+  return FALSE;
+}
+
 /**
   This routine is used to check if icon has been cleared.
 
@@ -1160,7 +1246,7 @@ CheckIconCleared (
   // Check if right-bottomed region is black, if yes, clean screen happened, need to re-draw keyboard.
   //
   VerticalResolution    = VkContext->GraphicsOutput->Mode->Info->VerticalResolution;
-  BltBuffer             = AllocateZeroPool (VkContext->IconBltSize);
+  BltBuffer             = GetCheckBltBuffer (VkContext, VkContext->IconBltSize);
   if (BltBuffer == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -1177,7 +1263,6 @@ CheckIconCleared (
                                         VkContext->IconBltWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
                                         );
   if (EFI_ERROR (Status)) {
-    FreePool (BltBuffer);
     return Status;
   }
   VkContext->IsIconShowed = TRUE;
@@ -1216,10 +1301,6 @@ CheckIconCleared (
     }
   }
 
-  if (BltBuffer != NULL) {
-    FreePool (BltBuffer);
-  }
-
   VkContext->IconReDrawCheck = 0;
 
   return Status;
@@ -1278,6 +1359,8 @@ CheckScreenCleared (
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBuffer;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBufferIndex;
   UINTN                         BltSize;
+  UINTN                         StartY;
+  UINTN                         Height;
   BOOLEAN                       IsScreenCleared;
 
   //
@@ -1296,38 +1379,51 @@ CheckScreenCleared (
     //
     HorizontalResolution  = VkContext->GraphicsOutput->Mode->Info->HorizontalResolution;
     VerticalResolution    = VkContext->GraphicsOutput->Mode->Info->VerticalResolution;
-    BltBuffer             = AllocateZeroPool (VkContext->IconBltSize);
+    BltBuffer             = GetCheckBltBuffer (VkContext, VkContext->IconBltSize);
     if (BltBuffer == NULL) {
       return EFI_OUT_OF_RESOURCES;
     }
 
-    BltBufferIndex = BltBuffer;
-    Status = VkContext->GraphicsOutput->Blt (
-                                          VkContext->GraphicsOutput,
-                                          BltBuffer,
-                                          EfiBltVideoToBltBuffer,
-                                          (HorizontalResolution - VkContext->IconBltWidth),
-                                          (VerticalResolution - VkContext->IconBltHeight),
-                                          0,
-                                          0,
-                                          VkContext->IconBltWidth,
-                                          VkContext->IconBltHeight,
-                                          VkContext->IconBltWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
-                                          );
-    if (EFI_ERROR (Status)) {
-      FreePool (BltBuffer);
-      return Status;
-    }
-    BltSize = VkContext->IconBltHeight * VkContext->IconBltWidth;
+    //
+    // Look at the middle row first, and only read the whole region back
+    // when that row is all black.
+    //
+    StartY          = VkContext->IconBltHeight / 2;
+    Height          = 1;
     IsScreenCleared = TRUE;
-    while (BltSize-- != 0) {
-      if ((BltBufferIndex->Red != 0) || (BltBufferIndex->Green != 0) || (BltBufferIndex->Blue != 0)) {
-        IsScreenCleared = FALSE;
-        break;
+    while (IsScreenCleared && (Height != 0)) {
+      Status = VkContext->GraphicsOutput->Blt (
+                                            VkContext->GraphicsOutput,
+                                            BltBuffer,
+                                            EfiBltVideoToBltBuffer,
+                                            (HorizontalResolution - VkContext->IconBltWidth),
+                                            (VerticalResolution - VkContext->IconBltHeight) + StartY,
+                                            0,
+                                            0,
+                                            VkContext->IconBltWidth,
+                                            Height,
+                                            VkContext->IconBltWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+                                            );
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+      BltBufferIndex = BltBuffer;
+      BltSize        = Height * VkContext->IconBltWidth;
+      while (BltSize-- != 0) {
+        if ((BltBufferIndex->Red != 0) || (BltBufferIndex->Green != 0) || (BltBufferIndex->Blue != 0)) {
+          IsScreenCleared = FALSE;
+          break;
+        }
+        BltBufferIndex++;
+      }
+
+      if (Height == VkContext->IconBltHeight) {
+        Height = 0;
+      } else {
+        StartY = 0;
+        Height = VkContext->IconBltHeight;
       }
-      BltBufferIndex++;
     }
-    FreePool (BltBuffer);
   }
 
   if (IsScreenCleared) {
@@ -1369,6 +1465,7 @@ CheckBackgroundChanged (
 {
   EFI_STATUS                    Status;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBuffer;
+  UINTN                         BltSize;
 
   Status                         = EFI_SUCCESS;
   VkContext->IsBackgroundChanged = FALSE;
@@ -1377,7 +1474,15 @@ CheckBackgroundChanged (
     return EFI_SUCCESS;
   }
 
-  BltBuffer = AllocateZeroPool (VkContext->VkBodyBltSize);
+  if (!IsVkBodySampleChanged (VkContext)) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Sampled rows differ, compare the whole keyboard body.
+  //
+  BltSize   = VkContext->VkBodyBltHeight * VkContext->VkBodyBltWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  BltBuffer = GetCheckBltBuffer (VkContext, BltSize);
   if (BltBuffer == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -1394,19 +1499,14 @@ CheckBackgroundChanged (
                                         VkContext->VkBodyBltWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
                                         );
   if (EFI_ERROR (Status)) {
-    FreePool (BltBuffer);
     return Status;
   }
-  if (CompareMem (BltBuffer, VkContext->VkBodyCompoundBltBuffer, VkContext->VkBodyBltSize) != 0) {
+  if (CompareMem (BltBuffer, VkContext->VkBodyCompoundBltBuffer, BltSize) != 0) {
     VkContext->IsBackgroundChanged = TRUE;
     VkContext->CurrentKeyboardDisplay = VkDisplayAttributeNone;
     DrawKeyboardLayout (VkContext);
   }
 
-  if (BltBuffer != NULL) {
-    FreePool (BltBuffer);
-  }
-
   return Status;
 }
 
@@ -103,6 +103,11 @@ extern EFI_COMPONENT_NAME2_PROTOCOL  gVirtualKeyboardComponentName2;
 ///
 #define TRANSPARENCY_WEIGHT 50
 
+///
+/// Distance between the keyboard body rows read back per poll to detect background changes
+///
+#define VK_BODY_SAMPLE_STRIDE 8
+
 typedef struct _VK_CONTEXT VK_CONTEXT;
 
 typedef enum _VK_KEY_TYPE {
@@ -270,8 +275,15 @@ struct _VK_CONTEXT {
   UINTN                             VkBodyBltStartY;
   UINTN                             VkBodyBltHeight;
   UINTN                             VkBodyBltWidth;
+  UINTN                             VkBodySampleRow;
   BOOLEAN                           IsBackgroundChanged;
 
+  ///
+  /// Scratch buffer for screen readback, kept across polls
+  ///
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL     *CheckBltBuffer;
+  UINTN                             CheckBltBufferSize;
+
   ///
   /// Icon buffer information
   ///
@@ -38,6 +38,31 @@ typedef union {
 
 #pragma pack()
 
+//
+// One enabled processor as captured from MP Services, together with the
+// topology fields the APIC ID order table is sorted on.
+//
+typedef struct {
+  EFI_CPU_ID_ORDER_MAP  Map;
+  UINT32                Package;
+  UINT32                Core;
+  UINT32                Thread;
+  BOOLEAN               IsBsp;
+} CPU_ORDER_ENTRY;
+
+typedef
+INTN
+(*CPU_ORDER_COMPARE) (
+  IN CONST VOID  *Left,
+  IN CONST VOID  *Right
+  );
+
+//
+// Size of the reverse ApicIdMap lookup. All the ApicIdMap tables below only
+// use core/thread IDs below 0x40.
+//
+#define APIC_ID_MAP_REVERSE_SIZE  0x40
+
 extern EFI_ACPI_5_0_FIRMWARE_ACPI_CONTROL_STRUCTURE  Facs;
 extern EFI_ACPI_5_0_FIXED_ACPI_DESCRIPTION_TABLE Fadt;
 extern EFI_ACPI_HIGH_PRECISION_EVENT_TIMER_TABLE_HEADER  Hpet;
@@ -59,6 +84,8 @@ BOOLEAN                     mX2ApicEnabled;
 EFI_MP_SERVICES_PROTOCOL    *mMpService;
 BOOLEAN                     mCpuOrderSorted;
 EFI_CPU_ID_ORDER_MAP        mCpuApicIdOrderTable[MAX_CPU_NUM];
+UINT32                      mCpuApicIdOrderCount = 0;
+UINT32                      mCpuApicIdSortedIndex[MAX_CPU_NUM];
 UINTN                       mNumberOfCPUs = 0;
 UINTN                       mNumberOfEnabledCPUs = 0;
 
@@ -109,6 +136,8 @@ static const UINT32 ApicIdMapD[] = { //for SKUs have number of cores <= 8 use 16
 };
 
 const UINT32 *mApicIdMap = NULL;
+UINT32       mApicIdMapSize = 0;
+UINT32       mApicIdMapReverse[APIC_ID_MAP_REVERSE_SIZE];
 
 /**
   This function detect the APICID map and update ApicID Map pointer
@@ -121,6 +150,8 @@ const UINT32 *mApicIdMap = NULL;
 VOID DetectApicIdMap(VOID)
 {
   UINTN                  CoreCount;
+  UINT32                 MapSize;
+  UINT32                 Index;
 
   CoreCount = 0;
 
@@ -156,6 +187,27 @@ VOID DetectApicIdMap(VOID)
 
   }
 
+  //
+  // Build the core/thread ID -> map index reverse table once, so that
+  // GetIndexFromApicId() does not have to scan the map for every CPU.
+  // IDs that are not in the map resolve to mApicIdMapSize, same as a failed
+  // scan of the map.
+  //
+  MapSize = FixedPcdGet32(PcdMaxCpuCoreCount) * FixedPcdGet32(PcdMaxCpuThreadCount);
+  mApicIdMapSize = MapSize;
+  if (MapSize > ARRAY_SIZE (ApicIdMapA)) {
+    MapSize = ARRAY_SIZE (ApicIdMapA);
+  }
+  for (Index = 0; Index < APIC_ID_MAP_REVERSE_SIZE; Index++) {
+    mApicIdMapReverse[Index] = mApicIdMapSize;
+  }
+  for (Index = 0; Index < MapSize; Index++) {
+    if ((mApicIdMap[Index] < APIC_ID_MAP_REVERSE_SIZE) &&
+        (mApicIdMapReverse[mApicIdMap[Index]] == mApicIdMapSize)) {
+      mApicIdMapReverse[mApicIdMap[Index]] = Index;
+    }
+  }
+
   return;
 }
 
@@ -179,10 +231,10 @@ GetIndexFromApicId (
 
   CoreThreadId = ApicId & ((1 << mNumOfBitShift) - 1);
 
-  for(i = 0; i < (FixedPcdGet32(PcdMaxCpuCoreCount) * FixedPcdGet32(PcdMaxCpuThreadCount)); i++) {
-    if(mApicIdMap[i] == CoreThreadId) {
-      break;
-    }
+  if (CoreThreadId < APIC_ID_MAP_REVERSE_SIZE) {
+    i = mApicIdMapReverse[CoreThreadId];
+  } else {
+    i = mApicIdMapSize;
   }
 
   ASSERT (i <= (FixedPcdGet32(PcdMaxCpuCoreCount) * FixedPcdGet32(PcdMaxCpuThreadCount)));
@@ -190,16 +242,40 @@ GetIndexFromApicId (
   return i;
 }
 
+/**
+  This function return the index of ApicId in the APIC ID order table
+
+  @param ApicId
+
+  @retval Index of the enabled entry in mCpuApicIdOrderTable, or -1 if
+          ApicId is not in the table
+
+**/
 UINT32
 ApicId2SwProcApicId (
   UINT32 ApicId
   )
 {
-  UINT32 Index;
+  UINT32 Low;
+  UINT32 High;
+  UINT32 Mid;
+  UINT32 MidApicId;
 
-  for (Index = 0; Index < MAX_CPU_NUM; Index++) {
-    if ((mCpuApicIdOrderTable[Index].Flags == 1) && (mCpuApicIdOrderTable[Index].ApicId == ApicId)) {
-      return Index;
+  //
+  // mCpuApicIdSortedIndex holds the table indices in ascending ApicId order.
+  //
+  Low  = 0;
+  High = mCpuApicIdOrderCount;
+  while (Low < High) {
+    Mid       = Low + (High - Low) / 2;
+    MidApicId = mCpuApicIdOrderTable[mCpuApicIdSortedIndex[Mid]].ApicId;
+    if (MidApicId == ApicId) {
+      return mCpuApicIdSortedIndex[Mid];
+    }
+    if (MidApicId < ApicId) {
+      Low = Mid + 1;
+    } else {
+      High = Mid;
     }
   }
 
@@ -215,7 +291,7 @@ DebugDisplayReOrderTable(
   UINT32 Index;
 
   DEBUG ((EFI_D_ERROR, "Index  AcpiProcId  ApicId  Flags  SwApicId  Skt\n"));
-  for (Index=0; Index<MAX_CPU_NUM; Index++) {
+  for (Index=0; Index<mCpuApicIdOrderCount; Index++) {
     DEBUG ((EFI_D_ERROR, " %02d       0x%02X      0x%02X      %d      0x%02X     %d\n",
                            Index, mCpuApicIdOrderTable[Index].AcpiProcessorId,
                            mCpuApicIdOrderTable[Index].ApicId,
@@ -271,6 +347,134 @@ AppendCpuMapTableEntry (
 
 }
 
+/**
+  Sort an array in place with a heap sort.
+
+  The CPU tables sorted here grow with the socket count, so an O(n log n) sort
+  that needs no extra allocation is used.
+
+  @param[in, out] Buffer       Array to sort
+  @param[in]      Count        Number of elements in Buffer
+  @param[in]      ElementSize  Size of one element in bytes
+  @param[in]      Compare      Returns <0, 0 or >0 like CompareMem()
+  @param[in]      Scratch      Buffer of at least ElementSize bytes
+
+**/
+STATIC
+VOID
+CpuOrderHeapSort (
+  IN OUT VOID               *Buffer,
+  IN     UINTN              Count,
+  IN     UINTN              ElementSize,
+  IN     CPU_ORDER_COMPARE  Compare,
+  IN     VOID               *Scratch
+  )
+{
+  UINT8   *Base;
+  UINTN   Start;
+  UINTN   End;
+  UINTN   Root;
+  UINTN   Child;
+
+  if (Count < 2) {
+    return;
+  }
+
+  Base = (UINT8 *)Buffer;
+
+  //
+  // Build a max-heap, then repeatedly move the largest element to the end.
+  //
+  Start = Count / 2;
+  End   = Count;
+  while (End > 1) {
+    if (Start > 0) {
+      Start--;
+    } else {
+      End--;
+      CopyMem (Scratch, Base, ElementSize);
+      CopyMem (Base, Base + End * ElementSize, ElementSize);
+      CopyMem (Base + End * ElementSize, Scratch, ElementSize);
+    }
+
+    Root = Start;
+    while ((Child = 2 * Root + 1) < End) {
+      if ((Child + 1 < End) &&
+          (Compare (Base + Child * ElementSize, Base + (Child + 1) * ElementSize) < 0)) {
+        Child++;
+      }
+      if (Compare (Base + Root * ElementSize, Base + Child * ElementSize) >= 0) {
+        break;
+      }
+      CopyMem (Scratch, Base + Root * ElementSize, ElementSize);
+      CopyMem (Base + Root * ElementSize, Base + Child * ElementSize, ElementSize);
+      CopyMem (Base + Child * ElementSize, Scratch, ElementSize);
+      Root = Child;
+    }
+  }
+}
+
+/**
+  Order enabled processors for the APIC ID order table.
+
+  The BSP always comes first. The rest are ordered by thread, then socket,
+  then core, so all primary threads are listed ahead of their siblings.
+
+**/
+STATIC
+INTN
+CompareCpuOrderEntry (
+  IN CONST VOID  *Left,
+  IN CONST VOID  *Right
+  )
+{
+  CONST CPU_ORDER_ENTRY  *L;
+  CONST CPU_ORDER_ENTRY  *R;
+
+  L = (CONST CPU_ORDER_ENTRY *)Left;
+  R = (CONST CPU_ORDER_ENTRY *)Right;
+
+  if (L->IsBsp != R->IsBsp) {
+    return L->IsBsp ? -1 : 1;
+  }
+  if (L->Thread != R->Thread) {
+    return (L->Thread < R->Thread) ? -1 : 1;
+  }
+  if (L->Package != R->Package) {
+    return (L->Package < R->Package) ? -1 : 1;
+  }
+  if (L->Core != R->Core) {
+    return (L->Core < R->Core) ? -1 : 1;
+  }
+  if (L->Map.ApicId != R->Map.ApicId) {
+    return (L->Map.ApicId < R->Map.ApicId) ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+  Order mCpuApicIdSortedIndex entries by the ApicId they refer to.
+
+**/
+STATIC
+INTN
+CompareCpuOrderIndexByApicId (
+  IN CONST VOID  *Left,
+  IN CONST VOID  *Right
+  )
+{
+  UINT32  L;
+  UINT32  R;
+
+  L = mCpuApicIdOrderTable[*(CONST UINT32 *)Left].ApicId;
+  R = mCpuApicIdOrderTable[*(CONST UINT32 *)Right].ApicId;
+
+  if (L != R) {
+    return (L < R) ? -1 : 1;
+  }
+  return 0;
+}
+
 EFI_STATUS
 SortCpuLocalApicInTable (
   VOID
@@ -281,129 +485,100 @@ SortCpuLocalApicInTable (
   UINT32                                    Index;
   UINT32                                    CurrProcessor;
   UINT32                                    BspApicId;
-  UINT32                                    TempVal = 0;
   EFI_CPU_ID_ORDER_MAP                      *CpuIdMapPtr;
   UINT32                                    CoreThreadMask;
+  CPU_ORDER_ENTRY                           *CpuOrder;
+  CPU_ORDER_ENTRY                           CpuOrderScratch;
+  UINT32                                    IndexScratch;
+  UINT32                                    Count;
 
-  Index      = 0;
   Status     = EFI_SUCCESS;
 
   CoreThreadMask = (UINT32) ((1 << mNumOfBitShift) - 1);
 
   if(!mCpuOrderSorted) {
 
-    Index  = 0;
+    if(mX2ApicEnabled) {
+      BspApicId = (UINT32)AsmReadMsr64(0x802);
+    } else {
+      BspApicId = (*(volatile UINT32 *)(UINTN)0xFEE00020) >> 24;
+    }
+    DEBUG ((EFI_D_INFO, "BspApicId - 0x%x\n", BspApicId));
+
+    CpuOrder = AllocatePool (mNumberOfCPUs * sizeof (CPU_ORDER_ENTRY));
+    if (CpuOrder == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
 
+    //
+    // Capture every enabled processor once, compacted so that there are no
+    // holes between enabled threads.
+    //
+    Count = 0;
     for (CurrProcessor = 0; CurrProcessor < mNumberOfCPUs; CurrProcessor++) {
       Status = mMpService->GetProcessorInfo (
                                             mMpService,
                                             CurrProcessor,
                                             &ProcessorInfoBuffer
                                             );
+      if (EFI_ERROR (Status) || (ProcessorInfoBuffer.StatusFlag & PROCESSOR_ENABLED_BIT) == 0) {
+        continue;
+      }
 
-      if ((ProcessorInfoBuffer.StatusFlag & PROCESSOR_ENABLED_BIT) != 0) {
-        if(ProcessorInfoBuffer.ProcessorId & 1) { //is 2nd thread
-          CpuIdMapPtr = (EFI_CPU_ID_ORDER_MAP *)&mCpuApicIdOrderTable[(Index - 1) + MAX_CPU_NUM / 2];
-        } else { //is primary thread
-          CpuIdMapPtr = (EFI_CPU_ID_ORDER_MAP *)&mCpuApicIdOrderTable[Index];
-          Index++;
-        }
-        CpuIdMapPtr->ApicId  = (UINT32)ProcessorInfoBuffer.ProcessorId;
-        CpuIdMapPtr->Flags   = ((ProcessorInfoBuffer.StatusFlag & PROCESSOR_ENABLED_BIT) != 0);
-        CpuIdMapPtr->SocketNum = (UINT32)ProcessorInfoBuffer.Location.Package;
-        CpuIdMapPtr->AcpiProcessorId = (CpuIdMapPtr->SocketNum * FixedPcdGet32(PcdMaxCpuCoreCount) * FixedPcdGet32(PcdMaxCpuThreadCount)) + GetIndexFromApicId(CpuIdMapPtr->ApicId); //CpuIdMapPtr->ApicId;
-        CpuIdMapPtr->SwProcApicId = ((UINT32)(ProcessorInfoBuffer.Location.Package << mNumOfBitShift) + (((UINT32)ProcessorInfoBuffer.ProcessorId) & CoreThreadMask));
-        if(mX2ApicEnabled) { //if X2Apic, re-order the socket # so it starts from base 0 and contiguous
-          //may not necessory!!!!!
-        }
-
-        //update processorbitMask
-        if (CpuIdMapPtr->Flags == 1) {
-
-          if(mForceX2ApicId) {
-            CpuIdMapPtr->SocketNum &= 0x7;
-            CpuIdMapPtr->AcpiProcessorId &= 0xFF; //keep lower 8bit due to use Proc obj in dsdt
-            CpuIdMapPtr->SwProcApicId &= 0xFF;
-          }
-        }
-      } else {  //not enabled
-        CpuIdMapPtr = (EFI_CPU_ID_ORDER_MAP *)&mCpuApicIdOrderTable[Index];
-        CpuIdMapPtr->ApicId  = (UINT32)-1;
-        CpuIdMapPtr->Flags   = 0;
-        CpuIdMapPtr->AcpiProcessorId = (UINT32)-1;
-        CpuIdMapPtr->SwProcApicId = (UINT32)-1;
-        CpuIdMapPtr->SocketNum = (UINT32)-1;
-      } //end if PROC ENABLE
+      CpuOrder[Count].Package = ProcessorInfoBuffer.Location.Package;
+      CpuOrder[Count].Core    = ProcessorInfoBuffer.Location.Core;
+      CpuOrder[Count].Thread  = ProcessorInfoBuffer.Location.Thread;
+      CpuOrder[Count].IsBsp   = (BOOLEAN)((UINT32)ProcessorInfoBuffer.ProcessorId == BspApicId);
+
+      CpuIdMapPtr = &CpuOrder[Count].Map;
+      CpuIdMapPtr->ApicId  = (UINT32)ProcessorInfoBuffer.ProcessorId;
+      CpuIdMapPtr->Flags   = 1;
+      CpuIdMapPtr->SocketNum = (UINT32)ProcessorInfoBuffer.Location.Package;
+      CpuIdMapPtr->AcpiProcessorId = (CpuIdMapPtr->SocketNum * FixedPcdGet32(PcdMaxCpuCoreCount) * FixedPcdGet32(PcdMaxCpuThreadCount)) + GetIndexFromApicId(CpuIdMapPtr->ApicId); //CpuIdMapPtr->ApicId;
+      CpuIdMapPtr->SwProcApicId = ((UINT32)(ProcessorInfoBuffer.Location.Package << mNumOfBitShift) + (((UINT32)ProcessorInfoBuffer.ProcessorId) & CoreThreadMask));
+
+      if(mForceX2ApicId) {
+        CpuIdMapPtr->SocketNum &= 0x7;
+        CpuIdMapPtr->AcpiProcessorId &= 0xFF; //keep lower 8bit due to use Proc obj in dsdt
+        CpuIdMapPtr->SwProcApicId &= 0xFF;
+      }
+      Count++;
     } //end for CurrentProcessor
+    Status = EFI_SUCCESS;
 
-    //keep for debug purpose
-    DEBUG(( EFI_D_ERROR, "::ACPI::  APIC ID Order Table Init.   CoreThreadMask = %x,  mNumOfBitShift = %x\n", CoreThreadMask, mNumOfBitShift));
-    DebugDisplayReOrderTable();
+    CpuOrderHeapSort (CpuOrder, Count, sizeof (CPU_ORDER_ENTRY), CompareCpuOrderEntry, &CpuOrderScratch);
 
-    //make sure 1st entry is BSP
-    if(mX2ApicEnabled) {
-      BspApicId = (UINT32)AsmReadMsr64(0x802);
-    } else {
-      BspApicId = (*(volatile UINT32 *)(UINTN)0xFEE00020) >> 24;
+    for (Index = 0; Index < Count; Index++) {
+      CopyMem (&mCpuApicIdOrderTable[Index], &CpuOrder[Index].Map, sizeof (EFI_CPU_ID_ORDER_MAP));
+      mCpuApicIdSortedIndex[Index] = Index;
     }
-    DEBUG ((EFI_D_INFO, "BspApicId - 0x%x\n", BspApicId));
-
-    if(mCpuApicIdOrderTable[0].ApicId != BspApicId) {
-      //check to see if 1st entry is BSP, if not swap it
-      Index = ApicId2SwProcApicId(BspApicId);
-
-      if(MAX_CPU_NUM <= Index) {
-        DEBUG ((EFI_D_ERROR, "Asserting the SortCpuLocalApicInTable Index Bufferflow\n"));
-        return EFI_INVALID_PARAMETER;
-      }
-
-      TempVal = mCpuApicIdOrderTable[Index].ApicId;
-      mCpuApicIdOrderTable[Index].ApicId = mCpuApicIdOrderTable[0].ApicId;
-      mCpuApicIdOrderTable[0].ApicId = TempVal;
-      mCpuApicIdOrderTable[Index].Flags = mCpuApicIdOrderTable[0].Flags;
-      mCpuApicIdOrderTable[0].Flags = 1;
-      TempVal = mCpuApicIdOrderTable[Index].SwProcApicId;
-      mCpuApicIdOrderTable[Index].SwProcApicId = mCpuApicIdOrderTable[0].SwProcApicId;
-      mCpuApicIdOrderTable[0].SwProcApicId = TempVal;
-      //swap AcpiProcId
-      TempVal = mCpuApicIdOrderTable[Index].AcpiProcessorId;
-      mCpuApicIdOrderTable[Index].AcpiProcessorId = mCpuApicIdOrderTable[0].AcpiProcessorId;
-      mCpuApicIdOrderTable[0].AcpiProcessorId = TempVal;
-
+    FreePool (CpuOrder);
+
+    //make sure disabled entry has ProcId set to FFs
+    for (Index = Count; Index < MAX_CPU_NUM; Index++) {
+      mCpuApicIdOrderTable[Index].Flags = 0;
+      mCpuApicIdOrderTable[Index].ApicId = (UINT32)-1;
+      mCpuApicIdOrderTable[Index].AcpiProcessorId = (UINT32)-1;
+      mCpuApicIdOrderTable[Index].SwProcApicId = (UINT32)-1;
+      mCpuApicIdOrderTable[Index].SocketNum = (UINT32)-1;
     }
+    mCpuApicIdOrderCount = Count;
 
-    //Make sure no holes between enabled threads
-    for(CurrProcessor = 0; CurrProcessor < MAX_CPU_NUM; CurrProcessor++) {
-
-      if(mCpuApicIdOrderTable[CurrProcessor].Flags == 0) {
-        //make sure disabled entry has ProcId set to FFs
-        mCpuApicIdOrderTable[CurrProcessor].ApicId = (UINT32)-1;
-        mCpuApicIdOrderTable[CurrProcessor].AcpiProcessorId = (UINT32)-1;
-        mCpuApicIdOrderTable[CurrProcessor].SwProcApicId = (UINT32)-1;
-
-        for(Index = CurrProcessor+1; Index < MAX_CPU_NUM; Index++) {
-          if(mCpuApicIdOrderTable[Index].Flags == 1) {
-            //move enabled entry up
-            mCpuApicIdOrderTable[CurrProcessor].Flags = 1;
-            mCpuApicIdOrderTable[CurrProcessor].ApicId = mCpuApicIdOrderTable[Index].ApicId;
-            mCpuApicIdOrderTable[CurrProcessor].AcpiProcessorId = mCpuApicIdOrderTable[Index].AcpiProcessorId;
-            mCpuApicIdOrderTable[CurrProcessor].SwProcApicId = mCpuApicIdOrderTable[Index].SwProcApicId;
-            mCpuApicIdOrderTable[CurrProcessor].SocketNum = mCpuApicIdOrderTable[Index].SocketNum;
-            //disable moved entry
-            mCpuApicIdOrderTable[Index].Flags = 0;
-            mCpuApicIdOrderTable[Index].ApicId = (UINT32)-1;
-            mCpuApicIdOrderTable[Index].AcpiProcessorId = (UINT32)-1;
-            mCpuApicIdOrderTable[Index].SwProcApicId = (UINT32)-1;
-            break;
-          }
-        }
-      }
-    }
+    //
+    // Index the table by ApicId for ApicId2SwProcApicId().
+    //
+    CpuOrderHeapSort (mCpuApicIdSortedIndex, Count, sizeof (UINT32), CompareCpuOrderIndexByApicId, &IndexScratch);
 
     //keep for debug purpose
-    DEBUG ((EFI_D_ERROR, "APIC ID Order Table ReOrdered\n"));
+    DEBUG(( EFI_D_ERROR, "::ACPI::  APIC ID Order Table Init.   CoreThreadMask = %x,  mNumOfBitShift = %x\n", CoreThreadMask, mNumOfBitShift));
     DebugDisplayReOrderTable();
 
+    //make sure 1st entry is BSP
+    if (ApicId2SwProcApicId (BspApicId) != 0) {
+      DEBUG ((EFI_D_ERROR, "Asserting the SortCpuLocalApicInTable BSP not found\n"));
+      return EFI_INVALID_PARAMETER;
+    }
+
     mCpuOrderSorted = TRUE;
   }
 
@@ -923,7 +1098,7 @@ InstallMadtFromScratch (
   ProcLocalX2ApicStruct.Reserved[0] = 0;
   ProcLocalX2ApicStruct.Reserved[1] = 0;
 
-  for (Index = 0; Index < MAX_CPU_NUM; Index++) {
+  for (Index = 0; Index < mCpuApicIdOrderCount; Index++) {
     //
     // If x2APIC mode is not enabled, and if it is possible to express the
     // APIC ID as a UINT8, use a processor local APIC structure. Otherwise,
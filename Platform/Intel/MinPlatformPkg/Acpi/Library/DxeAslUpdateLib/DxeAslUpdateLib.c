@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Base.h>
 #include <Uefi/UefiBaseType.h>
 #include <Uefi/UefiSpec.h>
+#include <Library/BaseLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiLib.h>
@@ -21,6 +22,22 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Library/AslUpdateLib.h>
 
+///
+/// One Name object in a table: its NameSeg and where the NameSeg starts.
+///
+typedef struct {
+  UINT32                        Signature;
+  UINT32                        Offset;
+} ASL_NAME_INDEX_ENTRY;
+
+struct _ASL_UPDATE_BATCH {
+  EFI_ACPI_DESCRIPTION_HEADER   *Table;
+  UINTN                         Handle;
+  ASL_NAME_INDEX_ENTRY          *Names;
+  UINTN                         NameCount;
+  BOOLEAN                       Modified;
+};
+
 //
 // Function implementations
 //
@@ -205,9 +222,192 @@ UpdateNameAslCode (
       }
     }
   }
+  FreePool (Table);
   return EFI_NOT_FOUND;
 }
 
+/**
+  Open an ACPI table for a batch of Name updates.
+
+  The table is copied and its Name objects are indexed in one pass: every
+  NameOp followed by a NameSeg, the same pattern UpdateNameAslCode() has
+  always matched on. Lookups then go through the index instead of the table.
+
+  @param[in]  TableSignature   - Signature of the table to update, e.g. the DSDT.
+  @param[out] Batch            - The opened batch.
+
+  @retval EFI_SUCCESS          - The table is open for updates.
+  @retval EFI_NOT_FOUND        - Failed to locate AcpiTable.
+  @retval EFI_NOT_READY        - Not ready to locate AcpiTable.
+  @retval EFI_OUT_OF_RESOURCES - Not enough memory for the copy or the index.
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateBatchOpen (
+  IN     UINT32                        TableSignature,
+  OUT    ASL_UPDATE_BATCH              **Batch
+  )
+{
+  EFI_STATUS                  Status;
+  ASL_UPDATE_BATCH            *NewBatch;
+  UINT8                       *Aml;
+  UINTN                       Index;
+  UINTN                       Count;
+  UINTN                       Pass;
+
+  if (mAcpiTable == NULL) {
+    InitializeAslUpdateLib ();
+    if (mAcpiTable == NULL) {
+      return EFI_NOT_READY;
+    }
+  }
+
+  NewBatch = AllocateZeroPool (sizeof (*NewBatch));
+  if (NewBatch == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ///
+  /// Locate table with matching signature
+  ///
+  Status = LocateAcpiTableBySignature (TableSignature, &NewBatch->Table, &NewBatch->Handle);
+  if (EFI_ERROR (Status)) {
+    FreePool (NewBatch);
+    return Status;
+  }
+
+  ///
+  /// Count the Name objects first, then record them.
+  ///
+  Aml = (UINT8 *) NewBatch->Table;
+  for (Pass = 0; Pass < 2; Pass++) {
+    Count = 0;
+    for (Index = sizeof (EFI_ACPI_DESCRIPTION_HEADER);
+         Index + 1 + sizeof (UINT32) < NewBatch->Table->Length;
+         Index++) {
+      if (Aml[Index] != AML_NAME_OP) {
+        continue;
+      }
+      if (NewBatch->Names != NULL) {
+        NewBatch->Names[Count].Signature = ReadUnaligned32 ((UINT32 *) &Aml[Index + 1]);
+        NewBatch->Names[Count].Offset    = (UINT32) (Index + 1);
+      }
+      Count++;
+    }
+
+    if (Pass == 0) {
+      NewBatch->Names = AllocatePool ((Count + 1) * sizeof (ASL_NAME_INDEX_ENTRY));
+      if (NewBatch->Names == NULL) {
+        FreePool (NewBatch->Table);
+        FreePool (NewBatch);
+        return EFI_OUT_OF_RESOURCES;
+      }
+    }
+  }
+  NewBatch->NameCount = Count;
+
+  *Batch = NewBatch;
+  return EFI_SUCCESS;
+}
+
+/**
+  Update the immediate value assigned to a Name in a batch.
+
+  @param[in] Batch             - Batch returned by AslUpdateBatchOpen().
+  @param[in] AslSignature      - The signature of the Name that we want to update.
+  @param[in] Buffer            - source of data to be written over original aml
+  @param[in] Length            - length of data to be overwritten
+
+  @retval EFI_SUCCESS          - The value is updated in the batch copy of the table.
+  @retval EFI_NOT_FOUND        - The Name is not in the table.
+  @retval EFI_BAD_BUFFER_SIZE  - Length does not match the encoding in the table.
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateBatchSetName (
+  IN     ASL_UPDATE_BATCH              *Batch,
+  IN     UINT32                        AslSignature,
+  IN     VOID                          *Buffer,
+  IN     UINTN                         Length
+  )
+{
+  UINTN                       Index;
+  UINT8                       *NamePointer;
+  UINT8                       DataSize;
+
+  for (Index = 0; Index < Batch->NameCount; Index++) {
+    if (Batch->Names[Index].Signature == AslSignature) {
+      break;
+    }
+  }
+  if (Index == Batch->NameCount) {
+    return EFI_NOT_FOUND;
+  }
+
+  NamePointer = (UINT8 *) Batch->Table + Batch->Names[Index].Offset;
+
+  ///
+  /// Check if size of new and old data is the same
+  ///
+  DataSize = *(NamePointer + 4);
+  if ((Length == 1 && DataSize == 0xA) ||
+      (Length == 2 && DataSize == 0xB) ||
+      (Length == 4 && DataSize == 0xC)) {
+    if (NamePointer + 5 + Length > (UINT8 *) Batch->Table + Batch->Table->Length) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+    CopyMem (NamePointer + 5, Buffer, Length);
+  } else if (Length == 1 && ((*(UINT8*) Buffer) == 0 || (*(UINT8*) Buffer) == 1) && (DataSize == 0 || DataSize == 1)) {
+    CopyMem (NamePointer + 4, Buffer, Length);
+  } else {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  Batch->Modified = TRUE;
+  return EFI_SUCCESS;
+}
+
+/**
+  Close a batch, publishing the updated table once if anything was changed.
+  The ACPI table protocol recomputes the checksum when the table is installed.
+
+  @param[in] Batch             - Batch returned by AslUpdateBatchOpen().
+  @param[in] Commit            - FALSE to discard the updates.
+
+  @retval EFI_SUCCESS          - The function completed successfully.
+  @retval Others               - The updated table could not be installed.
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateBatchClose (
+  IN     ASL_UPDATE_BATCH              *Batch,
+  IN     BOOLEAN                       Commit
+  )
+{
+  EFI_STATUS                  Status;
+  UINTN                       Handle;
+
+  Status = EFI_SUCCESS;
+  if (Commit && Batch->Modified) {
+    Status = mAcpiTable->UninstallAcpiTable (
+                           mAcpiTable,
+                           Batch->Handle
+                           );
+    Handle = 0;
+    Status = mAcpiTable->InstallAcpiTable (
+                           mAcpiTable,
+                           Batch->Table,
+                           Batch->Table->Length,
+                           &Handle
+                           );
+  }
+
+  FreePool (Batch->Names);
+  FreePool (Batch->Table);
+  FreePool (Batch);
+  return Status;
+}
+
 /**
   This procedure will update immediate value assigned to a Name in SSDT table.
 
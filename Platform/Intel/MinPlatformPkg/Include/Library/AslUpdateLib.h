@@ -21,6 +21,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/AcpiTable.h>
 #include <Protocol/AcpiSystemDescriptionTable.h>
 
+///
+/// A table opened for several Name updates, see AslUpdateBatchOpen().
+///
+typedef struct _ASL_UPDATE_BATCH ASL_UPDATE_BATCH;
+
 /**
   This procedure will update immediate value assigned to a Name.
 
@@ -110,4 +115,67 @@ LocateAcpiTableBySignature (
   IN OUT  UINTN                         *Handle
   );
 
+/**
+  Open an ACPI table for a batch of Name updates.
+
+  The table is copied and its Name objects are indexed once, so that any
+  number of AslUpdateBatchSetName() calls can follow without scanning the
+  table again. The table is published once, by AslUpdateBatchClose().
+
+  @param[in]  TableSignature            Signature of the table to update, e.g. the DSDT.
+  @param[out] Batch                     The opened batch.
+
+  @retval EFI_SUCCESS                   The table is open for updates.
+  @retval EFI_NOT_FOUND                 Failed to locate AcpiTable.
+  @retval EFI_NOT_READY                 Not ready to locate AcpiTable.
+  @retval EFI_OUT_OF_RESOURCES          Not enough memory for the copy or the index.
+  @retval EFI_UNSUPPORTED               The function is not supported in this library
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateBatchOpen (
+  IN     UINT32                        TableSignature,
+  OUT    ASL_UPDATE_BATCH              **Batch
+  );
+
+/**
+  Update the immediate value assigned to a Name in a batch.
+  The value is encoded as UpdateNameAslCode() does.
+
+  @param[in] Batch                      Batch returned by AslUpdateBatchOpen().
+  @param[in] AslSignature               The signature of the Name that we want to update.
+  @param[in] Buffer                     source of data to be written over original aml
+  @param[in] Length                     length of data to be overwritten
+
+  @retval EFI_SUCCESS                   The value is updated in the batch copy of the table.
+  @retval EFI_NOT_FOUND                 The Name is not in the table.
+  @retval EFI_BAD_BUFFER_SIZE           Length does not match the encoding in the table.
+  @retval EFI_UNSUPPORTED               The function is not supported in this library
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateBatchSetName (
+  IN     ASL_UPDATE_BATCH              *Batch,
+  IN     UINT32                        AslSignature,
+  IN     VOID                          *Buffer,
+  IN     UINTN                         Length
+  );
+
+/**
+  Close a batch, publishing the updated table once if anything was changed.
+
+  @param[in] Batch                      Batch returned by AslUpdateBatchOpen().
+  @param[in] Commit                     FALSE to discard the updates.
+
+  @retval EFI_SUCCESS                   The function completed successfully.
+  @retval Others                        The updated table could not be installed.
+  @retval EFI_UNSUPPORTED               The function is not supported in this library
+**/
+EFI_STATUS
+EFIAPI
+AslUpdateBatchClose (
+  IN     ASL_UPDATE_BATCH              *Batch,
+  IN     BOOLEAN                       Commit
+  );
+
 #endif
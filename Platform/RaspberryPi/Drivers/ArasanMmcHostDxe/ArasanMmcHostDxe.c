@@ -18,6 +18,19 @@ UINT32 LastExecutedCommand = (UINT32) -1;
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
 STATIC UINTN mMmcHsBase;
 
+//
+// ADMA2 state. Multi-block data commands are held back by MMCSendCommand
+// until the data buffer is known, so that the descriptor table can be
+// programmed before the command is issued.
+//
+STATIC BOOLEAN mAdma2Supported = FALSE;
+STATIC ADMA2_DESCRIPTOR_32 *mAdmaTable;
+STATIC UINTN mAdmaTablePages;
+STATIC EFI_PHYSICAL_ADDRESS mAdmaTableDeviceAddress;
+STATIC VOID *mAdmaTableMapping;
+STATIC UINT32 mPendingDataCmd = (UINT32) -1;
+STATIC UINT32 mPendingDataArg;
+
 STATIC
 UINT32
 EFIAPI
@@ -325,32 +338,32 @@ MMCBuildDevicePath (
   return EFI_SUCCESS;
 }
 
+/**
+   Issues an already translated command to the controller.
+
+   @param MmcCmd         Translated command.
+   @param Argument       Command argument.
+   @param DmaBlockCount  Number of 512-byte blocks to move through the ADMA2
+                         descriptor table, or 0 for a PIO transfer.
+**/
+STATIC
 EFI_STATUS
-MMCSendCommand (
-  IN EFI_MMC_HOST_PROTOCOL    *This,
-  IN MMC_CMD                  MmcCmd,
-  IN UINT32                   Argument
+SendCommand (
+  IN UINT32                   MmcCmd,
+  IN UINT32                   Argument,
+  IN UINTN                    DmaBlockCount
   )
 {
   UINTN MmcStatus;
   UINTN RetryCount = 0;
   UINTN CmdSendOKMask;
+  UINT32 CmdReg;
   EFI_STATUS Status = EFI_SUCCESS;
   BOOLEAN IsAppCmd = (LastExecutedCommand == CMD55);
   BOOLEAN IsDATCmd = FALSE;
   BOOLEAN IsADTCCmd = FALSE;
 
-  DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSendCommand(MmcCmd: %08x, Argument: %08x)\n", MmcCmd, Argument));
-
-  if (IgnoreCommand (MmcCmd)) {
-    return EFI_SUCCESS;
-  }
-
-  MmcCmd = TranslateCommand (MmcCmd, Argument);
-  if (MmcCmd == 0xffffffff) {
-    return EFI_UNSUPPORTED;
-  }
-
+  CmdReg = MmcCmd;
   if ((MmcCmd & CMD_R1_ADTC) == CMD_R1_ADTC) {
     IsADTCCmd = TRUE;
   }
@@ -387,6 +400,19 @@ MMCSendCommand (
     SdMmioWrite32 (MMCHS_BLK, 8);
   } else if (!IsAppCmd && MmcCmd == CMD6) {
     SdMmioWrite32 (MMCHS_BLK, 64);
+  } else if (IsADTCCmd && DmaBlockCount != 0) {
+    //
+    // Let the controller count blocks when the count fits, otherwise the
+    // end descriptor terminates the transfer.
+    //
+    if (DmaBlockCount <= MAX_UINT16) {
+      SdMmioWrite32 (MMCHS_BLK, BLEN_512BYTES | ((UINT32)DmaBlockCount << BLOCK_COUNT_SHIFT));
+      CmdReg |= BCE_ENABLE;
+    } else {
+      SdMmioWrite32 (MMCHS_BLK, BLEN_512BYTES);
+    }
+    SdMmioWrite32 (MMCHS_ADMA_SAL, (UINT32)mAdmaTableDeviceAddress);
+    CmdReg |= DE_ENABLE;
   } else if (IsADTCCmd) {
     SdMmioWrite32 (MMCHS_BLK, BLEN_512BYTES);
   }
@@ -404,7 +430,7 @@ MMCSendCommand (
   SdMmioWrite32 (MMCHS_ARG, Argument);
 
   // Send the command
-  SdMmioWrite32 (MMCHS_CMD, MmcCmd);
+  SdMmioWrite32 (MMCHS_CMD, CmdReg);
 
   // Check for the command status.
   while (RetryCount < MAX_RETRY_COUNT) {
@@ -456,6 +482,45 @@ Exit:
   return Status;
 }
 
+EFI_STATUS
+MMCSendCommand (
+  IN EFI_MMC_HOST_PROTOCOL    *This,
+  IN MMC_CMD                  MmcCmd,
+  IN UINT32                   Argument
+  )
+{
+  DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSendCommand(MmcCmd: %08x, Argument: %08x)\n", MmcCmd, Argument));
+
+  if (IgnoreCommand (MmcCmd)) {
+    return EFI_SUCCESS;
+  }
+
+  MmcCmd = TranslateCommand (MmcCmd, Argument);
+  if (MmcCmd == 0xffffffff) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (mPendingDataCmd != (UINT32) -1) {
+    DEBUG ((DEBUG_WARN, "%a(%u): dropping deferred MMC_CMD%u\n",
+      __FUNCTION__, __LINE__, MMC_CMD_NUM (mPendingDataCmd)));
+    mPendingDataCmd = (UINT32) -1;
+  }
+
+  //
+  // The ADMA2 descriptor table has to be in place before a data command
+  // is issued, but the buffer is only known once ReadBlockData/WriteBlockData
+  // gets called, which MmcDxe always does right after sending CMD18/CMD25.
+  //
+  if (mAdma2Supported &&
+      (MmcCmd == CMD_READ_MULTIPLE_BLOCK || MmcCmd == CMD_WRITE_MULTIPLE_BLOCK)) {
+    mPendingDataCmd = MmcCmd;
+    mPendingDataArg = Argument;
+    return EFI_SUCCESS;
+  }
+
+  return SendCommand (MmcCmd, Argument, 0);
+}
+
 EFI_STATUS
 MMCNotifyState (
   IN EFI_MMC_HOST_PROTOCOL    *This,
@@ -484,6 +549,15 @@ MMCNotifyState (
         return Status;
       }
 
+      mPendingDataCmd = (UINT32) -1;
+      mAdma2Supported = mAdmaTable != NULL &&
+                        (MmioRead32 (MMCHS_CAPA) & ADMA2S) != 0;
+      if (mAdma2Supported) {
+        SdMmioAndThenOr32 (MMCHS_HCTL, (UINT32) ~DMAS_MASK, DMAS_ADMA2_32);
+      }
+      DEBUG ((DEBUG_INFO, "ArasanMMCHost: using %a data transfers\n",
+        mAdma2Supported ? "ADMA2" : "PIO"));
+
       DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: CAP %X CAPH %X\n", MmioRead32(MMCHS_CAPA),MmioRead32(MMCHS_CUR_CAPA)));
 
       // Lets switch to card detect test mode.
@@ -678,10 +752,9 @@ MMCReceiveResponse (
   return EFI_SUCCESS;
 }
 
+STATIC
 EFI_STATUS
-MMCReadBlockData (
-  IN EFI_MMC_HOST_PROTOCOL    *This,
-  IN EFI_LBA                  Lba,
+PioReadBlockData (
   IN UINTN                    Length,
   IN UINT32*                  Buffer
   )
@@ -690,19 +763,6 @@ MMCReadBlockData (
   UINTN RemLength;
   UINTN Count;
 
-  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
-    __FUNCTION__, __LINE__, Lba, Length, Buffer));
-
-  if (Buffer == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __FUNCTION__, __LINE__));
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (Length % sizeof (UINT32) != 0) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __FUNCTION__, __LINE__, Length));
-    return EFI_INVALID_PARAMETER;
-  }
-
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -715,12 +775,9 @@ MMCReadBlockData (
         /*
          * Data is ready.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           *Buffer = MmioRead32 (MMCHS_DATA);
         }
-
-        mFwProtocol->SetLed (FALSE);
         break;
       }
 
@@ -742,10 +799,9 @@ MMCReadBlockData (
   return EFI_SUCCESS;
 }
 
+STATIC
 EFI_STATUS
-MMCWriteBlockData (
-  IN EFI_MMC_HOST_PROTOCOL    *This,
-  IN EFI_LBA                  Lba,
+PioWriteBlockData (
   IN UINTN                    Length,
   IN UINT32*                  Buffer
   )
@@ -754,19 +810,6 @@ MMCWriteBlockData (
   UINTN RemLength;
   UINTN Count;
 
-  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
-    __FUNCTION__, __LINE__, Lba, Length, Buffer));
-
-  if (Buffer == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __FUNCTION__, __LINE__));
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (Length % sizeof (UINT32) != 0) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __FUNCTION__, __LINE__, Length));
-    return EFI_INVALID_PARAMETER;
-  }
-
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -779,12 +822,9 @@ MMCWriteBlockData (
         /*
          * Can write data.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           SdMmioWrite32 (MMCHS_DATA, *Buffer);
         }
-
-        mFwProtocol->SetLed (FALSE);
         break;
       }
 
@@ -806,6 +846,256 @@ MMCWriteBlockData (
   return EFI_SUCCESS;
 }
 
+STATIC
+VOID
+AdmaFreeTable (
+  VOID
+  )
+{
+  if (mAdmaTable != NULL) {
+    DmaUnmap (mAdmaTableMapping);
+    DmaFreeBuffer (mAdmaTablePages, mAdmaTable);
+    mAdmaTable = NULL;
+    mAdmaTablePages = 0;
+  }
+}
+
+/**
+   (Re)allocates the ADMA2 descriptor table. The table must be reachable
+   through the 32-bit ADMA system address register.
+**/
+STATIC
+EFI_STATUS
+AdmaAllocateTable (
+  IN UINTN Pages
+  )
+{
+  EFI_STATUS Status;
+  UINTN BufferSize;
+  VOID *Table;
+  VOID *Mapping;
+  EFI_PHYSICAL_ADDRESS DeviceAddress;
+
+  Status = DmaAllocateBuffer (EfiBootServicesData, Pages, &Table);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  BufferSize = EFI_PAGES_TO_SIZE (Pages);
+  Status = DmaMap (MapOperationBusMasterCommonBuffer, Table, &BufferSize,
+             &DeviceAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    DmaFreeBuffer (Pages, Table);
+    return Status;
+  }
+
+  if (BufferSize != EFI_PAGES_TO_SIZE (Pages) ||
+      DeviceAddress + BufferSize - 1 > MAX_UINT32) {
+    DmaUnmap (Mapping);
+    DmaFreeBuffer (Pages, Table);
+    return EFI_UNSUPPORTED;
+  }
+
+  AdmaFreeTable ();
+  mAdmaTable = Table;
+  mAdmaTablePages = Pages;
+  mAdmaTableDeviceAddress = DeviceAddress;
+  mAdmaTableMapping = Mapping;
+  return EFI_SUCCESS;
+}
+
+/**
+   Issues the data command deferred by MMCSendCommand and moves the data
+   through the ADMA2 engine. Falls back to issuing the command for a PIO
+   transfer if the buffer cannot be used for DMA.
+
+   @param Operation  MapOperationBusMasterWrite for reads from the card,
+                     MapOperationBusMasterRead for writes to the card.
+   @param Length     Transfer length in bytes.
+   @param Buffer     Data buffer.
+**/
+STATIC
+EFI_STATUS
+AdmaTransfer (
+  IN DMA_MAP_OPERATION        Operation,
+  IN UINTN                    Length,
+  IN UINT32*                  Buffer
+  )
+{
+  EFI_STATUS Status;
+  UINT32 MmcCmd;
+  UINT32 Argument;
+  UINTN MmcStatus;
+  UINTN DescCount;
+  UINTN Index;
+  UINTN Offset;
+  UINTN MappedLength;
+  UINTN RetryCount;
+  UINTN MaxRetryCount;
+  EFI_PHYSICAL_ADDRESS DeviceAddress;
+  VOID *Mapping;
+
+  MmcCmd = mPendingDataCmd;
+  Argument = mPendingDataArg;
+  mPendingDataCmd = (UINT32) -1;
+
+  if (Length == 0 ||
+      (Length % BLEN_512BYTES) != 0 ||
+      ((UINTN)Buffer & (sizeof (UINT32) - 1)) != 0) {
+    goto UsePio;
+  }
+
+  DescCount = (Length + ADMA2_MAX_DESC_LENGTH - 1) / ADMA2_MAX_DESC_LENGTH;
+  if (DescCount > EFI_PAGES_TO_SIZE (mAdmaTablePages) / sizeof (ADMA2_DESCRIPTOR_32)) {
+    Status = AdmaAllocateTable (EFI_SIZE_TO_PAGES (DescCount * sizeof (ADMA2_DESCRIPTOR_32)));
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "%a(%u): can't grow ADMA2 table to %u entries: %r\n",
+        __FUNCTION__, __LINE__, DescCount, Status));
+      goto UsePio;
+    }
+  }
+
+  MappedLength = Length;
+  Status = DmaMap (Operation, Buffer, &MappedLength, &DeviceAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    goto UsePio;
+  }
+
+  if (MappedLength != Length ||
+      DeviceAddress + Length - 1 > MAX_UINT32) {
+    DmaUnmap (Mapping);
+    goto UsePio;
+  }
+
+  for (Index = 0, Offset = 0; Offset < Length; Index++, Offset += ADMA2_MAX_DESC_LENGTH) {
+    mAdmaTable[Index].Attributes = ADMA2_ATTR_VALID | ADMA2_ATTR_ACT_TRAN;
+    mAdmaTable[Index].Length = (UINT16)MIN (Length - Offset, ADMA2_MAX_DESC_LENGTH);
+    mAdmaTable[Index].Address = (UINT32)(DeviceAddress + Offset);
+  }
+  mAdmaTable[Index - 1].Attributes |= ADMA2_ATTR_END;
+  MemoryFence ();
+
+  Status = SendCommand (MmcCmd, Argument, Length / BLEN_512BYTES);
+  if (EFI_ERROR (Status)) {
+    goto Unmap;
+  }
+
+  //
+  // Allow for the card to sustain well under 3 MB/s before giving up.
+  //
+  MaxRetryCount = MAX_RETRY_COUNT * (1 + Length / SIZE_1MB);
+  for (RetryCount = 0; RetryCount < MaxRetryCount; RetryCount++) {
+    MmcStatus = MmioRead32 (MMCHS_INT_STAT);
+    if ((MmcStatus & ERRI) != 0) {
+      DEBUG ((DEBUG_ERROR, "%a(%u): MMC_CMD%u ERRI MmcStatus 0x%x\n",
+        __FUNCTION__, __LINE__, MMC_CMD_NUM (MmcCmd), MmcStatus));
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+
+    if ((MmcStatus & TC) != 0) {
+      break;
+    }
+
+    gBS->Stall (STALL_AFTER_RETRY_US);
+  }
+
+  if (RetryCount == MaxRetryCount) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): MMC_CMD%u TIMEOUT %lu bytes PresState 0x%x MmcStatus 0x%x\n",
+      __FUNCTION__, __LINE__, MMC_CMD_NUM (MmcCmd), Length,
+      MmioRead32 (MMCHS_PRES_STATE), MmcStatus));
+    Status = EFI_TIMEOUT;
+  }
+
+  if (EFI_ERROR (Status)) {
+    SoftReset (SRD);
+  }
+  SdMmioWrite32 (MMCHS_INT_STAT, ALL_EN & ~(CARD_INS));
+
+Unmap:
+  DmaUnmap (Mapping);
+  return Status;
+
+UsePio:
+  Status = SendCommand (MmcCmd, Argument, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Operation == MapOperationBusMasterWrite) {
+    return PioReadBlockData (Length, Buffer);
+  }
+  return PioWriteBlockData (Length, Buffer);
+}
+
+EFI_STATUS
+MMCReadBlockData (
+  IN EFI_MMC_HOST_PROTOCOL    *This,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    Length,
+  IN UINT32*                  Buffer
+  )
+{
+  EFI_STATUS Status;
+
+  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
+    __FUNCTION__, __LINE__, Lba, Length, Buffer));
+
+  if (Buffer == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __FUNCTION__, __LINE__));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Length % sizeof (UINT32) != 0) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __FUNCTION__, __LINE__, Length));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mFwProtocol->SetLed (TRUE);
+  if (mPendingDataCmd != (UINT32) -1) {
+    Status = AdmaTransfer (MapOperationBusMasterWrite, Length, Buffer);
+  } else {
+    Status = PioReadBlockData (Length, Buffer);
+  }
+  mFwProtocol->SetLed (FALSE);
+
+  return Status;
+}
+
+EFI_STATUS
+MMCWriteBlockData (
+  IN EFI_MMC_HOST_PROTOCOL    *This,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    Length,
+  IN UINT32*                  Buffer
+  )
+{
+  EFI_STATUS Status;
+
+  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
+    __FUNCTION__, __LINE__, Lba, Length, Buffer));
+
+  if (Buffer == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __FUNCTION__, __LINE__));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Length % sizeof (UINT32) != 0) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __FUNCTION__, __LINE__, Length));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mFwProtocol->SetLed (TRUE);
+  if (mPendingDataCmd != (UINT32) -1) {
+    Status = AdmaTransfer (MapOperationBusMasterRead, Length, Buffer);
+  } else {
+    Status = PioWriteBlockData (Length, Buffer);
+  }
+  mFwProtocol->SetLed (FALSE);
+
+  return Status;
+}
+
 BOOLEAN
 MMCIsMultiBlock (
   IN EFI_MMC_HOST_PROTOCOL *This
@@ -858,6 +1148,11 @@ MMCInitialize (
     return Status;
   }
 
+  Status = AdmaAllocateTable (1);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "ArasanMMCHost: no ADMA2 descriptor table (%r), using PIO\n", Status));
+  }
+
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &Handle,
                   &gRaspberryPiMmcHostProtocolGuid,
@@ -42,4 +42,21 @@
 
 #define MAX_DIVISOR_VALUE 1023
 
+//
+// 32-bit ADMA2 descriptor, as defined by the SD Host Controller spec.
+//
+#define ADMA2_ATTR_VALID       BIT0
+#define ADMA2_ATTR_END         BIT1
+#define ADMA2_ATTR_ACT_TRAN    BIT5
+
+#define ADMA2_MAX_DESC_LENGTH  SIZE_32KB
+
+#pragma pack (1)
+typedef struct {
+  UINT16 Attributes;
+  UINT16 Length;
+  UINT32 Address;
+} ADMA2_DESCRIPTOR_32;
+#pragma pack ()
+
 #endif
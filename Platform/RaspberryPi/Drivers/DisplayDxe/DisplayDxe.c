@@ -19,11 +19,12 @@
 #define MODE_NATIVE_ENABLED   BIT5
 #define JUST_NATIVE_ENABLED   MODE_NATIVE_ENABLED
 #define ALL_MODES             (BIT6 - 1)
-#define POS_TO_FB(posX, posY) ((UINT8*)                                 \
-                               ((UINTN)This->Mode->FrameBufferBase +    \
+#define POS_TO_BUF(Base, posX, posY) ((UINT8*)                          \
+                               ((UINTN)(Base) +                         \
                                 (posY) * This->Mode->Info->PixelsPerScanLine * \
                                 PI3_BYTES_PER_PIXEL +                   \
                                 (posX) * PI3_BYTES_PER_PIXEL))
+#define POS_TO_FB(posX, posY) POS_TO_BUF (This->Mode->FrameBufferBase, posX, posY)
 
 STATIC
 EFI_STATUS
@@ -112,6 +113,14 @@ STATIC EFI_HANDLE mDevice;
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
 STATIC EFI_CPU_ARCH_PROTOCOL *mCpu;
 
+//
+// Copy of the framebuffer in normal memory, see PcdDisplayEnableShadowFb.
+// Blt reads are served from here, and writes land here first and are then
+// pushed to the real framebuffer, rectangle by rectangle.
+//
+STATIC UINT8 *mShadowFb;
+STATIC UINTN mShadowFbPages;
+
 STATIC UINTN mLastMode;
 STATIC GOP_MODE_DATA mGopModeTemplate[] = {
   { 800,  600  }, /* Legacy */
@@ -282,6 +291,19 @@ DisplaySetMode (
   This->Mode->FrameBufferSize = Mode->Width * Mode->Height * PI3_BYTES_PER_PIXEL;
   DEBUG((DEBUG_INFO, "Reported Mode->FrameBufferSize is %u\n", This->Mode->FrameBufferSize));
 
+  if (mShadowFb != NULL) {
+    FreePages (mShadowFb, mShadowFbPages);
+    mShadowFb = NULL;
+  }
+
+  if (PcdGet32 (PcdDisplayEnableShadowFb)) {
+    mShadowFbPages = EFI_SIZE_TO_PAGES (This->Mode->FrameBufferSize);
+    mShadowFb = AllocatePages (mShadowFbPages);
+    if (mShadowFb == NULL) {
+      DEBUG ((DEBUG_WARN, "No memory for shadow framebuffer, using VC memory directly\n"));
+    }
+  }
+
   ClearScreen (This);
   return EFI_SUCCESS;
 }
@@ -304,6 +326,10 @@ DisplayBlt (
 {
   UINT8 *VidBuf, *BltBuf, *VidBuf1;
   UINTN i;
+  UINTN Row;
+  UINTN VidBase;
+  UINTN ScreenWidth;
+  UINTN ScreenHeight;
 
   if ((UINTN)BltOperation >= EfiGraphicsOutputBltOperationMax) {
     return EFI_INVALID_PARAMETER;
@@ -313,12 +339,29 @@ DisplayBlt (
     return EFI_INVALID_PARAMETER;
   }
 
+  ScreenWidth = This->Mode->Info->HorizontalResolution;
+  ScreenHeight = This->Mode->Info->VerticalResolution;
+  if (BltOperation == EfiBltVideoToBltBuffer ||
+      BltOperation == EfiBltVideoToVideo) {
+    if (SourceX + Width > ScreenWidth || SourceY + Height > ScreenHeight) {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+  if (BltOperation != EfiBltVideoToBltBuffer) {
+    if (DestinationX + Width > ScreenWidth ||
+        DestinationY + Height > ScreenHeight) {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  VidBase = (mShadowFb != NULL) ? (UINTN)mShadowFb : This->Mode->FrameBufferBase;
+
   switch (BltOperation) {
   case EfiBltVideoFill:
     BltBuf = (UINT8*)BltBuffer;
 
     for (i = 0; i < Height; i++) {
-      VidBuf = POS_TO_FB (DestinationX, DestinationY + i);
+      VidBuf = POS_TO_BUF (VidBase, DestinationX, DestinationY + i);
 
       SetMem32 (VidBuf, Width * PI3_BYTES_PER_PIXEL, *(UINT32*)BltBuf);
     }
@@ -330,7 +373,7 @@ DisplayBlt (
     }
 
     for (i = 0; i < Height; i++) {
-      VidBuf = POS_TO_FB (SourceX, SourceY + i);
+      VidBuf = POS_TO_BUF (VidBase, SourceX, SourceY + i);
 
       BltBuf = (UINT8*)((UINTN)BltBuffer + (DestinationY + i) * Delta +
         DestinationX * PI3_BYTES_PER_PIXEL);
@@ -345,7 +388,7 @@ DisplayBlt (
     }
 
     for (i = 0; i < Height; i++) {
-      VidBuf = POS_TO_FB (DestinationX, DestinationY + i);
+      VidBuf = POS_TO_BUF (VidBase, DestinationX, DestinationY + i);
       BltBuf = (UINT8*)((UINTN)BltBuffer + (SourceY + i) * Delta +
         SourceX * PI3_BYTES_PER_PIXEL);
 
@@ -355,8 +398,12 @@ DisplayBlt (
 
   case EfiBltVideoToVideo:
     for (i = 0; i < Height; i++) {
-      VidBuf = POS_TO_FB (SourceX, SourceY + i);
-      VidBuf1 = POS_TO_FB (DestinationX, DestinationY + i);
+      //
+      // Go bottom-up when moving the rectangle down over itself.
+      //
+      Row = (DestinationY > SourceY) ? Height - 1 - i : i;
+      VidBuf = POS_TO_BUF (VidBase, SourceX, SourceY + Row);
+      VidBuf1 = POS_TO_BUF (VidBase, DestinationX, DestinationY + Row);
 
       gBS->CopyMem ((VOID*)VidBuf1, (VOID*)VidBuf, Width * PI3_BYTES_PER_PIXEL);
     }
@@ -367,6 +414,18 @@ DisplayBlt (
     break;
   }
 
+  //
+  // Push whatever changed in the shadow copy out to the real framebuffer.
+  // This only ever writes to VC memory, never reads from it.
+  //
+  if (mShadowFb != NULL && BltOperation != EfiBltVideoToBltBuffer) {
+    for (i = 0; i < Height; i++) {
+      gBS->CopyMem (POS_TO_FB (DestinationX, DestinationY + i),
+             POS_TO_BUF (VidBase, DestinationX, DestinationY + i),
+             Width * PI3_BYTES_PER_PIXEL);
+    }
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -644,6 +703,11 @@ DriverStop (
   FreePool (gDisplayProto.Mode);
   gDisplayProto.Mode = NULL;
 
+  if (mShadowFb != NULL) {
+    FreePages (mShadowFb, mShadowFbPages);
+    mShadowFb = NULL;
+  }
+
   gBS->CloseProtocol (
          Controller,
          &gEfiCallerIdGuid,
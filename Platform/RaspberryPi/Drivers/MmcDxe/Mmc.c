@@ -170,6 +170,7 @@ EFI_STATUS DestroyMmcHostInstance (
   if (MmcHostInstance->CardInfo.ECSDData) {
     FreePages (MmcHostInstance->CardInfo.ECSDData, EFI_SIZE_TO_PAGES (sizeof (ECSD)));
   }
+  MmcFreeReadCache (MmcHostInstance);
   FreePool (MmcHostInstance);
 
   return Status;
@@ -365,6 +366,7 @@ CheckCardsCallback (
     if (MmcHostInstance->MmcHost->IsCardPresent (MmcHostInstance->MmcHost) == !MmcHostInstance->Initialized) {
       MmcHostInstance->State = MmcHwInitializationState;
       MmcHostInstance->BlockIo.Media->MediaPresent = !MmcHostInstance->Initialized;
+      MmcInvalidateReadCache (MmcHostInstance);
       MmcHostInstance->Initialized = !MmcHostInstance->Initialized;
 
       if (MmcHostInstance->BlockIo.Media->MediaPresent) {
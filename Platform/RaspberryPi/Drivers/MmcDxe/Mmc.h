@@ -330,6 +330,16 @@ typedef struct {
   ECSD      *ECSDData;                         // MMC V4 extended card specific
 } CARD_INFO;
 
+//
+// One read-ahead window. Valid when BlockCount != 0.
+//
+typedef struct {
+  EFI_LBA                   Lba;
+  UINTN                     BlockCount;
+  UINT64                    LastUse;
+  UINT8                     *Data;
+} MMC_READ_CACHE_ENTRY;
+
 typedef struct _MMC_HOST_INSTANCE {
   UINTN                     Signature;
   LIST_ENTRY                Link;
@@ -342,6 +352,19 @@ typedef struct _MMC_HOST_INSTANCE {
   EFI_MMC_HOST_PROTOCOL     *MmcHost;
 
   BOOLEAN                   Initialized;
+
+  //
+  // Set once CMD13 has shown the card in TRAN after a read, so the next
+  // request can skip polling for it.
+  //
+  BOOLEAN                   CardIsTran;
+
+  MMC_READ_CACHE_ENTRY      *ReadCache;
+  UINTN                     ReadCacheEntries;
+  UINTN                     ReadAheadBlocks;
+  UINTN                     ReadCachePages;
+  UINT8                     *ReadCacheBuffer;
+  UINT64                    ReadCacheTick;
 } MMC_HOST_INSTANCE;
 
 #define MMC_HOST_INSTANCE_SIGNATURE                 SIGNATURE_32('m', 'm', 'c', 'h')
@@ -487,6 +510,28 @@ MmcNotifyState (
   IN MMC_STATE               State
   );
 
+/**
+  Drops all cached read-ahead data, e.g. after the media changed.
+
+  @param  MmcHostInstance        Instance whose cache should be dropped.
+
+**/
+VOID
+MmcInvalidateReadCache (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  );
+
+/**
+  Releases the memory backing the read-ahead cache.
+
+  @param  MmcHostInstance        Instance whose cache should be freed.
+
+**/
+VOID
+MmcFreeReadCache (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  );
+
 EFI_STATUS
 InitializeMmcDevice (
   IN  MMC_HOST_INSTANCE     *MmcHost
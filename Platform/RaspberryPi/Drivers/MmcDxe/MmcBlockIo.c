@@ -7,6 +7,7 @@
  **/
 
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 
 #include "Mmc.h"
 
@@ -167,6 +168,8 @@ MmcReset (
     return EFI_SUCCESS;
   }
 
+  MmcInvalidateReadCache (MmcHostInstance);
+
   // If a card is not present then clear all media settings
   if (!MmcHostInstance->MmcHost->IsCardPresent (MmcHostInstance->MmcHost)) {
     MmcHostInstance->BlockIo.Media->MediaPresent = FALSE;
@@ -233,6 +236,7 @@ MmcTransferBlock (
 
   MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
   MmcHost = MmcHostInstance->MmcHost;
+  MmcHostInstance->CardIsTran = FALSE;
 
   //Set command argument based on the card access mode (Byte mode or Block mode)
   if ((MmcHostInstance->CardInfo.OCRData.AccessMode & MMC_OCR_ACCESS_MASK) ==
@@ -309,6 +313,7 @@ MmcTransferBlock (
     *TransferredSize = BlocksWritten * This->Media->BlockSize;
   } else {
     *TransferredSize = BufferSize;
+    MmcHostInstance->CardIsTran = TRUE;
   }
 
   return Status;
@@ -383,10 +388,16 @@ MmcIoBlocks (
 
   BytesRemainingToBeTransfered = BufferSize;
   while (BytesRemainingToBeTransfered > 0) {
-    Status = WaitUntilTran (MmcHostInstance);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
-      return Status;
+    //
+    // A completed read leaves the card in TRAN, and nothing else talks to
+    // it in between, so don't poll CMD13 again in that case.
+    //
+    if (!MmcHostInstance->CardIsTran) {
+      Status = WaitUntilTran (MmcHostInstance);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
+        return Status;
+      }
     }
 
     if (Transfer == MMC_IOBLOCKS_READ) {
@@ -428,6 +439,178 @@ MmcIoBlocks (
   return EFI_SUCCESS;
 }
 
+VOID
+MmcInvalidateReadCache (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  UINTN Index;
+
+  MmcHostInstance->CardIsTran = FALSE;
+  for (Index = 0; Index < MmcHostInstance->ReadCacheEntries; Index++) {
+    MmcHostInstance->ReadCache[Index].BlockCount = 0;
+  }
+}
+
+VOID
+MmcFreeReadCache (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  if (MmcHostInstance->ReadCacheBuffer != NULL) {
+    FreePages (MmcHostInstance->ReadCacheBuffer, MmcHostInstance->ReadCachePages);
+    MmcHostInstance->ReadCacheBuffer = NULL;
+  }
+  if (MmcHostInstance->ReadCache != NULL) {
+    FreePool (MmcHostInstance->ReadCache);
+    MmcHostInstance->ReadCache = NULL;
+  }
+  MmcHostInstance->ReadCacheEntries = 0;
+}
+
+/**
+  Sets up the read-ahead cache on first use. The window size and entry count
+  come from PcdMmcReadAheadBlocks and PcdMmcReadCacheEntries.
+
+  @retval TRUE   The cache can be used.
+  @retval FALSE  The cache is disabled or could not be allocated.
+**/
+STATIC
+BOOLEAN
+MmcInitReadCache (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  UINTN Entries;
+  UINTN WindowSize;
+  UINTN Index;
+
+  if (MmcHostInstance->ReadCacheEntries != 0) {
+    return TRUE;
+  }
+
+  if (MmcHostInstance->ReadAheadBlocks == MAX_UINTN) {
+    // Disabled, or a previous allocation attempt failed.
+    return FALSE;
+  }
+
+  MmcHostInstance->ReadAheadBlocks = PcdGet32 (PcdMmcReadAheadBlocks);
+  Entries = PcdGet32 (PcdMmcReadCacheEntries);
+  if (MmcHostInstance->ReadAheadBlocks == 0 || Entries == 0 ||
+      PcdGet32 (PcdMmcDisableMulti) != 0) {
+    MmcHostInstance->ReadAheadBlocks = MAX_UINTN;
+    return FALSE;
+  }
+
+  WindowSize = MmcHostInstance->ReadAheadBlocks * MmcHostInstance->BlockIo.Media->BlockSize;
+  MmcHostInstance->ReadCachePages = EFI_SIZE_TO_PAGES (WindowSize * Entries);
+  MmcHostInstance->ReadCacheBuffer = AllocatePages (MmcHostInstance->ReadCachePages);
+  MmcHostInstance->ReadCache = AllocateZeroPool (Entries * sizeof (MMC_READ_CACHE_ENTRY));
+  if (MmcHostInstance->ReadCacheBuffer == NULL || MmcHostInstance->ReadCache == NULL) {
+    DEBUG ((DEBUG_WARN, "%a: no memory for %u x %u block read cache\n",
+      __FUNCTION__, Entries, MmcHostInstance->ReadAheadBlocks));
+    MmcFreeReadCache (MmcHostInstance);
+    MmcHostInstance->ReadAheadBlocks = MAX_UINTN;
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Entries; Index++) {
+    MmcHostInstance->ReadCache[Index].Data = MmcHostInstance->ReadCacheBuffer + Index * WindowSize;
+  }
+  MmcHostInstance->ReadCacheEntries = Entries;
+  return TRUE;
+}
+
+/**
+  Drops cached windows that overlap [Lba, Lba + BlockCount).
+**/
+STATIC
+VOID
+MmcInvalidateReadCacheRange (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BlockCount
+  )
+{
+  MMC_READ_CACHE_ENTRY *Entry;
+  UINTN                Index;
+
+  for (Index = 0; Index < MmcHostInstance->ReadCacheEntries; Index++) {
+    Entry = &MmcHostInstance->ReadCache[Index];
+    if (Entry->BlockCount != 0 &&
+        Lba < Entry->Lba + Entry->BlockCount &&
+        Entry->Lba < Lba + BlockCount) {
+      Entry->BlockCount = 0;
+    }
+  }
+}
+
+/**
+  Serves a small read from the read-ahead cache. Each miss fetches a whole
+  window starting at the missing block with a single multi-block read, and
+  replaces the least recently used window.
+**/
+STATIC
+EFI_STATUS
+MmcCachedReadBlocks (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  EFI_STATUS           Status;
+  EFI_BLOCK_IO_MEDIA   *Media;
+  MMC_READ_CACHE_ENTRY *Entry;
+  MMC_READ_CACHE_ENTRY *Victim;
+  UINTN                Index;
+  UINTN                Offset;
+  UINTN                Count;
+
+  Media = MmcHostInstance->BlockIo.Media;
+
+  while (BufferSize > 0) {
+    Entry = NULL;
+    Victim = &MmcHostInstance->ReadCache[0];
+    for (Index = 0; Index < MmcHostInstance->ReadCacheEntries; Index++) {
+      if (MmcHostInstance->ReadCache[Index].BlockCount != 0 &&
+          Lba >= MmcHostInstance->ReadCache[Index].Lba &&
+          Lba < MmcHostInstance->ReadCache[Index].Lba + MmcHostInstance->ReadCache[Index].BlockCount) {
+        Entry = &MmcHostInstance->ReadCache[Index];
+        break;
+      }
+      if (MmcHostInstance->ReadCache[Index].LastUse < Victim->LastUse) {
+        Victim = &MmcHostInstance->ReadCache[Index];
+      }
+    }
+
+    if (Entry == NULL) {
+      Entry = Victim;
+      Count = (UINTN)MIN (MmcHostInstance->ReadAheadBlocks, Media->LastBlock + 1 - Lba);
+      Entry->BlockCount = 0;
+      Status = MmcIoBlocks (&MmcHostInstance->BlockIo, MMC_IOBLOCKS_READ, MediaId,
+                 Lba, Count * Media->BlockSize, Entry->Data);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+      Entry->Lba = Lba;
+      Entry->BlockCount = Count;
+    }
+
+    Entry->LastUse = ++MmcHostInstance->ReadCacheTick;
+    Offset = (UINTN)(Lba - Entry->Lba);
+    Count = MIN (Entry->BlockCount - Offset, BufferSize / Media->BlockSize);
+    CopyMem (Buffer, Entry->Data + Offset * Media->BlockSize, Count * Media->BlockSize);
+
+    Lba += Count;
+    Buffer = (UINT8*)Buffer + Count * Media->BlockSize;
+    BufferSize -= Count * Media->BlockSize;
+  }
+
+  return EFI_SUCCESS;
+}
+
 EFI_STATUS
 EFIAPI
 MmcReadBlocks (
@@ -438,6 +621,29 @@ MmcReadBlocks (
   OUT VOID                    *Buffer
   )
 {
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_BLOCK_IO_MEDIA      *Media;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
+  Media = This->Media;
+
+  //
+  // Only small, well-formed requests go through the cache. Anything else,
+  // including every request MmcIoBlocks would reject, goes straight to the
+  // card.
+  //
+  if (Buffer != NULL &&
+      BufferSize != 0 &&
+      Media->MediaId == MediaId &&
+      Media->MediaPresent &&
+      (BufferSize % Media->BlockSize) == 0 &&
+      (Lba + (BufferSize / Media->BlockSize)) <= (Media->LastBlock + 1) &&
+      !((Media->IoAlign > 2) && (((UINTN)Buffer & (Media->IoAlign - 1)) != 0)) &&
+      MmcInitReadCache (MmcHostInstance) &&
+      BufferSize / Media->BlockSize < MmcHostInstance->ReadAheadBlocks) {
+    return MmcCachedReadBlocks (MmcHostInstance, MediaId, Lba, BufferSize, Buffer);
+  }
+
   return MmcIoBlocks (This, MMC_IOBLOCKS_READ, MediaId, Lba, BufferSize, Buffer);
 }
 
@@ -451,6 +657,12 @@ MmcWriteBlocks (
   IN VOID                     *Buffer
   )
 {
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
+  MmcInvalidateReadCacheRange (MmcHostInstance, Lba,
+    (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize);
+
   return MmcIoBlocks (This, MMC_IOBLOCKS_WRITE, MediaId, Lba, BufferSize, Buffer);
 }
 
@@ -37,6 +37,42 @@ STATIC UINTN mDmaBufferBusAddress;
 
 STATIC SPIN_LOCK mMailboxLock;
 
+//
+// Properties that do not change after boot, read in a single mailbox
+// transaction when the driver starts. Fields are only valid if the matching
+// RPI_FW_CACHED_* bit is set.
+//
+#define RPI_FW_CACHED_MODEL             BIT0
+#define RPI_FW_CACHED_MODEL_REVISION    BIT1
+#define RPI_FW_CACHED_FW_REVISION       BIT2
+#define RPI_FW_CACHED_SERIAL            BIT3
+#define RPI_FW_CACHED_MAC_ADDRESS       BIT4
+#define RPI_FW_CACHED_ARM_MEMORY        BIT5
+
+#define RPI_FW_CACHED_MAX_CLOCKS        4
+
+typedef struct {
+  UINT32    Valid;
+  UINT32    Model;
+  UINT32    ModelRevision;
+  UINT32    FirmwareRevision;
+  UINT64    Serial;
+  UINT8     MacAddress[6];
+  UINT32    ArmMemoryBase;
+  UINT32    ArmMemorySize;
+  UINT32    MaxClockId[RPI_FW_CACHED_MAX_CLOCKS];
+  UINT32    MaxClockRate[RPI_FW_CACHED_MAX_CLOCKS];
+} RPI_FW_PROPERTY_CACHE;
+
+STATIC RPI_FW_PROPERTY_CACHE mCache;
+
+STATIC CONST UINT32 mCachedMaxClocks[RPI_FW_CACHED_MAX_CLOCKS] = {
+  RPI_MBOX_CLOCK_RATE_ARM,
+  RPI_MBOX_CLOCK_RATE_CORE,
+  RPI_MBOX_CLOCK_RATE_EMMC,
+  RPI_MBOX_CLOCK_RATE_EMMC2
+};
+
 STATIC
 BOOLEAN
 DrainMailbox (
@@ -157,6 +193,8 @@ typedef struct {
   UINT32    TagValueSize;
 } RPI_FW_TAG_HEAD;
 
+#define RPI_FW_MAX_BUFFER_SIZE      EFI_PAGES_TO_SIZE (NUM_PAGES)
+
 typedef struct {
   UINT32                    DeviceId;
   UINT32                    PowerState;
@@ -170,6 +208,103 @@ typedef struct {
 } RPI_FW_SET_POWER_STATE_CMD;
 #pragma pack()
 
+/**
+  Send several property tags to the firmware in one mailbox transaction.
+
+  @param[in, out] Tags      The tags to send. On return, the value of each tag
+                            holds the response and ValueSize its length, or 0
+                            if the firmware did not handle the tag.
+  @param[in]      TagCount  The number of tags.
+
+  @retval EFI_SUCCESS            The transaction completed.
+  @retval EFI_INVALID_PARAMETER  Tags is NULL or TagCount is 0.
+  @retval EFI_BAD_BUFFER_SIZE    The tags do not fit in the mailbox buffer.
+  @retval EFI_DEVICE_ERROR       The transaction failed.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+RpiFirmwareQueryTags (
+  IN OUT RPI_FIRMWARE_TAG  *Tags,
+  IN     UINTN             TagCount
+  )
+{
+  RPI_FW_BUFFER_HEAD          *BufferHead;
+  RPI_FW_TAG_HEAD             *TagHead;
+  EFI_STATUS                  Status;
+  UINTN                       Index;
+  UINTN                       Offset;
+  UINT32                      Result;
+  UINT32                      Length;
+
+  if (Tags == NULL || TagCount == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Offset = sizeof (RPI_FW_BUFFER_HEAD) + sizeof (UINT32);
+  for (Index = 0; Index < TagCount; Index++) {
+    Offset += sizeof (RPI_FW_TAG_HEAD) + ALIGN_VALUE (Tags[Index].ValueSize, sizeof (UINT32));
+  }
+  if (Offset > RPI_FW_MAX_BUFFER_SIZE) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  if (!AcquireSpinLockOrFail (&mMailboxLock)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
+    return EFI_DEVICE_ERROR;
+  }
+
+  BufferHead = mDmaBuffer;
+  ZeroMem (BufferHead, Offset);
+
+  BufferHead->BufferSize  = (UINT32)Offset;
+  BufferHead->Response    = 0;
+
+  Offset = sizeof (RPI_FW_BUFFER_HEAD);
+  for (Index = 0; Index < TagCount; Index++) {
+    TagHead = (RPI_FW_TAG_HEAD *)((UINT8 *)mDmaBuffer + Offset);
+    TagHead->TagId        = Tags[Index].TagId;
+    TagHead->TagSize      = ALIGN_VALUE (Tags[Index].ValueSize, sizeof (UINT32));
+    TagHead->TagValueSize = 0;
+    CopyMem (TagHead + 1, Tags[Index].Value, Tags[Index].ValueSize);
+    Offset += sizeof (RPI_FW_TAG_HEAD) + TagHead->TagSize;
+  }
+  // The end tag is already zeroed
+
+  Status = MailboxTransaction (BufferHead->BufferSize, RPI_MBOX_VC_CHANNEL, &Result);
+
+  if (EFI_ERROR (Status) ||
+      BufferHead->Response != RPI_MBOX_RESP_SUCCESS) {
+    DEBUG ((DEBUG_ERROR,
+      "%a: mailbox transaction error: Status == %r, Response == 0x%x\n",
+      __FUNCTION__, Status, BufferHead->Response));
+    ReleaseSpinLock (&mMailboxLock);
+    return EFI_DEVICE_ERROR;
+  }
+
+  //
+  // The firmware answers each tag in place
+  //
+  Offset = sizeof (RPI_FW_BUFFER_HEAD);
+  for (Index = 0; Index < TagCount; Index++) {
+    TagHead = (RPI_FW_TAG_HEAD *)((UINT8 *)mDmaBuffer + Offset);
+    Offset += sizeof (RPI_FW_TAG_HEAD) + TagHead->TagSize;
+
+    if ((TagHead->TagValueSize & RPI_MBOX_VALUE_SIZE_RESPONSE_MASK) == 0) {
+      Tags[Index].ValueSize = 0;
+      continue;
+    }
+    Length = TagHead->TagValueSize & ~RPI_MBOX_VALUE_SIZE_RESPONSE_MASK;
+    Tags[Index].ValueSize = MIN (Tags[Index].ValueSize, Length);
+    CopyMem (Tags[Index].Value, TagHead + 1, Tags[Index].ValueSize);
+  }
+
+  ReleaseSpinLock (&mMailboxLock);
+
+  return EFI_SUCCESS;
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -249,6 +384,12 @@ RpiFirmwareGetArmMemory (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mCache.Valid & RPI_FW_CACHED_ARM_MEMORY) {
+    *Base = mCache.ArmMemoryBase;
+    *Size = mCache.ArmMemorySize;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -306,6 +447,11 @@ RpiFirmwareGetMacAddress (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mCache.Valid & RPI_FW_CACHED_MAC_ADDRESS) {
+    CopyMem (MacAddress, mCache.MacAddress, sizeof (mCache.MacAddress));
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -361,6 +507,12 @@ RpiFirmwareGetSerial (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mCache.Valid & RPI_FW_CACHED_SERIAL) {
+    *Serial = mCache.Serial;
+    Status = EFI_SUCCESS;
+    goto CheckSerial;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -389,6 +541,9 @@ RpiFirmwareGetSerial (
   }
 
   *Serial = Cmd->TagBody.Serial;
+  Status = EFI_SUCCESS;
+
+CheckSerial:
   // Some platforms return 0 or 0x0000000010000000 for serial.
   // For those, try to use the MAC address.
   if ((*Serial == 0) || ((*Serial & 0xFFFFFFFF0FFFFFFFULL) == 0)) {
@@ -424,6 +579,11 @@ RpiFirmwareGetModel (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mCache.Valid & RPI_FW_CACHED_MODEL) {
+    *Model = mCache.Model;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -479,6 +639,11 @@ RpiFirmwareGetModelRevision (
   EFI_STATUS                    Status;
   UINT32                        Result;
 
+  if (mCache.Valid & RPI_FW_CACHED_MODEL_REVISION) {
+    *Revision = mCache.ModelRevision;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -521,6 +686,11 @@ RpiFirmwareGetFirmwareRevision (
   EFI_STATUS                    Status;
   UINT32                        Result;
 
+  if (mCache.Valid & RPI_FW_CACHED_FW_REVISION) {
+    *Revision = mCache.FirmwareRevision;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -1178,6 +1348,15 @@ RpiFirmwareGetMaxClockRate (
   OUT UINT32    *ClockRate
   )
 {
+  UINTN   Index;
+
+  for (Index = 0; Index < RPI_FW_CACHED_MAX_CLOCKS; Index++) {
+    if (mCache.MaxClockId[Index] == ClockId && mCache.MaxClockRate[Index] != 0) {
+      *ClockRate = mCache.MaxClockRate[Index];
+      return EFI_SUCCESS;
+    }
+  }
+
   return RpiFirmwareGetClockRate (ClockId, RPI_MBOX_GET_MAX_CLOCK_RATE, ClockRate);
 }
 
@@ -1541,9 +1720,98 @@ STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL mRpiFirmwareProtocol = {
   RpiFirmwareNotifyXhciReset,
   RpiFirmwareGetCurrentClockState,
   RpiFirmwareSetClockState,
-  RpiFirmwareNotifyGpioSetCfg
+  RpiFirmwareNotifyGpioSetCfg,
+  RpiFirmwareQueryTags
 };
 
+/**
+  Read the properties that do not change after boot in a single mailbox
+  transaction, so that later queries do not need a round-trip to the
+  VideoCore. Properties the firmware does not report are left out of the
+  cache and queried on demand.
+
+**/
+STATIC
+VOID
+RpiFirmwareFillCache (
+  VOID
+  )
+{
+  RPI_FIRMWARE_TAG            Tags[6 + RPI_FW_CACHED_MAX_CLOCKS];
+  RPI_FW_ARM_MEMORY_TAG       ArmMemory;
+  RPI_FW_MAC_ADDR_TAG         MacAddress;
+  RPI_FW_CLOCK_RATE_TAG       MaxClock[RPI_FW_CACHED_MAX_CLOCKS];
+  EFI_STATUS                  Status;
+  UINTN                       Index;
+
+  ZeroMem (&ArmMemory, sizeof (ArmMemory));
+  ZeroMem (&MacAddress, sizeof (MacAddress));
+
+  Tags[0].TagId     = RPI_MBOX_GET_BOARD_MODEL;
+  Tags[0].ValueSize = sizeof (mCache.Model);
+  Tags[0].Value     = &mCache.Model;
+  Tags[1].TagId     = RPI_MBOX_GET_BOARD_REVISION;
+  Tags[1].ValueSize = sizeof (mCache.ModelRevision);
+  Tags[1].Value     = &mCache.ModelRevision;
+  Tags[2].TagId     = RPI_MBOX_GET_REVISION;
+  Tags[2].ValueSize = sizeof (mCache.FirmwareRevision);
+  Tags[2].Value     = &mCache.FirmwareRevision;
+  Tags[3].TagId     = RPI_MBOX_GET_BOARD_SERIAL;
+  Tags[3].ValueSize = sizeof (mCache.Serial);
+  Tags[3].Value     = &mCache.Serial;
+  Tags[4].TagId     = RPI_MBOX_GET_MAC_ADDRESS;
+  Tags[4].ValueSize = sizeof (MacAddress);
+  Tags[4].Value     = &MacAddress;
+  Tags[5].TagId     = RPI_MBOX_GET_ARM_MEMSIZE;
+  Tags[5].ValueSize = sizeof (ArmMemory);
+  Tags[5].Value     = &ArmMemory;
+
+  for (Index = 0; Index < RPI_FW_CACHED_MAX_CLOCKS; Index++) {
+    MaxClock[Index].ClockId   = mCachedMaxClocks[Index];
+    MaxClock[Index].ClockRate = 0;
+    Tags[6 + Index].TagId     = RPI_MBOX_GET_MAX_CLOCK_RATE;
+    Tags[6 + Index].ValueSize = sizeof (MaxClock[Index]);
+    Tags[6 + Index].Value     = &MaxClock[Index];
+  }
+
+  Status = RpiFirmwareQueryTags (Tags, ARRAY_SIZE (Tags));
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: properties will be queried on demand (Status == %r)\n",
+      __FUNCTION__, Status));
+    ZeroMem (&mCache, sizeof (mCache));
+    return;
+  }
+
+  if (Tags[0].ValueSize == sizeof (mCache.Model)) {
+    mCache.Valid |= RPI_FW_CACHED_MODEL;
+  }
+  if (Tags[1].ValueSize == sizeof (mCache.ModelRevision)) {
+    mCache.Valid |= RPI_FW_CACHED_MODEL_REVISION;
+  }
+  if (Tags[2].ValueSize == sizeof (mCache.FirmwareRevision)) {
+    mCache.Valid |= RPI_FW_CACHED_FW_REVISION;
+  }
+  if (Tags[3].ValueSize == sizeof (mCache.Serial)) {
+    mCache.Valid |= RPI_FW_CACHED_SERIAL;
+  }
+  if (Tags[4].ValueSize >= sizeof (MacAddress.MacAddress)) {
+    CopyMem (mCache.MacAddress, MacAddress.MacAddress, sizeof (mCache.MacAddress));
+    mCache.Valid |= RPI_FW_CACHED_MAC_ADDRESS;
+  }
+  if (Tags[5].ValueSize == sizeof (ArmMemory)) {
+    mCache.ArmMemoryBase = ArmMemory.Base;
+    mCache.ArmMemorySize = ArmMemory.Size;
+    mCache.Valid |= RPI_FW_CACHED_ARM_MEMORY;
+  }
+  for (Index = 0; Index < RPI_FW_CACHED_MAX_CLOCKS; Index++) {
+    if (Tags[6 + Index].ValueSize == sizeof (MaxClock[Index]) &&
+        MaxClock[Index].ClockId == mCachedMaxClocks[Index]) {
+      mCache.MaxClockId[Index]   = MaxClock[Index].ClockId;
+      mCache.MaxClockRate[Index] = MaxClock[Index].ClockRate;
+    }
+  }
+}
+
 /**
   Initialize the state information for the CPU Architectural Protocol
 
@@ -1591,6 +1859,8 @@ RpiFirmwareDxeInitialize (
   //
   ASSERT (!(mDmaBufferBusAddress & (BCM2836_MBOX_NUM_CHANNELS - 1)));
 
+  RpiFirmwareFillCache ();
+
   Status = gBS->InstallProtocolInterface (&ImageHandle,
                   &gRaspberryPiFirmwareProtocolGuid, EFI_NATIVE_INTERFACE,
                   &mRpiFirmwareProtocol);
@@ -30,6 +30,29 @@ FileWrite (
 }
 
 
+EFI_STATUS
+FileRead (
+  IN EFI_FILE_PROTOCOL *File,
+  IN UINTN Offset,
+  IN UINTN Buffer,
+  IN UINTN Size
+  )
+{
+  EFI_STATUS Status;
+  UINTN ReadSize;
+
+  Status = File->SetPosition (File, Offset);
+  if (!EFI_ERROR (Status)) {
+    ReadSize = Size;
+    Status = File->Read (File, &ReadSize, (VOID*)Buffer);
+    if (!EFI_ERROR (Status) && ReadSize != Size) {
+      Status = EFI_END_OF_FILE;
+    }
+  }
+  return Status;
+}
+
+
 VOID
 FileClose (
   IN  EFI_FILE_PROTOCOL *File
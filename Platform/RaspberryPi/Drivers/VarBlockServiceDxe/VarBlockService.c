@@ -86,6 +86,34 @@ EFI_FW_VOL_BLOCK_DEVICE mFvbDeviceTemplate = {
 };
 
 
+STATIC
+VOID
+VarStoreMarkDirty (
+  IN UINTN Address,
+  IN UINTN Length
+  )
+{
+  UINTN Block;
+  UINTN LastBlock;
+
+  if (Length == 0) {
+    return;
+  }
+
+  mFvInstance->Dirty = TRUE;
+  if (mFvInstance->DirtyBlocks == NULL) {
+    return;
+  }
+
+  Block = (Address - mFvInstance->FvBase) / FixedPcdGet32 (PcdFirmwareBlockSize);
+  LastBlock = (Address - mFvInstance->FvBase + Length - 1) /
+              FixedPcdGet32 (PcdFirmwareBlockSize);
+  for (; Block <= LastBlock; Block++) {
+    mFvInstance->DirtyBlocks[Block / 8] |= (UINT8)(1 << (Block % 8));
+  }
+}
+
+
 EFI_STATUS
 VarStoreWrite (
   IN     UINTN Address,
@@ -94,7 +122,7 @@ VarStoreWrite (
   )
 {
   CopyMem ((VOID*)Address, Buffer, *NumBytes);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, *NumBytes);
 
   return EFI_SUCCESS;
 }
@@ -107,7 +135,7 @@ VarStoreErase (
   )
 {
   SetMem ((VOID*)Address, LbaLength, 0xff);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, LbaLength);
 
   return EFI_SUCCESS;
 }
@@ -847,6 +875,11 @@ FvbInitialize (
    * Should I parse config.txt instead and find the real name?
    */
   mFvInstance->MappedFile = L"RPI_EFI.FD";
+  mFvInstance->DirtyBlocks = AllocateRuntimeZeroPool (
+                               (Length / FixedPcdGet32 (PcdFirmwareBlockSize) + 7) / 8);
+  if (mFvInstance->DirtyBlocks == NULL) {
+    DEBUG ((DEBUG_WARN, "No dirty block map, variable store will be dumped whole\n"));
+  }
 
   Status = ValidateFvHeader (mFvInstance->VolumeHeader);
   if (!EFI_ERROR (Status)) {
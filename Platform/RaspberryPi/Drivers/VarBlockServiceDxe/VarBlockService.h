@@ -33,8 +33,33 @@ typedef struct {
   EFI_DEVICE_PATH_PROTOCOL   *Device;
   CHAR16                     *MappedFile;
   BOOLEAN                    Dirty;
+  //
+  // One bit per PcdFirmwareBlockSize block changed since the last dump.
+  // NULL if it could not be allocated, in which case the whole FV is dumped.
+  //
+  UINT8                      *DirtyBlocks;
 } EFI_FW_VOL_INSTANCE;
 
+//
+// Write-back journal. A header, followed by DataSize bytes of records, each
+// made of a VAR_STORE_JOURNAL_RECORD and Length bytes of data destined for
+// Offset within the variable store. Checksum is the CRC32 of the records.
+//
+#define VAR_STORE_JOURNAL_FILE      L"RPI_EFI.JNL"
+#define VAR_STORE_JOURNAL_SIGNATURE SIGNATURE_32 ('V', 'S', 'J', 'L')
+
+typedef struct {
+  UINT32                     Signature;
+  UINT32                     RecordCount;
+  UINT32                     DataSize;
+  UINT32                     Checksum;
+} VAR_STORE_JOURNAL_HEADER;
+
+typedef struct {
+  UINT32                     Offset;
+  UINT32                     Length;
+} VAR_STORE_JOURNAL_RECORD;
+
 extern EFI_FW_VOL_INSTANCE *mFvInstance;
 
 typedef struct {
@@ -184,6 +209,14 @@ FileWrite (
   IN UINTN             Size
   );
 
+EFI_STATUS
+FileRead (
+  IN EFI_FILE_PROTOCOL *File,
+  IN UINTN             Offset,
+  IN UINTN             Buffer,
+  IN UINTN             Size
+  );
+
 EFI_STATUS
 CheckStore (
   IN  EFI_HANDLE SimpleFileSystemHandle,
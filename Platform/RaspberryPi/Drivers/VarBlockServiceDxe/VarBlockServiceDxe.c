@@ -8,6 +8,9 @@
  *
  **/
 
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
 #include "VarBlockService.h"
 
 //
@@ -106,6 +109,7 @@ FvbVirtualAddressChangeEvent (
 {
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->FvBase);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->VolumeHeader);
+  EfiConvertPointer (0x0, (VOID**)&mFvInstance->DirtyBlocks);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance);
 }
 
@@ -130,6 +134,291 @@ InstallVirtualAddressChangeHandler (
 }
 
 
+STATIC
+BOOLEAN
+IsBlockDirty (
+  IN UINTN Block
+  )
+{
+  return (mFvInstance->DirtyBlocks[Block / 8] & (1 << (Block % 8))) != 0;
+}
+
+
+/**
+  Finds the next run of dirty blocks.
+
+  @param[in, out] Block  On input, the block to start searching from.
+                         On output, the first block of the run.
+
+  @return Number of blocks in the run, 0 if there are no more dirty blocks.
+**/
+STATIC
+UINTN
+NextDirtyRun (
+  IN OUT UINTN *Block
+  )
+{
+  UINTN NumBlocks;
+  UINTN Count;
+
+  NumBlocks = mFvInstance->FvLength / FixedPcdGet32 (PcdFirmwareBlockSize);
+  while (*Block < NumBlocks && !IsBlockDirty (*Block)) {
+    (*Block)++;
+  }
+
+  Count = 0;
+  while (*Block + Count < NumBlocks && IsBlockDirty (*Block + Count)) {
+    Count++;
+  }
+  return Count;
+}
+
+
+STATIC
+VOID
+ClearDirtyBlocks (
+  VOID
+  )
+{
+  if (mFvInstance->DirtyBlocks != NULL) {
+    ZeroMem (mFvInstance->DirtyBlocks,
+      (mFvInstance->FvLength / FixedPcdGet32 (PcdFirmwareBlockSize) + 7) / 8);
+  }
+  mFvInstance->Dirty = FALSE;
+}
+
+
+STATIC
+VOID
+JournalDelete (
+  IN EFI_DEVICE_PATH_PROTOCOL *Device
+  )
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *File;
+
+  Status = FileOpen (Device, VAR_STORE_JOURNAL_FILE, &File,
+             EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ);
+  if (!EFI_ERROR (Status)) {
+    File->Delete (File);
+  }
+}
+
+
+/**
+  Saves every dirty run to the journal file, so that an interrupted
+  write-back of the firmware image can be completed on next boot.
+**/
+STATIC
+EFI_STATUS
+JournalWrite (
+  IN EFI_DEVICE_PATH_PROTOCOL *Device
+  )
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *File;
+  VAR_STORE_JOURNAL_HEADER *Header;
+  VAR_STORE_JOURNAL_RECORD *Record;
+  UINTN BlockSize;
+  UINTN Block;
+  UINTN Count;
+  UINTN Size;
+
+  BlockSize = FixedPcdGet32 (PcdFirmwareBlockSize);
+  Size = sizeof (*Header);
+  for (Block = 0; (Count = NextDirtyRun (&Block)) != 0; Block += Count) {
+    Size += sizeof (*Record) + Count * BlockSize;
+  }
+
+  Header = AllocateZeroPool (Size);
+  if (Header == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Record = (VAR_STORE_JOURNAL_RECORD*)(Header + 1);
+  for (Block = 0; (Count = NextDirtyRun (&Block)) != 0; Block += Count) {
+    Record->Offset = (UINT32)(Block * BlockSize);
+    Record->Length = (UINT32)(Count * BlockSize);
+    CopyMem (Record + 1, (VOID*)(mFvInstance->FvBase + Record->Offset), Record->Length);
+    Record = (VAR_STORE_JOURNAL_RECORD*)((UINT8*)(Record + 1) + Record->Length);
+    Header->RecordCount++;
+  }
+
+  Header->Signature = VAR_STORE_JOURNAL_SIGNATURE;
+  Header->DataSize = (UINT32)(Size - sizeof (*Header));
+  gBS->CalculateCrc32 (Header + 1, Header->DataSize, &Header->Checksum);
+
+  Status = FileOpen (Device, VAR_STORE_JOURNAL_FILE, &File,
+             EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ);
+  if (!EFI_ERROR (Status)) {
+    Status = FileWrite (File, 0, (UINTN)Header, Size);
+    FileClose (File);
+  }
+
+  FreePool (Header);
+  return Status;
+}
+
+
+/**
+  Completes a write-back that was interrupted, if the journal holds one.
+
+  @retval TRUE   The journal held data that the in-memory store (loaded
+                 from the interrupted image) does not match, so the
+                 system has to be reset to pick up the repaired image.
+  @retval FALSE  Nothing to do, or the journal was not usable.
+**/
+STATIC
+BOOLEAN
+JournalReplay (
+  IN EFI_DEVICE_PATH_PROTOCOL *Device
+  )
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *File;
+  VAR_STORE_JOURNAL_HEADER Header;
+  VAR_STORE_JOURNAL_RECORD *Record;
+  UINT8 *Data;
+  UINT8 *End;
+  UINT32 Crc;
+  UINT32 Index;
+  BOOLEAN Stale;
+
+  Status = FileOpen (Device, VAR_STORE_JOURNAL_FILE, &File, EFI_FILE_MODE_READ);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  Data = NULL;
+  Stale = FALSE;
+  Status = FileRead (File, 0, (UINTN)&Header, sizeof (Header));
+  if (!EFI_ERROR (Status) &&
+      Header.Signature == VAR_STORE_JOURNAL_SIGNATURE &&
+      Header.DataSize <= Header.RecordCount * sizeof (*Record) + mFvInstance->FvLength) {
+    Data = AllocatePool (Header.DataSize);
+    if (Data != NULL) {
+      Status = FileRead (File, sizeof (Header), (UINTN)Data, Header.DataSize);
+    }
+  }
+  FileClose (File);
+
+  if (Data == NULL || EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  //
+  // A journal that doesn't check out was cut short while being written,
+  // so the firmware image itself was never touched.
+  //
+  gBS->CalculateCrc32 (Data, Header.DataSize, &Crc);
+  if (Crc != Header.Checksum) {
+    goto Done;
+  }
+
+  End = Data + Header.DataSize;
+  Record = (VAR_STORE_JOURNAL_RECORD*)Data;
+  for (Index = 0; Index < Header.RecordCount; Index++) {
+    if ((UINT8*)(Record + 1) + Record->Length > End ||
+        (UINTN)Record->Offset + Record->Length > mFvInstance->FvLength) {
+      goto Done;
+    }
+    Record = (VAR_STORE_JOURNAL_RECORD*)((UINT8*)(Record + 1) + Record->Length);
+  }
+
+  Status = FileOpen (Device, mFvInstance->MappedFile, &File,
+             EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ);
+  if (EFI_ERROR (Status)) {
+    //
+    // Keep the journal around for a later attempt.
+    //
+    FreePool (Data);
+    return FALSE;
+  }
+
+  Record = (VAR_STORE_JOURNAL_RECORD*)Data;
+  for (Index = 0; Index < Header.RecordCount && !EFI_ERROR (Status); Index++) {
+    if (CompareMem (Record + 1, (VOID*)(mFvInstance->FvBase + Record->Offset),
+          Record->Length) != 0) {
+      Stale = TRUE;
+    }
+    Status = FileWrite (File, mFvInstance->Offset + Record->Offset,
+               (UINTN)(Record + 1), Record->Length);
+    Record = (VAR_STORE_JOURNAL_RECORD*)((UINT8*)(Record + 1) + Record->Length);
+  }
+  FileClose (File);
+
+  if (EFI_ERROR (Status)) {
+    FreePool (Data);
+    return FALSE;
+  }
+
+  DEBUG ((DEBUG_INFO, "Replayed %u variable store journal records\n",
+    Header.RecordCount));
+
+Done:
+  if (Data != NULL) {
+    FreePool (Data);
+  }
+  JournalDelete (Device);
+  return Stale;
+}
+
+
+/**
+  Rebuilds the dirty map from the blocks of the in-memory store that differ
+  from the image on Device, so that only those need to be written back.
+**/
+STATIC
+VOID
+SyncDirtyBlocksWithFile (
+  IN EFI_DEVICE_PATH_PROTOCOL *Device
+  )
+{
+  EFI_STATUS Status;
+  EFI_FILE_PROTOCOL *File;
+  UINT8 *Buffer;
+  UINTN BlockSize;
+  UINTN Block;
+
+  if (mFvInstance->DirtyBlocks == NULL) {
+    mFvInstance->Dirty = TRUE;
+    return;
+  }
+
+  BlockSize = FixedPcdGet32 (PcdFirmwareBlockSize);
+  Buffer = AllocatePool (mFvInstance->FvLength);
+  if (Buffer == NULL) {
+    SetMem (mFvInstance->DirtyBlocks,
+      (mFvInstance->FvLength / BlockSize + 7) / 8, 0xff);
+    mFvInstance->Dirty = TRUE;
+    return;
+  }
+
+  Status = FileOpen (Device, mFvInstance->MappedFile, &File, EFI_FILE_MODE_READ);
+  if (!EFI_ERROR (Status)) {
+    Status = FileRead (File, mFvInstance->Offset, (UINTN)Buffer,
+               mFvInstance->FvLength);
+    FileClose (File);
+  }
+
+  ClearDirtyBlocks ();
+  for (Block = 0; Block < mFvInstance->FvLength / BlockSize; Block++) {
+    if (EFI_ERROR (Status) ||
+        CompareMem (Buffer + Block * BlockSize,
+          (VOID*)(mFvInstance->FvBase + Block * BlockSize), BlockSize) != 0) {
+      mFvInstance->DirtyBlocks[Block / 8] |= (UINT8)(1 << (Block % 8));
+      mFvInstance->Dirty = TRUE;
+    }
+  }
+
+  FreePool (Buffer);
+}
+
+
+/**
+  Writes the changed parts of the in-memory store back to the image on
+  Device, coalescing adjacent dirty blocks into a single write.
+**/
 STATIC
 EFI_STATUS
 DoDump (
@@ -138,6 +427,21 @@ DoDump (
 {
   EFI_STATUS Status;
   EFI_FILE_PROTOCOL *File;
+  UINTN BlockSize;
+  UINTN Block;
+  UINTN Count;
+  BOOLEAN Journal;
+
+  Journal = FALSE;
+  if (FixedPcdGetBool (PcdNvStorageJournalEnable) &&
+      mFvInstance->DirtyBlocks != NULL) {
+    Status = JournalWrite (Device);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "Couldn't write variable store journal: %r\n", Status));
+    } else {
+      Journal = TRUE;
+    }
+  }
 
   Status = FileOpen (Device,
              mFvInstance->MappedFile,
@@ -148,11 +452,31 @@ DoDump (
     return Status;
   }
 
-  Status = FileWrite (File,
-             mFvInstance->Offset,
-             mFvInstance->FvBase,
-             mFvInstance->FvLength);
+  if (mFvInstance->DirtyBlocks == NULL) {
+    Status = FileWrite (File,
+               mFvInstance->Offset,
+               mFvInstance->FvBase,
+               mFvInstance->FvLength);
+  } else {
+    BlockSize = FixedPcdGet32 (PcdFirmwareBlockSize);
+    for (Block = 0; (Count = NextDirtyRun (&Block)) != 0; Block += Count) {
+      Status = FileWrite (File,
+                 mFvInstance->Offset + Block * BlockSize,
+                 mFvInstance->FvBase + Block * BlockSize,
+                 Count * BlockSize);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+  }
   FileClose (File);
+
+  if (!EFI_ERROR (Status)) {
+    ClearDirtyBlocks ();
+    if (Journal) {
+      JournalDelete (Device);
+    }
+  }
   return Status;
 }
 
@@ -196,8 +520,6 @@ DumpVars (
     PcdStatus = PcdSet32S (PcdPlatformResetDelay, PLATFORM_RESET_DELAY);
     ASSERT_RETURN_ERROR (PcdStatus);
   }
-
-  mFvInstance->Dirty = FALSE;
 }
 
 
@@ -305,11 +627,30 @@ OnSimpleFileSystemInstall (
       continue;
     }
 
-    Status = DoDump (Device);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "Couldn't update '%s'\n", mFvInstance->MappedFile));
-      ASSERT_EFI_ERROR (Status);
-      continue;
+    if (FixedPcdGetBool (PcdNvStorageJournalEnable) &&
+        JournalReplay (Device)) {
+      //
+      // The variables we booted with came from a half-written image, and
+      // the variable driver has already consumed them. Start over from
+      // the repaired image rather than write the torn copy back.
+      //
+      DEBUG ((DEBUG_WARN, "Variable store repaired from journal, resetting\n"));
+      ClearDirtyBlocks ();
+      EfiResetSystem (EfiResetCold, EFI_SUCCESS, 0, NULL);
+    }
+
+    //
+    // The image on this device need not be the one we were loaded from,
+    // so rebuild the dirty map by comparing against it.
+    //
+    SyncDirtyBlocksWithFile (Device);
+    if (mFvInstance->Dirty) {
+      Status = DoDump (Device);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "Couldn't update '%s'\n", mFvInstance->MappedFile));
+        ASSERT_EFI_ERROR (Status);
+        continue;
+      }
     }
 
     if (mFvInstance->Device != NULL) {
@@ -171,6 +171,24 @@ EFI_STATUS
   UINTN State
   );
 
+//
+// One property tag of a batched firmware query. Value holds the request data
+// on input and receives the response on output, when ValueSize is updated to
+// the number of response bytes, or 0 if the firmware did not handle the tag.
+//
+typedef struct {
+  UINT32    TagId;
+  UINT32    ValueSize;
+  VOID      *Value;
+} RPI_FIRMWARE_TAG;
+
+typedef
+EFI_STATUS
+(EFIAPI *QUERY_TAGS) (
+  IN OUT RPI_FIRMWARE_TAG  *Tags,
+  IN     UINTN             TagCount
+  );
+
 typedef struct {
   SET_POWER_STATE        SetPowerState;
   GET_MAC_ADDRESS        GetMacAddress;
@@ -197,6 +215,7 @@ typedef struct {
   GET_CLOCK_STATE        GetClockState;
   SET_CLOCK_STATE        SetClockState;
   GPIO_SET_CFG           SetGpioConfig;
+  QUERY_TAGS             QueryTags;
 } RASPBERRY_PI_FIRMWARE_PROTOCOL;
 
 extern EFI_GUID gRaspberryPiFirmwareProtocolGuid;
@@ -624,14 +624,34 @@ InitializedProcessorMicrocodeIndex (
   IN MICROCODE_FMP_PRIVATE_DATA *MicrocodeFmpPrivate
   )
 {
-  UINTN       CpuIndex;
-  UINTN       MicrocodeIndex;
-  UINTN       TargetCpuIndex;
-  UINT32      AttemptStatus;
-  EFI_STATUS  Status;
+  UINTN           CpuIndex;
+  UINTN           PrevCpuIndex;
+  UINTN           MicrocodeIndex;
+  UINTN           TargetCpuIndex;
+  UINT32          AttemptStatus;
+  EFI_STATUS      Status;
+  PROCESSOR_INFO  *ProcessorInfo;
+
+  ProcessorInfo = MicrocodeFmpPrivate->ProcessorInfo;
 
   for (CpuIndex = 0; CpuIndex < MicrocodeFmpPrivate->ProcessorCount; CpuIndex++) {
-    if (MicrocodeFmpPrivate->ProcessorInfo[CpuIndex].MicrocodeIndex != (UINTN)-1) {
+    if (ProcessorInfo[CpuIndex].MicrocodeIndex != (UINTN)-1) {
+      continue;
+    }
+    //
+    // Processors with the same signature, platform ID and revision match the
+    // same Microcode, so reuse the result of the first such processor instead
+    // of verifying every Microcode again.
+    //
+    for (PrevCpuIndex = 0; PrevCpuIndex < CpuIndex; PrevCpuIndex++) {
+      if ((ProcessorInfo[PrevCpuIndex].ProcessorSignature == ProcessorInfo[CpuIndex].ProcessorSignature) &&
+          (ProcessorInfo[PrevCpuIndex].PlatformId == ProcessorInfo[CpuIndex].PlatformId) &&
+          (ProcessorInfo[PrevCpuIndex].MicrocodeRevision == ProcessorInfo[CpuIndex].MicrocodeRevision)) {
+        break;
+      }
+    }
+    if (PrevCpuIndex < CpuIndex) {
+      ProcessorInfo[CpuIndex].MicrocodeIndex = ProcessorInfo[PrevCpuIndex].MicrocodeIndex;
       continue;
     }
     for (MicrocodeIndex = 0; MicrocodeIndex < MicrocodeFmpPrivate->DescriptorCount; MicrocodeIndex++) {
@@ -719,6 +739,30 @@ InitializeMicrocodeDescriptor (
   return EFI_SUCCESS;
 }
 
+/**
+  Collect processor information into the ProcessorInfo slot of the calling processor.
+  The function prototype for invoking a function on all Application Processors.
+
+  @param[in,out] Buffer  The pointer to the Microcode driver private data.
+**/
+VOID
+EFIAPI
+CollectProcessorInfoAp (
+  IN OUT VOID  *Buffer
+  )
+{
+  MICROCODE_FMP_PRIVATE_DATA           *MicrocodeFmpPrivate;
+  UINTN                                CpuIndex;
+  EFI_STATUS                           Status;
+
+  MicrocodeFmpPrivate = Buffer;
+  Status = MicrocodeFmpPrivate->MpService->WhoAmI (MicrocodeFmpPrivate->MpService, &CpuIndex);
+  if (EFI_ERROR(Status) || (CpuIndex >= MicrocodeFmpPrivate->ProcessorCount)) {
+    return;
+  }
+  CollectProcessorInfo (&MicrocodeFmpPrivate->ProcessorInfo[CpuIndex]);
+}
+
 /**
   Initialize MicrocodeFmpDriver multiprocessor information.
 
@@ -762,9 +806,34 @@ InitializeProcessorInfo (
   for (Index = 0; Index < NumberOfProcessors; Index++) {
     MicrocodeFmpPrivate->ProcessorInfo[Index].CpuIndex = Index;
     MicrocodeFmpPrivate->ProcessorInfo[Index].MicrocodeIndex = (UINTN)-1;
-    if (Index == BspIndex) {
-      CollectProcessorInfo (&MicrocodeFmpPrivate->ProcessorInfo[Index]);
-    } else {
+  }
+
+  CollectProcessorInfo (&MicrocodeFmpPrivate->ProcessorInfo[BspIndex]);
+
+  //
+  // Wake up all APs at once. Each AP fills its own ProcessorInfo slot.
+  //
+  Status = MpService->StartupAllAPs (
+                        MpService,
+                        CollectProcessorInfoAp,
+                        FALSE,
+                        NULL,
+                        0,
+                        MicrocodeFmpPrivate,
+                        NULL
+                        );
+  if (Status == EFI_NOT_STARTED) {
+    //
+    // No enabled AP.
+    //
+    return EFI_SUCCESS;
+  }
+  if (EFI_ERROR(Status)) {
+    DEBUG((DEBUG_ERROR, "InitializeProcessorInfo - StartupAllAPs - %r\n", Status));
+    for (Index = 0; Index < NumberOfProcessors; Index++) {
+      if (Index == BspIndex) {
+        continue;
+      }
       Status = MpService->StartupThisAP (
                             MpService,
                             CollectProcessorInfo,
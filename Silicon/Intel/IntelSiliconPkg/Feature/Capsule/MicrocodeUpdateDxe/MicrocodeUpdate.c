@@ -166,6 +166,127 @@ LoadMicrocodeOnThis (
   }
 }
 
+/**
+  Load Microcode on the calling processor if it has the same processor
+  signature and platform ID as the verified target.
+  The function prototype for invoking a function on all Application Processors.
+
+  The load is serialized with the other processors, because SMT siblings
+  share the Microcode of their core. The loaded revision is stored in the
+  ProcessorInfo slot of the processor.
+
+  @param[in,out] Buffer  The pointer to MICROCODE_LOAD_ALL_BUFFER.
+**/
+VOID
+EFIAPI
+MicrocodeLoadMatchedAp (
+  IN OUT VOID  *Buffer
+  )
+{
+  MICROCODE_LOAD_ALL_BUFFER            *LoadBuffer;
+  MICROCODE_FMP_PRIVATE_DATA           *MicrocodeFmpPrivate;
+  PROCESSOR_INFO                       *ProcessorInfo;
+  UINTN                                CpuIndex;
+  EFI_STATUS                           Status;
+
+  LoadBuffer = Buffer;
+  MicrocodeFmpPrivate = LoadBuffer->MicrocodeFmpPrivate;
+
+  Status = MicrocodeFmpPrivate->MpService->WhoAmI (MicrocodeFmpPrivate->MpService, &CpuIndex);
+  if (EFI_ERROR(Status) || (CpuIndex >= MicrocodeFmpPrivate->ProcessorCount)) {
+    return;
+  }
+
+  ProcessorInfo = &MicrocodeFmpPrivate->ProcessorInfo[CpuIndex];
+  if ((ProcessorInfo->ProcessorSignature == LoadBuffer->ProcessorSignature) &&
+      (ProcessorInfo->PlatformId == LoadBuffer->PlatformId)) {
+    AcquireSpinLock (&LoadBuffer->Lock);
+    ProcessorInfo->MicrocodeRevision = LoadMicrocode (LoadBuffer->Address);
+    ReleaseSpinLock (&LoadBuffer->Lock);
+  }
+}
+
+/**
+  Load new Microcode on every processor that has the same processor signature
+  and platform ID as the target processor.
+
+  The Microcode is verified once against the target processor. All matching
+  APs are then woken up at once, instead of one by one, and load it in turn.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  CpuIndex                   The index of the target processor.
+  @param[in]  Address                    The address of new Microcode.
+  @param[out] MismatchCount              The number of matching processors that
+                                         ended up with a different revision than
+                                         the target processor.
+
+  @return  Loaded Microcode signature of the target processor.
+
+**/
+UINT32
+LoadMicrocodeOnMatchedProcessors (
+  IN  MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
+  IN  UINTN                       CpuIndex,
+  IN  UINT64                      Address,
+  OUT UINTN                       *MismatchCount
+  )
+{
+  EFI_STATUS                           Status;
+  EFI_MP_SERVICES_PROTOCOL             *MpService;
+  MICROCODE_LOAD_ALL_BUFFER            LoadBuffer;
+  PROCESSOR_INFO                       *ProcessorInfo;
+  PROCESSOR_INFO                       *BspProcessorInfo;
+  UINT32                               TargetRevision;
+  UINTN                                Index;
+
+  MpService = MicrocodeFmpPrivate->MpService;
+  ProcessorInfo = MicrocodeFmpPrivate->ProcessorInfo;
+
+  LoadBuffer.MicrocodeFmpPrivate = MicrocodeFmpPrivate;
+  LoadBuffer.Address             = Address;
+  LoadBuffer.ProcessorSignature  = ProcessorInfo[CpuIndex].ProcessorSignature;
+  LoadBuffer.PlatformId          = ProcessorInfo[CpuIndex].PlatformId;
+  InitializeSpinLock (&LoadBuffer.Lock);
+
+  *MismatchCount = 0;
+
+  Status = MpService->StartupAllAPs (
+                        MpService,
+                        MicrocodeLoadMatchedAp,
+                        FALSE,
+                        NULL,
+                        0,
+                        &LoadBuffer,
+                        NULL
+                        );
+  if (EFI_ERROR(Status) && (Status != EFI_NOT_STARTED)) {
+    //
+    // EFI_NOT_STARTED means there is no enabled AP. For any other failure,
+    // fall back to loading the target processor only.
+    //
+    DEBUG((DEBUG_ERROR, "LoadMicrocodeOnMatchedProcessors - StartupAllAPs - %r\n", Status));
+    return LoadMicrocodeOnThis (MicrocodeFmpPrivate, CpuIndex, Address);
+  }
+
+  BspProcessorInfo = &ProcessorInfo[MicrocodeFmpPrivate->BspIndex];
+  if ((BspProcessorInfo->ProcessorSignature == LoadBuffer.ProcessorSignature) &&
+      (BspProcessorInfo->PlatformId == LoadBuffer.PlatformId)) {
+    BspProcessorInfo->MicrocodeRevision = LoadMicrocode (Address);
+  }
+
+  TargetRevision = ProcessorInfo[CpuIndex].MicrocodeRevision;
+  for (Index = 0; Index < MicrocodeFmpPrivate->ProcessorCount; Index++) {
+    if ((ProcessorInfo[Index].ProcessorSignature == LoadBuffer.ProcessorSignature) &&
+        (ProcessorInfo[Index].PlatformId == LoadBuffer.PlatformId) &&
+        (ProcessorInfo[Index].MicrocodeRevision != TargetRevision)) {
+      DEBUG((DEBUG_ERROR, "LoadMicrocodeOnMatchedProcessors - CPU 0x%x revision 0x%x mismatch\n", Index, ProcessorInfo[Index].MicrocodeRevision));
+      (*MismatchCount)++;
+    }
+  }
+
+  return TargetRevision;
+}
+
 /**
   Collect processor information.
   The function prototype for invoking a function on an Application Processor.
@@ -383,6 +504,7 @@ VerifyMicrocode (
   UINTN                                   TotalSize;
   UINTN                                   DataSize;
   UINT32                                  CurrentRevision;
+  UINTN                                   MismatchCount;
   PROCESSOR_INFO                          *ProcessorInfo;
   UINT32                                  InCompleteCheckSum32;
   UINT32                                  CheckSum32;
@@ -578,8 +700,8 @@ VerifyMicrocode (
   // try load MCU
   //
   if (TryLoad) {
-    CurrentRevision = LoadMicrocodeOnThis(MicrocodeFmpPrivate, ProcessorInfo->CpuIndex, (UINTN)MicrocodeEntryPoint + sizeof(CPU_MICROCODE_HEADER));
-    if (MicrocodeEntryPoint->UpdateRevision != CurrentRevision) {
+    CurrentRevision = LoadMicrocodeOnMatchedProcessors(MicrocodeFmpPrivate, ProcessorInfo->CpuIndex, (UINTN)MicrocodeEntryPoint + sizeof(CPU_MICROCODE_HEADER), &MismatchCount);
+    if ((MicrocodeEntryPoint->UpdateRevision != CurrentRevision) || (MismatchCount != 0)) {
       DEBUG((DEBUG_ERROR, "VerifyMicrocode - fail on LoadMicrocode\n"));
       *LastAttemptStatus = LAST_ATTEMPT_STATUS_ERROR_AUTH_ERROR;
       if (AbortReason != NULL) {
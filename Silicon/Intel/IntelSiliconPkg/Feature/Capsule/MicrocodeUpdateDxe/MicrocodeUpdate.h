@@ -31,6 +31,7 @@
 #include <Library/DevicePathLib.h>
 #include <Library/HobLib.h>
 #include <Library/MicrocodeFlashAccessLib.h>
+#include <Library/SynchronizationLib.h>
 
 #include <Register/Cpuid.h>
 #include <Register/Msr.h>
@@ -95,6 +96,19 @@ struct _MICROCODE_FMP_PRIVATE_DATA {
 
 typedef struct _MICROCODE_FMP_PRIVATE_DATA  MICROCODE_FMP_PRIVATE_DATA;
 
+//
+// Argument of the procedures run on all processors at once. Each processor
+// finds its own slot in MicrocodeFmpPrivate->ProcessorInfo with WhoAmI().
+// Lock serializes the Microcode load, since SMT siblings share one core.
+//
+typedef struct {
+  MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate;
+  UINT64                      Address;
+  UINT32                      ProcessorSignature;
+  UINT8                       PlatformId;
+  SPIN_LOCK                   Lock;
+} MICROCODE_LOAD_ALL_BUFFER;
+
 #define MICROCODE_FMP_LAST_ATTEMPT_VARIABLE_NAME  L"MicrocodeLastAttemptVar"
 
 /**
@@ -596,6 +596,11 @@ OnExitBootServices (
     InvalidateContextCache (VtdIndex);
 
     InvalidateIOTLB (VtdIndex);
+
+    //
+    // Hand over the VTd engine with register based invalidation
+    //
+    DisableQueuedInvalidation (VtdIndex);
   }
 
   if ((PcdGet8(PcdVTdPolicyPropertyMask) & BIT1) == 0) {
@@ -66,6 +66,18 @@ typedef struct {
   PCI_DEVICE_DATA                  *PciDeviceData;
 } PCI_DEVICE_INFORMATION;
 
+//
+// This is the max number of page-selective IOTLB invalidations pending on one
+// VTd engine. If more pages are modified, the whole IOTLB is invalidated.
+//
+#define MAX_VTD_PAGE_INVALIDATION   0x10
+
+typedef struct {
+  UINT64                           Address;
+  UINT16                           DomainIdentifier;
+  UINT8                            AddressMask;
+} VTD_PAGE_INVALIDATION;
+
 typedef struct {
   UINTN                            VtdUnitBaseAddress;
   UINT16                           Segment;
@@ -78,6 +90,14 @@ typedef struct {
   BOOLEAN                          HasDirtyPages;
   PCI_DEVICE_INFORMATION           PciDeviceInfo;
   BOOLEAN                          Is5LevelPaging;
+  BOOLEAN                          QiEnabled;
+  VTD_QI_DESCRIPTOR                *QiDescBuffer;
+  UINTN                            QiDescLength;
+  UINTN                            QiTail;
+  volatile UINT32                  QiWaitStatus;
+  BOOLEAN                          PageInvalidationOverflow;
+  UINTN                            PageInvalidationCount;
+  VTD_PAGE_INVALIDATION            PageInvalidation[MAX_VTD_PAGE_INVALIDATION];
 } VTD_UNIT_INFORMATION;
 
 //
@@ -212,6 +232,43 @@ InvalidateVtdIOTLBGlobal (
   IN UINTN  VtdIndex
   );
 
+/**
+  Invalid VTd IOTLB for the pages recorded in PageInvalidation.
+
+  @param[in]  VtdIndex              The index of VTd engine.
+
+  @retval EFI_SUCCESS           VTd IOTLB is invalidated.
+  @retval EFI_DEVICE_ERROR      VTd IOTLB is not invalidated.
+**/
+EFI_STATUS
+InvalidateVtdIOTLBPages (
+  IN UINTN  VtdIndex
+  );
+
+/**
+  Enable queued invalidation on a VTd engine.
+
+  @param[in]  VtdIndex          The index used to identify a VTd engine.
+
+  @retval EFI_SUCCESS           Queued invalidation is enabled.
+  @retval EFI_UNSUPPORTED       The VTd engine does not support queued invalidation.
+  @retval EFI_OUT_OF_RESOURCES  The invalidation queue cannot be allocated.
+**/
+EFI_STATUS
+EnableQueuedInvalidation (
+  IN UINTN  VtdIndex
+  );
+
+/**
+  Disable queued invalidation on a VTd engine.
+
+  @param[in]  VtdIndex          The index used to identify a VTd engine.
+**/
+VOID
+DisableQueuedInvalidation (
+  IN UINTN  VtdIndex
+  );
+
 /**
   Dump VTd registers.
 
@@ -516,6 +516,81 @@ DumpSecondLevelPagingEntry (
   DEBUG ((DEBUG_VERBOSE,"================\n"));
 }
 
+/**
+  Record a modified page for page-selective IOTLB invalidation.
+
+  Adjacent pages of the same size are merged into one naturally aligned range,
+  as long as the address mask does not exceed the MAMV of the VTd engine.
+
+  @param[in]  VtdIndex          The VTd engine index.
+  @param[in]  DomainIdentifier  The domain ID of the page.
+  @param[in]  Address           The base address of the page.
+  @param[in]  AddressMask       The page size, as log2 of the number of 4KB pages.
+**/
+VOID
+RecordPageInvalidation (
+  IN UINTN                 VtdIndex,
+  IN UINT16                DomainIdentifier,
+  IN UINT64                Address,
+  IN UINT8                 AddressMask
+  )
+{
+  VTD_UNIT_INFORMATION   *VtdUnitInfo;
+  VTD_PAGE_INVALIDATION  *PageInvalidation;
+  UINT64                 Size;
+  UINTN                  Index;
+
+  VtdUnitInfo = &mVtdUnitInformation[VtdIndex];
+  if (VtdUnitInfo->PageInvalidationOverflow) {
+    return;
+  }
+  if (AddressMask > VtdUnitInfo->CapReg.Bits.MAMV) {
+    VtdUnitInfo->PageInvalidationOverflow = TRUE;
+    return;
+  }
+
+  //
+  // Skip the page if it is covered by a recorded range, such as a split large page.
+  //
+  for (Index = 0; Index < VtdUnitInfo->PageInvalidationCount; Index++) {
+    PageInvalidation = &VtdUnitInfo->PageInvalidation[Index];
+    if ((PageInvalidation->DomainIdentifier == DomainIdentifier) &&
+        (PageInvalidation->AddressMask >= AddressMask) &&
+        (Address >= PageInvalidation->Address) &&
+        (Address < PageInvalidation->Address + LShiftU64 (SIZE_4KB, PageInvalidation->AddressMask))) {
+      return;
+    }
+  }
+
+  //
+  // Merge with the last range if it is the lower half of a naturally aligned range twice the size.
+  //
+  while (VtdUnitInfo->PageInvalidationCount != 0) {
+    PageInvalidation = &VtdUnitInfo->PageInvalidation[VtdUnitInfo->PageInvalidationCount - 1];
+    Size = LShiftU64 (SIZE_4KB, AddressMask);
+    if ((PageInvalidation->DomainIdentifier != DomainIdentifier) ||
+        (PageInvalidation->AddressMask != AddressMask) ||
+        (PageInvalidation->Address + Size != Address) ||
+        ((PageInvalidation->Address & Size) != 0) ||
+        (AddressMask + 1 > VtdUnitInfo->CapReg.Bits.MAMV)) {
+      break;
+    }
+    Address = PageInvalidation->Address;
+    AddressMask++;
+    VtdUnitInfo->PageInvalidationCount--;
+  }
+
+  if (VtdUnitInfo->PageInvalidationCount == MAX_VTD_PAGE_INVALIDATION) {
+    VtdUnitInfo->PageInvalidationOverflow = TRUE;
+    return;
+  }
+  PageInvalidation = &VtdUnitInfo->PageInvalidation[VtdUnitInfo->PageInvalidationCount];
+  PageInvalidation->Address = Address;
+  PageInvalidation->DomainIdentifier = DomainIdentifier;
+  PageInvalidation->AddressMask = AddressMask;
+  VtdUnitInfo->PageInvalidationCount++;
+}
+
 /**
   Invalid page entry.
 
@@ -527,10 +602,12 @@ InvalidatePageEntry (
   )
 {
   if (mVtdUnitInformation[VtdIndex].HasDirtyContext || mVtdUnitInformation[VtdIndex].HasDirtyPages) {
-    InvalidateVtdIOTLBGlobal (VtdIndex);
+    InvalidateVtdIOTLBPages (VtdIndex);
   }
   mVtdUnitInformation[VtdIndex].HasDirtyContext = FALSE;
   mVtdUnitInformation[VtdIndex].HasDirtyPages = FALSE;
+  mVtdUnitInformation[VtdIndex].PageInvalidationOverflow = FALSE;
+  mVtdUnitInformation[VtdIndex].PageInvalidationCount = 0;
 }
 
 #define VTD_PG_R                   BIT0
@@ -908,6 +985,7 @@ SetSecondLevelPagingAttribute (
       ConvertSecondLevelPageEntryAttribute (VtdIndex, PageEntry, IoMmuAccess, &IsEntryModified);
       if (IsEntryModified) {
         mVtdUnitInformation[VtdIndex].HasDirtyPages = TRUE;
+        RecordPageInvalidation (VtdIndex, DomainIdentifier, BaseAddress, (UINT8)(HighBitSet64 (PageEntryLength) - EFI_PAGE_SHIFT));
       }
       //
       // Convert success, move to next
@@ -921,6 +999,7 @@ SetSecondLevelPagingAttribute (
         return RETURN_UNSUPPORTED;
       }
       mVtdUnitInformation[VtdIndex].HasDirtyPages = TRUE;
+      RecordPageInvalidation (VtdIndex, DomainIdentifier, BaseAddress & ~((UINT64)PageEntryLength - 1), (UINT8)(HighBitSet64 (PageEntryLength) - EFI_PAGE_SHIFT));
       //
       // Just split current page
       // Convert success in next around
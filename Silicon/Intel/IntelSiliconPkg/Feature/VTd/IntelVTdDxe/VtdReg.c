@@ -12,6 +12,8 @@ VTD_UNIT_INFORMATION             *mVtdUnitInformation;
 
 BOOLEAN  mVtdEnabled;
 
+#define VTD_QI_WAIT_STATUS_DONE   1
+
 /**
   Flush VTD page table and context table memory.
 
@@ -54,6 +56,94 @@ FlushWriteBuffer (
   }
 }
 
+/**
+  Submit invalidation descriptors to the VTd invalidation queue and wait for completion.
+
+  One invalidation wait descriptor is appended to the batch, so the whole batch
+  is completed with a single status poll.
+
+  @param[in]  VtdIndex          The index used to identify a VTd engine.
+  @param[in]  Desc              The invalidation descriptors.
+  @param[in]  DescCount         The number of invalidation descriptors.
+
+  @retval EFI_SUCCESS           The invalidation descriptors are completed.
+  @retval EFI_DEVICE_ERROR      The VTd engine reported an invalidation queue error.
+**/
+EFI_STATUS
+SubmitQueuedInvalidation (
+  IN UINTN              VtdIndex,
+  IN VTD_QI_DESCRIPTOR  *Desc,
+  IN UINTN              DescCount
+  )
+{
+  VTD_UNIT_INFORMATION  *VtdUnitInfo;
+  EFI_STATUS            Status;
+  UINTN                 Index;
+  UINTN                 Tail;
+  UINTN                 WaitIndex;
+  UINTN                 Head;
+  UINT64                WaitDescLo;
+  UINT64                WaitDescHi;
+
+  VtdUnitInfo = &mVtdUnitInformation[VtdIndex];
+
+  //
+  // Every batch is waited for, so the queue is empty here and only the
+  // descriptors of this batch and its wait descriptor need to fit.
+  //
+  ASSERT (DescCount + 1 < VtdUnitInfo->QiDescLength);
+
+  Tail = VtdUnitInfo->QiTail;
+  for (Index = 0; Index < DescCount; Index++) {
+    VtdUnitInfo->QiDescBuffer[Tail].Lo = Desc[Index].Lo;
+    VtdUnitInfo->QiDescBuffer[Tail].Hi = Desc[Index].Hi;
+    Tail = (Tail + 1) % VtdUnitInfo->QiDescLength;
+  }
+
+  VtdUnitInfo->QiWaitStatus = 0;
+  WaitDescLo = V_QI_DESC_TYPE_WAIT | B_QI_WAIT_DESC_SW | B_QI_WAIT_DESC_FN | LShiftU64 (VTD_QI_WAIT_STATUS_DONE, 32);
+  WaitDescHi = (UINT64)(UINTN)&VtdUnitInfo->QiWaitStatus;
+  WaitIndex = Tail;
+  VtdUnitInfo->QiDescBuffer[WaitIndex].Lo = WaitDescLo;
+  VtdUnitInfo->QiDescBuffer[WaitIndex].Hi = WaitDescHi;
+  Tail = (Tail + 1) % VtdUnitInfo->QiDescLength;
+
+  FlushPageTableMemory (VtdIndex, (UINTN)VtdUnitInfo->QiDescBuffer, VtdUnitInfo->QiDescLength * sizeof(VTD_QI_DESCRIPTOR));
+
+  VtdUnitInfo->QiTail = Tail;
+  MmioWrite64 (VtdUnitInfo->VtdUnitBaseAddress + R_IQT_REG, LShiftU64 (Tail, 4));
+
+  Status = EFI_SUCCESS;
+  while (VtdUnitInfo->QiWaitStatus != VTD_QI_WAIT_STATUS_DONE) {
+    if ((MmioRead32 (VtdUnitInfo->VtdUnitBaseAddress + R_FSTS_REG) & B_FSTS_REG_IQE) == 0) {
+      continue;
+    }
+
+    //
+    // The engine stopped at an invalid descriptor. Replace it with a wait
+    // descriptor that writes status 0, so only the wait descriptor of this
+    // batch reports completion and the queue is empty when we return. Then
+    // clear IQE and write IQT again, as some implementations (e.g. QEMU) only
+    // fetch descriptors on an IQT write.
+    //
+    Head = (UINTN)RShiftU64 (MmioRead64 (VtdUnitInfo->VtdUnitBaseAddress + R_IQH_REG), 4) % VtdUnitInfo->QiDescLength;
+    DEBUG ((DEBUG_ERROR,"ERROR: SubmitQueuedInvalidation: IQE is set for VTD(%d), descriptor 0x%016lx 0x%016lx\n",
+      VtdIndex, VtdUnitInfo->QiDescBuffer[Head].Lo, VtdUnitInfo->QiDescBuffer[Head].Hi));
+    Status = EFI_DEVICE_ERROR;
+    if (Head == WaitIndex) {
+      MmioWrite32 (VtdUnitInfo->VtdUnitBaseAddress + R_FSTS_REG, B_FSTS_REG_IQE);
+      break;
+    }
+    VtdUnitInfo->QiDescBuffer[Head].Lo = V_QI_DESC_TYPE_WAIT | B_QI_WAIT_DESC_SW | B_QI_WAIT_DESC_FN;
+    VtdUnitInfo->QiDescBuffer[Head].Hi = WaitDescHi;
+    FlushPageTableMemory (VtdIndex, (UINTN)&VtdUnitInfo->QiDescBuffer[Head], sizeof(VTD_QI_DESCRIPTOR));
+    MmioWrite32 (VtdUnitInfo->VtdUnitBaseAddress + R_FSTS_REG, B_FSTS_REG_IQE);
+    MmioWrite64 (VtdUnitInfo->VtdUnitBaseAddress + R_IQT_REG, LShiftU64 (Tail, 4));
+  }
+
+  return Status;
+}
+
 /**
   Invalidate VTd context cache.
 
@@ -64,7 +154,14 @@ InvalidateContextCache (
   IN UINTN  VtdIndex
   )
 {
-  UINT64  Reg64;
+  UINT64             Reg64;
+  VTD_QI_DESCRIPTOR  Desc;
+
+  if (mVtdUnitInformation[VtdIndex].QiEnabled) {
+    Desc.Lo = V_QI_DESC_TYPE_CC | V_QI_CC_DESC_G_GLOBAL;
+    Desc.Hi = 0;
+    return SubmitQueuedInvalidation (VtdIndex, &Desc, 1);
+  }
 
   Reg64 = MmioRead64 (mVtdUnitInformation[VtdIndex].VtdUnitBaseAddress + R_CCMD_REG);
   if ((Reg64 & B_CCMD_REG_ICC) != 0) {
@@ -93,7 +190,14 @@ InvalidateIOTLB (
   IN UINTN  VtdIndex
   )
 {
-  UINT64  Reg64;
+  UINT64             Reg64;
+  VTD_QI_DESCRIPTOR  Desc;
+
+  if (mVtdUnitInformation[VtdIndex].QiEnabled) {
+    Desc.Lo = V_QI_DESC_TYPE_IOTLB | V_QI_IOTLB_DESC_G_GLOBAL;
+    Desc.Hi = 0;
+    return SubmitQueuedInvalidation (VtdIndex, &Desc, 1);
+  }
 
   Reg64 = MmioRead64 (mVtdUnitInformation[VtdIndex].VtdUnitBaseAddress + (mVtdUnitInformation[VtdIndex].ECapReg.Bits.IRO * 16) + R_IOTLB_REG);
   if ((Reg64 & B_IOTLB_REG_IVT) != 0) {
@@ -125,6 +229,9 @@ InvalidateVtdIOTLBGlobal (
   IN UINTN  VtdIndex
   )
 {
+  VTD_QI_DESCRIPTOR  Desc[2];
+  UINTN              DescCount;
+
   if (!mVtdEnabled) {
     return EFI_SUCCESS;
   }
@@ -136,6 +243,27 @@ InvalidateVtdIOTLBGlobal (
   //
   FlushWriteBuffer (VtdIndex);
 
+  //
+  // Submit the context cache and IOTLB invalidation as one batch
+  //
+  if (mVtdUnitInformation[VtdIndex].QiEnabled) {
+    DescCount = 0;
+    if (mVtdUnitInformation[VtdIndex].HasDirtyContext) {
+      Desc[DescCount].Lo = V_QI_DESC_TYPE_CC | V_QI_CC_DESC_G_GLOBAL;
+      Desc[DescCount].Hi = 0;
+      DescCount++;
+    }
+    if (mVtdUnitInformation[VtdIndex].HasDirtyContext || mVtdUnitInformation[VtdIndex].HasDirtyPages) {
+      Desc[DescCount].Lo = V_QI_DESC_TYPE_IOTLB | V_QI_IOTLB_DESC_G_GLOBAL;
+      Desc[DescCount].Hi = 0;
+      DescCount++;
+    }
+    if (DescCount == 0) {
+      return EFI_SUCCESS;
+    }
+    return SubmitQueuedInvalidation (VtdIndex, Desc, DescCount);
+  }
+
   //
   // Invalidate the context cache
   //
@@ -153,6 +281,170 @@ InvalidateVtdIOTLBGlobal (
   return EFI_SUCCESS;
 }
 
+/**
+  Invalid VTd IOTLB for the pages recorded in PageInvalidation.
+
+  Page-selective invalidation keeps the cached translations of other pages and
+  devices. It falls back to InvalidateVtdIOTLBGlobal() if the context is dirty,
+  the recorded pages overflowed, or the VTd engine does not support it.
+
+  @param[in]  VtdIndex              The index of VTd engine.
+
+  @retval EFI_SUCCESS           VTd IOTLB is invalidated.
+  @retval EFI_DEVICE_ERROR      VTd IOTLB is not invalidated.
+**/
+EFI_STATUS
+InvalidateVtdIOTLBPages (
+  IN UINTN  VtdIndex
+  )
+{
+  VTD_UNIT_INFORMATION   *VtdUnitInfo;
+  VTD_PAGE_INVALIDATION  *PageInvalidation;
+  VTD_QI_DESCRIPTOR      Desc[MAX_VTD_PAGE_INVALIDATION];
+  UINTN                  Index;
+  UINTN                  IotlbRegBase;
+  UINT64                 Reg64;
+
+  if (!mVtdEnabled) {
+    return EFI_SUCCESS;
+  }
+
+  VtdUnitInfo = &mVtdUnitInformation[VtdIndex];
+  if (VtdUnitInfo->HasDirtyContext ||
+      VtdUnitInfo->PageInvalidationOverflow ||
+      (VtdUnitInfo->PageInvalidationCount == 0) ||
+      (VtdUnitInfo->CapReg.Bits.PSI == 0)) {
+    return InvalidateVtdIOTLBGlobal (VtdIndex);
+  }
+
+  DEBUG((DEBUG_VERBOSE, "InvalidateVtdIOTLBPages(%d) - %d\n", VtdIndex, VtdUnitInfo->PageInvalidationCount));
+
+  //
+  // Write Buffer Flush before invalidation
+  //
+  FlushWriteBuffer (VtdIndex);
+
+  if (VtdUnitInfo->QiEnabled) {
+    for (Index = 0; Index < VtdUnitInfo->PageInvalidationCount; Index++) {
+      PageInvalidation = &VtdUnitInfo->PageInvalidation[Index];
+      Desc[Index].Lo = V_QI_DESC_TYPE_IOTLB | V_QI_IOTLB_DESC_G_PAGE | LShiftU64 (PageInvalidation->DomainIdentifier, 16);
+      Desc[Index].Hi = PageInvalidation->Address | PageInvalidation->AddressMask;
+    }
+    return SubmitQueuedInvalidation (VtdIndex, Desc, VtdUnitInfo->PageInvalidationCount);
+  }
+
+  IotlbRegBase = VtdUnitInfo->VtdUnitBaseAddress + (VtdUnitInfo->ECapReg.Bits.IRO * 16);
+  for (Index = 0; Index < VtdUnitInfo->PageInvalidationCount; Index++) {
+    PageInvalidation = &VtdUnitInfo->PageInvalidation[Index];
+
+    Reg64 = MmioRead64 (IotlbRegBase + R_IOTLB_REG);
+    if ((Reg64 & B_IOTLB_REG_IVT) != 0) {
+      DEBUG ((DEBUG_ERROR,"ERROR: InvalidateVtdIOTLBPages: B_IOTLB_REG_IVT is set for VTD(%d)\n", VtdIndex));
+      return EFI_DEVICE_ERROR;
+    }
+
+    MmioWrite64 (IotlbRegBase + R_IVA_REG, PageInvalidation->Address | PageInvalidation->AddressMask);
+
+    //
+    // DID is bit 47:32 of the IOTLB register
+    //
+    Reg64 &= ((~B_IOTLB_REG_IVT) & (~B_IOTLB_REG_IIRG_MASK) & (~LShiftU64 (0xFFFF, 32)));
+    Reg64 |= (B_IOTLB_REG_IVT | V_IOTLB_REG_IIRG_PAGE | LShiftU64 (PageInvalidation->DomainIdentifier, 32));
+    MmioWrite64 (IotlbRegBase + R_IOTLB_REG, Reg64);
+
+    do {
+      Reg64 = MmioRead64 (IotlbRegBase + R_IOTLB_REG);
+    } while ((Reg64 & B_IOTLB_REG_IVT) != 0);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Enable queued invalidation on a VTd engine.
+
+  @param[in]  VtdIndex          The index used to identify a VTd engine.
+
+  @retval EFI_SUCCESS           Queued invalidation is enabled.
+  @retval EFI_UNSUPPORTED       The VTd engine does not support queued invalidation.
+  @retval EFI_OUT_OF_RESOURCES  The invalidation queue cannot be allocated.
+**/
+EFI_STATUS
+EnableQueuedInvalidation (
+  IN UINTN  VtdIndex
+  )
+{
+  VTD_UNIT_INFORMATION  *VtdUnitInfo;
+  UINT32                Reg32;
+
+  VtdUnitInfo = &mVtdUnitInformation[VtdIndex];
+  if (VtdUnitInfo->ECapReg.Bits.QI == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (VtdUnitInfo->QiDescBuffer == NULL) {
+    VtdUnitInfo->QiDescBuffer = AllocateZeroPages (1);
+    if (VtdUnitInfo->QiDescBuffer == NULL) {
+      DEBUG ((DEBUG_ERROR,"EnableQueuedInvalidation: No resource for VTD(%d)\n", VtdIndex));
+      return EFI_OUT_OF_RESOURCES;
+    }
+    VtdUnitInfo->QiDescLength = SIZE_4KB / sizeof(VTD_QI_DESCRIPTOR);
+  }
+
+  //
+  // IQA can only be programmed while queued invalidation is disabled
+  //
+  DisableQueuedInvalidation (VtdIndex);
+
+  VtdUnitInfo->QiTail = 0;
+  MmioWrite64 (VtdUnitInfo->VtdUnitBaseAddress + R_IQT_REG, 0);
+
+  //
+  // 128-bit descriptors (DW = 0) in one 4KB page (QS = 0)
+  //
+  MmioWrite64 (VtdUnitInfo->VtdUnitBaseAddress + R_IQA_REG, (UINT64)(UINTN)VtdUnitInfo->QiDescBuffer);
+
+  Reg32 = MmioRead32 (VtdUnitInfo->VtdUnitBaseAddress + R_GSTS_REG);
+  Reg32 = (Reg32 & 0x96FFFFFF);       // Reset the one-shot bits
+  MmioWrite32 (VtdUnitInfo->VtdUnitBaseAddress + R_GCMD_REG, Reg32 | B_GMCD_REG_QIE);
+
+  DEBUG((DEBUG_INFO, "EnableQueuedInvalidation: Waiting B_GSTS_REG_QIES ...\n"));
+  do {
+    Reg32 = MmioRead32 (VtdUnitInfo->VtdUnitBaseAddress + R_GSTS_REG);
+  } while ((Reg32 & B_GSTS_REG_QIES) == 0);
+
+  VtdUnitInfo->QiEnabled = TRUE;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Disable queued invalidation on a VTd engine.
+
+  @param[in]  VtdIndex          The index used to identify a VTd engine.
+**/
+VOID
+DisableQueuedInvalidation (
+  IN UINTN  VtdIndex
+  )
+{
+  UINT32  Reg32;
+
+  mVtdUnitInformation[VtdIndex].QiEnabled = FALSE;
+
+  Reg32 = MmioRead32 (mVtdUnitInformation[VtdIndex].VtdUnitBaseAddress + R_GSTS_REG);
+  if ((Reg32 & B_GSTS_REG_QIES) == 0) {
+    return;
+  }
+
+  Reg32 = (Reg32 & 0x96FFFFFF);       // Reset the one-shot bits
+  MmioWrite32 (mVtdUnitInformation[VtdIndex].VtdUnitBaseAddress + R_GCMD_REG, Reg32 & ~B_GMCD_REG_QIE);
+
+  do {
+    Reg32 = MmioRead32 (mVtdUnitInformation[VtdIndex].VtdUnitBaseAddress + R_GSTS_REG);
+  } while ((Reg32 & B_GSTS_REG_QIES) != 0);
+}
+
 /**
   Prepare VTD configuration.
 **/
@@ -269,6 +561,15 @@ EnableDmar (
     //
     FlushWriteBuffer (Index);
 
+    //
+    // Use queued invalidation if it is supported
+    //
+    if (mVtdUnitInformation[Index].ECapReg.Bits.QI != 0) {
+      if (EFI_ERROR (EnableQueuedInvalidation (Index))) {
+        DEBUG((DEBUG_WARN, "EnableDmar: Queued invalidation is not enabled for VTD(%d)\n", Index));
+      }
+    }
+
     //
     // Invalidate the context cache
     //
@@ -280,9 +581,11 @@ EnableDmar (
     InvalidateIOTLB (Index);
 
     //
-    // Enable VTd
+    // Enable VTd, keep queued invalidation enabled
     //
-    MmioWrite32 (mVtdUnitInformation[Index].VtdUnitBaseAddress + R_GCMD_REG, B_GMCD_REG_TE);
+    Reg32 = MmioRead32 (mVtdUnitInformation[Index].VtdUnitBaseAddress + R_GSTS_REG);
+    Reg32 = (Reg32 & 0x96FFFFFF);       // Reset the one-shot bits
+    MmioWrite32 (mVtdUnitInformation[Index].VtdUnitBaseAddress + R_GCMD_REG, Reg32 | B_GMCD_REG_TE);
     DEBUG((DEBUG_INFO, "EnableDmar: Waiting B_GSTS_REG_TE ...\n"));
     do {
       Reg32 = MmioRead32 (mVtdUnitInformation[Index].VtdUnitBaseAddress + R_GSTS_REG);
@@ -326,6 +629,11 @@ DisableDmar (
     //
     FlushWriteBuffer (Index);
 
+    //
+    // Return to register based invalidation
+    //
+    DisableQueuedInvalidation (Index);
+
     //
     // Disable Dmar
     //
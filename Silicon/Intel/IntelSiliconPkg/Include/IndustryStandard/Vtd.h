@@ -206,10 +206,12 @@ typedef union {
 #define   B_CAP_REG_RWBF       BIT4
 #define R_ECAP_REG       0x10
 #define R_GCMD_REG       0x18
+#define   B_GMCD_REG_QIE       BIT26
 #define   B_GMCD_REG_WBF       BIT27
 #define   B_GMCD_REG_SRTP      BIT30
 #define   B_GMCD_REG_TE        BIT31
 #define R_GSTS_REG       0x1C
+#define   B_GSTS_REG_QIES      BIT26
 #define   B_GSTS_REG_WBF       BIT27
 #define   B_GSTS_REG_RTPS      BIT30
 #define   B_GSTS_REG_TE        BIT31
@@ -221,11 +223,15 @@ typedef union {
 #define   V_CCMD_REG_CIRG_DEVICE  (BIT62|BIT61)
 #define   B_CCMD_REG_ICC          BIT63
 #define R_FSTS_REG       0x34
+#define   B_FSTS_REG_IQE          BIT4
 #define R_FECTL_REG      0x38
 #define R_FEDATA_REG     0x3C
 #define R_FEADDR_REG     0x40
 #define R_FEUADDR_REG    0x44
 #define R_AFLOG_REG      0x58
+#define R_IQH_REG        0x80
+#define R_IQT_REG        0x88
+#define R_IQA_REG        0x90
 
 #define R_IVA_REG        0x00 // + IRO
 #define   B_IVA_REG_AM_MASK       (BIT0|BIT1|BIT2|BIT3|BIT4|BIT5)
@@ -247,6 +253,19 @@ typedef union {
 #define R_PMEN_HIGH_BASE_REG      0x70
 #define R_PMEN_HIGH_LIMITE_REG    0x78
 
+//
+// Queued Invalidation Descriptors
+//
+#define V_QI_DESC_TYPE_CC         0x1
+#define V_QI_DESC_TYPE_IOTLB      0x2
+#define V_QI_DESC_TYPE_WAIT       0x5
+#define   V_QI_CC_DESC_G_GLOBAL       BIT4
+#define   V_QI_IOTLB_DESC_G_GLOBAL    BIT4
+#define   V_QI_IOTLB_DESC_G_DOMAIN    BIT5
+#define   V_QI_IOTLB_DESC_G_PAGE      (BIT5|BIT4)
+#define   B_QI_WAIT_DESC_SW           BIT5
+#define   B_QI_WAIT_DESC_FN           BIT6
+
 typedef union {
   struct {
     UINT8         ND:3; // Number of domains supported
@@ -336,6 +355,11 @@ typedef union {
   UINT64     Uint64[2];
 } VTD_FRCD_REG;
 
+typedef struct {
+  UINT64     Lo;
+  UINT64     Hi;
+} VTD_QI_DESCRIPTOR;
+
 typedef union {
   struct {
     UINT8    Function:3;
@@ -424,6 +424,10 @@ VOID
 struct _DATABASE_RECORD {
   UINT32                        Signature;
   LIST_ENTRY                    Link;
+  ///
+  /// Link in the SMI_STS dispatch bucket this record was grouped into
+  ///
+  LIST_ENTRY                    SmiStsLink;
   BOOLEAN                       Processed;
   ///
   /// Status and Enable bit description
@@ -469,6 +473,7 @@ struct _DATABASE_RECORD {
 
 #define DATABASE_RECORD_FROM_LINK(_record)  CR (_record, DATABASE_RECORD, Link, DATABASE_RECORD_SIGNATURE)
 #define DATABASE_RECORD_FROM_CHILDCONTEXT(_record)  CR (_record, DATABASE_RECORD, ChildContext, DATABASE_RECORD_SIGNATURE)
+#define DATABASE_RECORD_FROM_SMI_STS_LINK(_record)  CR (_record, DATABASE_RECORD, SmiStsLink, DATABASE_RECORD_SIGNATURE)
 
 ///
 /// HOOKING INTO THE ARCHITECTURE
@@ -593,6 +598,15 @@ typedef struct {
   PROTOCOL_SIGNATURE \
   )
 
+///
+/// Records are also grouped into one bucket per PMC SMI_STS bit, so the
+/// dispatcher only has to look at the children of the status bits that are set.
+/// Records whose source cannot be tied to an SMI_STS bit go to the last bucket,
+/// which is checked on every SMI.
+///
+#define SMI_STS_BUCKET_UNINDEXED  32
+#define SMI_STS_BUCKET_COUNT      (SMI_STS_BUCKET_UNINDEXED + 1)
+
 ///
 /// Create private data for the protocols that we'll publish
 ///
@@ -601,11 +615,14 @@ typedef struct {
   EFI_HANDLE                  SmiHandle;
   EFI_HANDLE                  InstallMultProtHandle;
   PCH_SMM_QUALIFIED_PROTOCOL  Protocols[PCH_SMM_PROTOCOL_TYPE_MAX];
+  LIST_ENTRY                  SmiStsDataBase[SMI_STS_BUCKET_COUNT];
+  UINT32                      SmiStsBucketMask;   ///< Bit N set when SmiStsDataBase[N] is not empty
 } PRIVATE_DATA;
 
 extern PRIVATE_DATA           mPrivateData;
 extern UINT16                 mAcpiBaseAddr;
 extern UINT16                 mTcoBaseAddr;
+extern BOOLEAN                mS3SusStart;
 
 /**
   The internal function used to create and insert a database record
@@ -623,6 +640,32 @@ SmmCoreInsertRecord (
   OUT EFI_HANDLE                        *DispatchHandle
   );
 
+/**
+  The internal function used to take a database record out of the database.
+  The caller is responsible for freeing the record.
+
+  @param[in]  Record                    Record to remove from the database.
+**/
+VOID
+SmmCoreRemoveRecord (
+  IN  DATABASE_RECORD                   *Record
+  );
+
+/**
+  Dispatch the active sources of the SMI_STS bits that are set, then the
+  sources that cannot be tied to an SMI_STS bit.
+
+  @param[in]      SciEn                 Sci Enable status
+  @param[out]     SmiStsValue           Value read from R_ACPI_IO_SMI_STS
+  @param[in, out] SxChildWasDispatched  Set to TRUE when an Sx source was found
+**/
+VOID
+PchSmmDispatchPendingSources (
+  IN     BOOLEAN              SciEn,
+  OUT    UINT32               *SmiStsValue,
+  IN OUT BOOLEAN              *SxChildWasDispatched
+  );
+
 /**
   Get the Sleep type
 
@@ -13,7 +13,6 @@
 #include <Register/PmcRegs.h>
 #include <Register/RtcRegs.h>
 
-#define PROGRESS_CODE_S3_SUSPEND_START  PcdGet32 (PcdProgressCodeS3SuspendStart)
 //
 // MODULE / GLOBAL DATA
 //
@@ -219,6 +218,7 @@ InitializePchSmmDispatcher (
 {
   EFI_STATUS           Status;
   VOID                 *SmmReadyToLockRegistration;
+  UINTN                BucketIndex;
 
   mS3SusStart = FALSE;
   //
@@ -244,6 +244,10 @@ InitializePchSmmDispatcher (
   // Initialize Callback DataBase
   //
   InitializeListHead (&mPrivateData.CallbackDataBase);
+  for (BucketIndex = 0; BucketIndex < SMI_STS_BUCKET_COUNT; BucketIndex++) {
+    InitializeListHead (&mPrivateData.SmiStsDataBase[BucketIndex]);
+  }
+  mPrivateData.SmiStsBucketMask = 0;
 
   //
   // Enable SMIs on the PCH now that we have a callback
@@ -273,52 +277,6 @@ InitializePchSmmDispatcher (
   return EFI_SUCCESS;
 }
 
-/**
-  The internal function used to create and insert a database record
-
-  @param[in]  InsertRecord              Record to insert to database.
-  @param[out] DispatchHandle            Handle of dispatch function to register.
-
-  @retval EFI_INVALID_PARAMETER         Error with NULL SMI source description
-  @retval EFI_OUT_OF_RESOURCES          Fail to allocate pool for database record
-  @retval EFI_SUCCESS                   The database record is created successfully.
-**/
-EFI_STATUS
-SmmCoreInsertRecord (
-  IN  DATABASE_RECORD                   *NewRecord,
-  OUT EFI_HANDLE                        *DispatchHandle
-  )
-{
-  EFI_STATUS                            Status;
-  DATABASE_RECORD                       *Record;
-
-  if ((NewRecord == NULL) ||
-      (NewRecord->Signature != DATABASE_RECORD_SIGNATURE))
-  {
-    ASSERT (FALSE);
-    return EFI_INVALID_PARAMETER;
-  }
-
-  Status = gSmst->SmmAllocatePool (EfiRuntimeServicesData, sizeof (DATABASE_RECORD), (VOID **) &Record);
-  if (EFI_ERROR (Status)) {
-    ASSERT (FALSE);
-    return EFI_OUT_OF_RESOURCES;
-  }
-  CopyMem (Record, NewRecord, sizeof (DATABASE_RECORD));
-
-  //
-  // After ensuring the source of event is not null, we will insert the record into the database
-  //
-  InsertTailList (&mPrivateData.CallbackDataBase, &Record->Link);
-
-  //
-  // Child's handle will be the address linked list link in the record
-  //
-  *DispatchHandle = (EFI_HANDLE) (&Record->Link);
-
-  return EFI_SUCCESS;
-}
-
 /**
   Unregister a child SMI source dispatch function with a parent SMM driver
 
@@ -582,7 +540,7 @@ PchSmmCoreUnRegister (
     return EFI_INVALID_PARAMETER;
   }
 
-  RemoveEntryList (&RecordToDelete->Link);
+  SmmCoreRemoveRecord (RecordToDelete);
 
   //
   // Loop through all the souces in record linked list to see if any source enable is equal.
@@ -662,6 +620,8 @@ ClearPendingSmiStatus (
 /**
   The callback function to handle subsequent SMIs.  This callback will be called by SmmCoreDispatcher.
 
+  Children are grouped by SMI_STS bit at registration, see PchSmmCoreDatabase.c.
+
   @param[in] SmmImageHandle             Not used
   @param[in] PchSmmCore                 Not used
   @param[in, out] CommunicationBuffer   Not used
@@ -683,35 +643,16 @@ PchSmmCoreDispatcher (
   //
   UINTN               EscapeCount;
 
-  BOOLEAN             ContextsMatch;
   BOOLEAN             EosSet;
   BOOLEAN             SxChildWasDispatched;
 
-  DATABASE_RECORD     *RecordInDb;
-  LIST_ENTRY          *LinkInDb;
-  DATABASE_RECORD     *RecordToExhaust;
-  LIST_ENTRY          *LinkToExhaust;
-
-  PCH_SMM_CONTEXT     Context;
-  VOID                *CommBuffer;
-  UINTN               CommBufferSize;
-
   EFI_STATUS          Status;
   BOOLEAN             SciEn;
-  UINT32              SmiEnValue;
   UINT32              SmiStsValue;
   UINT8               Port74Save;
   UINT8               Port76Save;
 
-  PCH_SMM_SOURCE_DESC ActiveSource;
-
-  //
-  // Initialize ActiveSource
-  //
-  NullInitSourceDesc (&ActiveSource);
-
   EscapeCount           = 3;
-  ContextsMatch         = FALSE;
   EosSet                = FALSE;
   SxChildWasDispatched  = FALSE;
   Status                = EFI_SUCCESS;
@@ -732,160 +673,20 @@ PchSmmCoreDispatcher (
     while ((!EosSet) && (EscapeCount > 0)) {
       EscapeCount--;
 
-      LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+      //
+      // Dispatch the active sources of the pending SMI_STS bits
+      //
+      SciEn = PchSmmGetSciEn ();
+      PchSmmDispatchPendingSources (SciEn, &SmiStsValue, &SxChildWasDispatched);
 
       //
-      // Cache SciEn, SmiEnValue and SmiStsValue to determine if source is active
+      // Clear pending SMI status before EOS
       //
-      SciEn       = PchSmmGetSciEn ();
-      SmiEnValue  = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_EN));
-      SmiStsValue = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS));
-
-      while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
-        RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
-
-        //
-        // look for the first active source
-        //
-        if (!SourceIsActive (&RecordInDb->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
-          //
-          // Didn't find the source yet, keep looking
-          //
-          LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, &RecordInDb->Link);
-
-          //
-          // if it's the last one, try to clear EOS
-          //
-          if (IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
-            //
-            // Clear pending SMI status before EOS
-            //
-            ClearPendingSmiStatus (SmiStsValue, SciEn);
-            EosSet = PchSmmSetAndCheckEos ();
-          }
-        } else {
-          //
-          // We found a source. If this is a sleep type, we have to go to
-          // appropriate sleep state anyway.No matter there is sleep child or not
-          //
-          if (RecordInDb->ProtocolType == SxType) {
-            SxChildWasDispatched = TRUE;
-          }
-          //
-          // "cache" the source description and don't query I/O anymore
-          //
-          CopyMem ((VOID *) &ActiveSource, (VOID *) &(RecordInDb->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
-          LinkToExhaust = LinkInDb;
-
-          //
-          // exhaust the rest of the queue looking for the same source
-          //
-          while (!IsNull (&mPrivateData.CallbackDataBase, LinkToExhaust)) {
-            RecordToExhaust = DATABASE_RECORD_FROM_LINK (LinkToExhaust);
-            //
-            // RecordToExhaust->Link might be removed (unregistered) by Callback function, and then the
-            // system will hang in ASSERT() while calling GetNextNode().
-            // To prevent the issue, we need to get next record in DB here (before Callback function).
-            //
-            LinkToExhaust = GetNextNode (&mPrivateData.CallbackDataBase, &RecordToExhaust->Link);
-
-            if (CompareSources (&RecordToExhaust->SrcDesc, &ActiveSource)) {
-              //
-              // These source descriptions are equal, so this callback should be
-              // dispatched.
-              //
-              if (RecordToExhaust->ContextFunctions.GetContext != NULL) {
-                //
-                // This child requires that we get a calling context from
-                // hardware and compare that context to the one supplied
-                // by the child.
-                //
-                ASSERT (RecordToExhaust->ContextFunctions.CmpContext != NULL);
-
-                //
-                // Make sure contexts match before dispatching event to child
-                //
-                RecordToExhaust->ContextFunctions.GetContext (RecordToExhaust, &Context);
-                ContextsMatch = RecordToExhaust->ContextFunctions.CmpContext (&Context, &RecordToExhaust->ChildContext);
-
-              } else {
-                //
-                // This child doesn't require any more calling context beyond what
-                // it supplied in registration.  Simply pass back what it gave us.
-                //
-                Context       = RecordToExhaust->ChildContext;
-                ContextsMatch = TRUE;
-              }
-
-              if (ContextsMatch) {
-                if (RecordToExhaust->ProtocolType == PchSmiDispatchType) {
-                  //
-                  // For PCH SMI dispatch protocols
-                  //
-                  PchSmiTypeCallbackDispatcher (RecordToExhaust);
-                } else {
-                  if ((RecordToExhaust->ProtocolType == SxType) && (Context.Sx.Type == SxS3) && (Context.Sx.Phase == SxEntry) && !mS3SusStart) {
-                    REPORT_STATUS_CODE (EFI_PROGRESS_CODE, PROGRESS_CODE_S3_SUSPEND_START);
-                    mS3SusStart = TRUE;
-                  }
-                  //
-                  // For EFI standard SMI dispatch protocols
-                  //
-                  if (RecordToExhaust->Callback != NULL) {
-                    if (RecordToExhaust->ContextFunctions.GetCommBuffer != NULL) {
-                      //
-                      // This callback function needs CommBuffer and CommBufferSize.
-                      // Get those from child and then pass to callback function.
-                      //
-                      RecordToExhaust->ContextFunctions.GetCommBuffer (RecordToExhaust, &CommBuffer, &CommBufferSize);
-                    } else {
-                      //
-                      // Child doesn't support the CommBuffer and CommBufferSize.
-                      // Just pass NULL value to callback function.
-                      //
-                      CommBuffer     = NULL;
-                      CommBufferSize = 0;
-                    }
-
-                    PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
-                    PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    if (RecordToExhaust->ProtocolType == SxType) {
-                      SxChildWasDispatched = TRUE;
-                    }
-                  } else {
-                    ASSERT (FALSE);
-                  }
-                }
-              }
-            }
-          }
-
-          if (RecordInDb->ClearSource == NULL) {
-            //
-            // Clear the SMI associated w/ the source using the default function
-            //
-            PchSmmClearSource (&ActiveSource);
-          } else {
-            //
-            // This source requires special handling to clear
-            //
-            RecordInDb->ClearSource (&ActiveSource);
-          }
-          //
-          // Clear pending SMI status before EOS
-          //
-          ClearPendingSmiStatus (SmiStsValue, SciEn);
-          //
-          // Also, try to clear EOS
-          //
-          EosSet = PchSmmSetAndCheckEos ();
-          //
-          // Queue is empty, reset the search
-          //
-          break;
-        }
-      }
+      ClearPendingSmiStatus (SmiStsValue, SciEn);
+      //
+      // Also, try to clear EOS
+      //
+      EosSet = PchSmmSetAndCheckEos ();
     }
   }
   //
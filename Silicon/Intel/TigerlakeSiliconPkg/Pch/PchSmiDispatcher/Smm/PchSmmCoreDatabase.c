@@ -0,0 +1,353 @@
+/** @file
+  The child record database of the PCH SMM dispatcher, and the SMI_STS
+  dispatch buckets built on it.
+
+  Records are grouped by SMI_STS bit at registration, so each SMI pass reads
+  SMI_STS once and only searches the buckets of the set bits. Registers are
+  only read through IoLib and the bit description helpers, so this file is
+  also built into the host unit test in UnitTest/.
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  Copyright (c) 2026, agent <agent@local>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include "PchSmm.h"
+#include "PchSmmHelpers.h"
+#include <Register/PmcRegs.h>
+
+#define PROGRESS_CODE_S3_SUSPEND_START  PcdGet32 (PcdProgressCodeS3SuspendStart)
+
+/**
+  Get the SMI_STS dispatch bucket of an SMI source.
+
+  A source is only active when its top level status bit in SMI_STS is set,
+  so it is grouped under that bit. Sources without a PMC SMI_STS bit fall back
+  to their own status bit when it lives in SMI_STS.
+
+  @param[in] SrcDesc                    Pointer to the PCH SMI source description table
+
+  @retval SMI_STS bit number, or SMI_STS_BUCKET_UNINDEXED
+**/
+STATIC
+UINTN
+GetSmiStsBucket (
+  CONST PCH_SMM_SOURCE_DESC             *SrcDesc
+  )
+{
+  if ((SrcDesc->PmcSmiSts.Reg.Type == ACPI_ADDR_TYPE) &&
+      (SrcDesc->PmcSmiSts.Reg.Data.acpi == R_ACPI_IO_SMI_STS) &&
+      (SrcDesc->PmcSmiSts.Bit < SMI_STS_BUCKET_UNINDEXED)) {
+    return SrcDesc->PmcSmiSts.Bit;
+  }
+  if (IS_BIT_DESC_NULL (SrcDesc->PmcSmiSts) &&
+      (SrcDesc->Sts[0].Reg.Type == ACPI_ADDR_TYPE) &&
+      (SrcDesc->Sts[0].Reg.Data.acpi == R_ACPI_IO_SMI_STS) &&
+      (SrcDesc->Sts[0].Bit < SMI_STS_BUCKET_UNINDEXED)) {
+    return SrcDesc->Sts[0].Bit;
+  }
+  return SMI_STS_BUCKET_UNINDEXED;
+}
+
+/**
+  The internal function used to create and insert a database record
+
+  @param[in]  InsertRecord              Record to insert to database.
+  @param[out] DispatchHandle            Handle of dispatch function to register.
+
+  @retval EFI_INVALID_PARAMETER         Error with NULL SMI source description
+  @retval EFI_OUT_OF_RESOURCES          Fail to allocate pool for database record
+  @retval EFI_SUCCESS                   The database record is created successfully.
+**/
+EFI_STATUS
+SmmCoreInsertRecord (
+  IN  DATABASE_RECORD                   *NewRecord,
+  OUT EFI_HANDLE                        *DispatchHandle
+  )
+{
+  EFI_STATUS                            Status;
+  DATABASE_RECORD                       *Record;
+  UINTN                                 Bucket;
+
+  if ((NewRecord == NULL) ||
+      (NewRecord->Signature != DATABASE_RECORD_SIGNATURE))
+  {
+    ASSERT (FALSE);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = gSmst->SmmAllocatePool (EfiRuntimeServicesData, sizeof (DATABASE_RECORD), (VOID **) &Record);
+  if (EFI_ERROR (Status)) {
+    ASSERT (FALSE);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  CopyMem (Record, NewRecord, sizeof (DATABASE_RECORD));
+
+  //
+  // After ensuring the source of event is not null, we will insert the record into the database
+  //
+  InsertTailList (&mPrivateData.CallbackDataBase, &Record->Link);
+
+  //
+  // Group the record by SMI_STS bit for the dispatcher
+  //
+  Bucket = GetSmiStsBucket (&Record->SrcDesc);
+  InsertTailList (&mPrivateData.SmiStsDataBase[Bucket], &Record->SmiStsLink);
+  if (Bucket < SMI_STS_BUCKET_UNINDEXED) {
+    mPrivateData.SmiStsBucketMask |= (UINT32) (1u << Bucket);
+  }
+
+  //
+  // Child's handle will be the address linked list link in the record
+  //
+  *DispatchHandle = (EFI_HANDLE) (&Record->Link);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  The internal function used to take a database record out of the database.
+  The caller is responsible for freeing the record.
+
+  @param[in]  Record                    Record to remove from the database.
+**/
+VOID
+SmmCoreRemoveRecord (
+  IN  DATABASE_RECORD                   *Record
+  )
+{
+  UINTN                                 Bucket;
+
+  RemoveEntryList (&Record->Link);
+  RemoveEntryList (&Record->SmiStsLink);
+
+  Bucket = GetSmiStsBucket (&Record->SrcDesc);
+  if ((Bucket < SMI_STS_BUCKET_UNINDEXED) && IsListEmpty (&mPrivateData.SmiStsDataBase[Bucket])) {
+    mPrivateData.SmiStsBucketMask &= (UINT32) ~(1u << Bucket);
+  }
+}
+
+/**
+  Dispatch one child record whose source matched the active SMI source.
+
+  @param[in]      Record                Record to dispatch
+  @param[in, out] SxChildWasDispatched  Set to TRUE when an Sx child was called
+**/
+STATIC
+VOID
+PchSmmDispatchRecord (
+  IN     DATABASE_RECORD      *Record,
+  IN OUT BOOLEAN              *SxChildWasDispatched
+  )
+{
+  BOOLEAN                ContextsMatch;
+  PCH_SMM_CONTEXT        Context;
+  VOID                   *CommBuffer;
+  UINTN                  CommBufferSize;
+  PCH_SMM_PROTOCOL_TYPE  ProtocolType;
+
+  if (Record->ContextFunctions.GetContext != NULL) {
+    //
+    // This child requires that we get a calling context from
+    // hardware and compare that context to the one supplied
+    // by the child.
+    //
+    ASSERT (Record->ContextFunctions.CmpContext != NULL);
+
+    //
+    // Make sure contexts match before dispatching event to child
+    //
+    Record->ContextFunctions.GetContext (Record, &Context);
+    ContextsMatch = Record->ContextFunctions.CmpContext (&Context, &Record->ChildContext);
+
+  } else {
+    //
+    // This child doesn't require any more calling context beyond what
+    // it supplied in registration.  Simply pass back what it gave us.
+    //
+    Context       = Record->ChildContext;
+    ContextsMatch = TRUE;
+  }
+
+  if (!ContextsMatch) {
+    return;
+  }
+
+  if (Record->ProtocolType == PchSmiDispatchType) {
+    //
+    // For PCH SMI dispatch protocols
+    //
+    PchSmiTypeCallbackDispatcher (Record);
+    return;
+  }
+
+  if ((Record->ProtocolType == SxType) && (Context.Sx.Type == SxS3) && (Context.Sx.Phase == SxEntry) && !mS3SusStart) {
+    REPORT_STATUS_CODE (EFI_PROGRESS_CODE, PROGRESS_CODE_S3_SUSPEND_START);
+    mS3SusStart = TRUE;
+  }
+  //
+  // For EFI standard SMI dispatch protocols
+  //
+  if (Record->Callback != NULL) {
+    if (Record->ContextFunctions.GetCommBuffer != NULL) {
+      //
+      // This callback function needs CommBuffer and CommBufferSize.
+      // Get those from child and then pass to callback function.
+      //
+      Record->ContextFunctions.GetCommBuffer (Record, &CommBuffer, &CommBufferSize);
+    } else {
+      //
+      // Child doesn't support the CommBuffer and CommBufferSize.
+      // Just pass NULL value to callback function.
+      //
+      CommBuffer     = NULL;
+      CommBufferSize = 0;
+    }
+
+    //
+    // The callback may unregister its own child, don't touch Record after it.
+    //
+    ProtocolType = Record->ProtocolType;
+    PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), ProtocolType);
+    Record->Callback ((EFI_HANDLE) & Record->Link, &Context, CommBuffer, &CommBufferSize);
+    PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), ProtocolType);
+    if (ProtocolType == SxType) {
+      *SxChildWasDispatched = TRUE;
+    }
+  } else {
+    ASSERT (FALSE);
+  }
+}
+
+/**
+  Dispatch the first active SMI source of one SMI_STS bucket, together with
+  every other child in the bucket registered for that same source.
+
+  @param[in]      Bucket                Index into mPrivateData.SmiStsDataBase
+  @param[in]      SciEn                 Sci Enable status
+  @param[in]      SmiEnValue            Value from R_ACPI_IO_SMI_EN
+  @param[in]      SmiStsValue           Value from R_ACPI_IO_SMI_STS
+  @param[in, out] SxChildWasDispatched  Set to TRUE when an Sx source was found
+**/
+STATIC
+VOID
+PchSmmDispatchBucket (
+  IN     UINTN                Bucket,
+  IN     BOOLEAN              SciEn,
+  IN     UINT32               SmiEnValue,
+  IN     UINT32               SmiStsValue,
+  IN OUT BOOLEAN              *SxChildWasDispatched
+  )
+{
+  LIST_ENTRY            *BucketHead;
+  LIST_ENTRY            *LinkInDb;
+  LIST_ENTRY            *LinkToExhaust;
+  DATABASE_RECORD       *RecordInDb;
+  DATABASE_RECORD       *RecordToExhaust;
+  PCH_SMM_CLEAR_SOURCE  ClearSource;
+  PCH_SMM_SOURCE_DESC   ActiveSource;
+
+  BucketHead = &mPrivateData.SmiStsDataBase[Bucket];
+
+  //
+  // look for the first active source
+  //
+  for (LinkInDb = GetFirstNode (BucketHead); !IsNull (BucketHead, LinkInDb); LinkInDb = GetNextNode (BucketHead, LinkInDb)) {
+    RecordInDb = DATABASE_RECORD_FROM_SMI_STS_LINK (LinkInDb);
+    if (SourceIsActive (&RecordInDb->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
+      break;
+    }
+  }
+  if (IsNull (BucketHead, LinkInDb)) {
+    return;
+  }
+
+  //
+  // We found a source. If this is a sleep type, we have to go to
+  // appropriate sleep state anyway.No matter there is sleep child or not
+  //
+  if (RecordInDb->ProtocolType == SxType) {
+    *SxChildWasDispatched = TRUE;
+  }
+  //
+  // "cache" the source description and don't query I/O anymore.
+  // The record may be unregistered by its own callback, so keep its
+  // clear function as well.
+  //
+  CopyMem ((VOID *) &ActiveSource, (VOID *) &(RecordInDb->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
+  ClearSource = RecordInDb->ClearSource;
+
+  //
+  // exhaust the rest of the bucket looking for the same source. Children of the
+  // same source always share a bucket.
+  //
+  LinkToExhaust = LinkInDb;
+  while (!IsNull (BucketHead, LinkToExhaust)) {
+    RecordToExhaust = DATABASE_RECORD_FROM_SMI_STS_LINK (LinkToExhaust);
+    //
+    // RecordToExhaust might be removed (unregistered) by Callback function, and then the
+    // system will hang in ASSERT() while calling GetNextNode().
+    // To prevent the issue, we need to get next record in DB here (before Callback function).
+    //
+    LinkToExhaust = GetNextNode (BucketHead, &RecordToExhaust->SmiStsLink);
+
+    if (CompareSources (&RecordToExhaust->SrcDesc, &ActiveSource)) {
+      //
+      // These source descriptions are equal, so this callback should be
+      // dispatched.
+      //
+      PchSmmDispatchRecord (RecordToExhaust, SxChildWasDispatched);
+    }
+  }
+
+  if (ClearSource == NULL) {
+    //
+    // Clear the SMI associated w/ the source using the default function
+    //
+    PchSmmClearSource (&ActiveSource);
+  } else {
+    //
+    // This source requires special handling to clear
+    //
+    ClearSource (&ActiveSource);
+  }
+}
+
+/**
+  Dispatch the active sources of the SMI_STS bits that are set, then the
+  sources that cannot be tied to an SMI_STS bit. Each bucket gets its first
+  active source dispatched.
+
+  @param[in]      SciEn                 Sci Enable status
+  @param[out]     SmiStsValue           Value read from R_ACPI_IO_SMI_STS
+  @param[in, out] SxChildWasDispatched  Set to TRUE when an Sx source was found
+**/
+VOID
+PchSmmDispatchPendingSources (
+  IN     BOOLEAN              SciEn,
+  OUT    UINT32               *SmiStsValue,
+  IN OUT BOOLEAN              *SxChildWasDispatched
+  )
+{
+  UINT32              SmiEnValue;
+  UINT32              PendingMask;
+  UINTN               Bucket;
+
+  //
+  // Cache SmiEnValue and SmiStsValue to determine if source is active
+  //
+  SmiEnValue   = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_EN));
+  *SmiStsValue = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS));
+
+  //
+  // Only the buckets of set SMI_STS bits can hold an active source
+  //
+  PendingMask = *SmiStsValue & mPrivateData.SmiStsBucketMask;
+  while (PendingMask != 0) {
+    Bucket       = (UINTN) LowBitSet32 (PendingMask);
+    PendingMask &= PendingMask - 1;
+    PchSmmDispatchBucket (Bucket, SciEn, SmiEnValue, *SmiStsValue, SxChildWasDispatched);
+  }
+  if (!IsListEmpty (&mPrivateData.SmiStsDataBase[SMI_STS_BUCKET_UNINDEXED])) {
+    PchSmmDispatchBucket (SMI_STS_BUCKET_UNINDEXED, SciEn, SmiEnValue, *SmiStsValue, SxChildWasDispatched);
+  }
+}
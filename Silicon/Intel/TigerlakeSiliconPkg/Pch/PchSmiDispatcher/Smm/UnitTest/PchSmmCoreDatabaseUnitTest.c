@@ -0,0 +1,703 @@
+/** @file
+  Host-based unit tests of the PCH SMM dispatcher child database and of the
+  SMI_STS dispatch buckets, see PchSmmCoreDatabase.c.
+
+  ACPI I/O space is modelled by an IoLib mock. Status registers are write 1
+  to clear, like the hardware.
+
+  Copyright (c) 2026, agent <agent@local>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <Uefi.h>
+#include <Library/UnitTestLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include "../PchSmm.h"
+#include "../PchSmmHelpers.h"
+#include <Register/PmcRegs.h>
+
+#define UNIT_TEST_APP_NAME     "PCH SMM Dispatcher Database Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define MOCK_ACPI_BASE_ADDRESS  0x1800
+#define MOCK_ACPI_IO_SIZE       0x100
+#define MOCK_CHILD_COUNT        4
+
+//
+// Globals of PchSmmCore.c used by the code under test
+//
+PRIVATE_DATA                  mPrivateData;
+UINT16                        mAcpiBaseAddr;
+BOOLEAN                       mS3SusStart;
+
+STATIC UINT8                  mMockAcpiIo[MOCK_ACPI_IO_SIZE];
+STATIC EFI_SMM_SYSTEM_TABLE2  mMockSmst;
+EFI_SMM_SYSTEM_TABLE2         *gSmst = &mMockSmst;
+
+///
+/// Number of calls of each child, indexed by its SwSmiInputValue
+///
+STATIC UINTN                  mChildCalls[MOCK_CHILD_COUNT];
+///
+/// Children that unregister themselves from their callback, by SwSmiInputValue
+///
+STATIC BOOLEAN                mChildUnregisters[MOCK_CHILD_COUNT];
+
+///
+/// APM: top level status in SMI_STS, no PMC SMI_STS description
+///
+STATIC CONST PCH_SMM_SOURCE_DESC  mApmSourceDesc = {
+  PCH_SMM_NO_FLAGS,
+  {
+    {{ACPI_ADDR_TYPE, {R_ACPI_IO_SMI_EN}}, 4, N_ACPI_IO_SMI_EN_APMC},
+    NULL_BIT_DESC_INITIALIZER
+  },
+  {
+    {{ACPI_ADDR_TYPE, {R_ACPI_IO_SMI_STS}}, 4, N_ACPI_IO_SMI_STS_APM}
+  },
+  NULL_BIT_DESC_INITIALIZER
+};
+
+///
+/// Power button: status in PM1_STS, reported by SMI_STS.PM1_STS_REG
+///
+STATIC CONST PCH_SMM_SOURCE_DESC  mPowerButtonMockSourceDesc = {
+  PCH_SMM_NO_FLAGS,
+  {
+    {{ACPI_ADDR_TYPE, {R_ACPI_IO_PM1_EN}}, 2, N_ACPI_IO_PM1_EN_PWRBTN},
+    NULL_BIT_DESC_INITIALIZER
+  },
+  {
+    {{ACPI_ADDR_TYPE, {R_ACPI_IO_PM1_STS}}, 2, N_ACPI_IO_PM1_STS_PWRBTN}
+  },
+  {{ACPI_ADDR_TYPE, {R_ACPI_IO_SMI_STS}}, 4, N_ACPI_IO_SMI_STS_PM1_STS_REG}
+};
+
+///
+/// PME_B0: status in GPE0, not tied to any SMI_STS bit
+///
+STATIC CONST PCH_SMM_SOURCE_DESC  mPmeB0SourceDesc = {
+  PCH_SMM_NO_FLAGS,
+  {
+    {{ACPI_ADDR_TYPE, {R_ACPI_IO_GPE0_EN_127_96}}, 4, N_ACPI_IO_GPE0_EN_127_96_PME_B0},
+    NULL_BIT_DESC_INITIALIZER
+  },
+  {
+    {{ACPI_ADDR_TYPE, {R_ACPI_IO_GPE0_STS_127_96}}, 4, N_ACPI_IO_GPE0_STS_127_96_PME_B0}
+  },
+  NULL_BIT_DESC_INITIALIZER
+};
+
+/**
+  Check whether an ACPI register offset is a write 1 to clear status register.
+
+  @param[in] Offset  Offset in ACPI I/O space.
+
+  @retval TRUE   The register is a status register.
+  @retval FALSE  The register is read/write.
+**/
+STATIC
+BOOLEAN
+MockIsStatusRegister (
+  IN UINTN  Offset
+  )
+{
+  return (BOOLEAN) ((Offset == R_ACPI_IO_PM1_STS) ||
+                    (Offset == R_ACPI_IO_SMI_STS) ||
+                    (Offset == R_ACPI_IO_GPE0_STS_127_96));
+}
+
+/**
+  Read the mock ACPI I/O space.
+
+  @param[in] Port   I/O port.
+  @param[in] Size   Access size in bytes.
+
+  @return The register value.
+**/
+STATIC
+UINT32
+MockIoRead (
+  IN UINTN  Port,
+  IN UINTN  Size
+  )
+{
+  UINT32  Value;
+
+  ASSERT ((Port >= MOCK_ACPI_BASE_ADDRESS) && (Port + Size <= MOCK_ACPI_BASE_ADDRESS + MOCK_ACPI_IO_SIZE));
+  Value = 0;
+  CopyMem (&Value, &mMockAcpiIo[Port - MOCK_ACPI_BASE_ADDRESS], Size);
+  return Value;
+}
+
+/**
+  Write the mock ACPI I/O space. Bits written as 1 to a status register clear it.
+
+  @param[in] Port   I/O port.
+  @param[in] Size   Access size in bytes.
+  @param[in] Value  Value to write.
+**/
+STATIC
+VOID
+MockIoWrite (
+  IN UINTN   Port,
+  IN UINTN   Size,
+  IN UINT32  Value
+  )
+{
+  UINTN   Offset;
+  UINT32  Current;
+
+  ASSERT ((Port >= MOCK_ACPI_BASE_ADDRESS) && (Port + Size <= MOCK_ACPI_BASE_ADDRESS + MOCK_ACPI_IO_SIZE));
+  Offset = Port - MOCK_ACPI_BASE_ADDRESS;
+  if (MockIsStatusRegister (Offset)) {
+    Current = MockIoRead (Port, Size);
+    Value   = Current & ~Value;
+  }
+  CopyMem (&mMockAcpiIo[Offset], &Value, Size);
+}
+
+//
+// IoLib mock, ACPI I/O space only
+//
+UINT8
+EFIAPI
+IoRead8 (
+  IN UINTN  Port
+  )
+{
+  return (UINT8) MockIoRead (Port, 1);
+}
+
+UINT16
+EFIAPI
+IoRead16 (
+  IN UINTN  Port
+  )
+{
+  return (UINT16) MockIoRead (Port, 2);
+}
+
+UINT32
+EFIAPI
+IoRead32 (
+  IN UINTN  Port
+  )
+{
+  return MockIoRead (Port, 4);
+}
+
+UINT8
+EFIAPI
+IoWrite8 (
+  IN UINTN  Port,
+  IN UINT8  Value
+  )
+{
+  MockIoWrite (Port, 1, Value);
+  return Value;
+}
+
+UINT16
+EFIAPI
+IoWrite16 (
+  IN UINTN   Port,
+  IN UINT16  Value
+  )
+{
+  MockIoWrite (Port, 2, Value);
+  return Value;
+}
+
+UINT32
+EFIAPI
+IoWrite32 (
+  IN UINTN   Port,
+  IN UINT32  Value
+  )
+{
+  MockIoWrite (Port, 4, Value);
+  return Value;
+}
+
+/**
+  Stand-in for ReadBitDesc() of PchxSmmHelpers.c, for ACPI registers only.
+
+  @param[in] BitDesc  The bit to read.
+
+  @retval TRUE   The bit is set.
+  @retval FALSE  The bit is clear.
+**/
+BOOLEAN
+ReadBitDesc (
+  CONST PCH_SMM_BIT_DESC  *BitDesc
+  )
+{
+  ASSERT (BitDesc->Reg.Type == ACPI_ADDR_TYPE);
+  return (BOOLEAN) ((MockIoRead (mAcpiBaseAddr + BitDesc->Reg.Data.acpi, BitDesc->SizeInBytes) & (1u << BitDesc->Bit)) != 0);
+}
+
+/**
+  Stand-in for WriteBitDesc() of PchxSmmHelpers.c, for ACPI registers only.
+
+  @param[in] BitDesc       The bit to write.
+  @param[in] ValueToWrite  The value of the bit.
+  @param[in] WriteClear    TRUE if the other bits of the register are write 1 to clear.
+**/
+VOID
+WriteBitDesc (
+  CONST PCH_SMM_BIT_DESC  *BitDesc,
+  CONST BOOLEAN           ValueToWrite,
+  CONST BOOLEAN           WriteClear
+  )
+{
+  UINTN   Port;
+  UINT32  Value;
+
+  ASSERT (BitDesc->Reg.Type == ACPI_ADDR_TYPE);
+  Port = mAcpiBaseAddr + BitDesc->Reg.Data.acpi;
+  if (WriteClear) {
+    Value = 0;
+  } else {
+    Value = MockIoRead (Port, BitDesc->SizeInBytes);
+  }
+  if (ValueToWrite) {
+    Value |= (1u << BitDesc->Bit);
+  } else {
+    Value &= ~(1u << BitDesc->Bit);
+  }
+  MockIoWrite (Port, BitDesc->SizeInBytes, Value);
+}
+
+/**
+  PCH SMI type children are not registered by these tests.
+
+  @param[in] Record  The child record.
+
+  @retval EFI_UNSUPPORTED  Always.
+**/
+EFI_STATUS
+PchSmiTypeCallbackDispatcher (
+  IN  DATABASE_RECORD  *Record
+  )
+{
+  ASSERT (FALSE);
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+MockSmmAllocatePool (
+  IN  EFI_MEMORY_TYPE  PoolType,
+  IN  UINTN            Size,
+  OUT VOID             **Buffer
+  )
+{
+  *Buffer = AllocatePool (Size);
+  return (*Buffer == NULL) ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+MockSmmFreePool (
+  IN VOID  *Buffer
+  )
+{
+  FreePool (Buffer);
+  return EFI_SUCCESS;
+}
+
+/**
+  Child callback: count the call, and unregister the child if asked to.
+
+  @param[in]     DispatchHandle  The handle of the child.
+  @param[in]     Context         The child context, its SwSmiInputValue is the child number.
+  @param[in,out] CommBuffer      Not used.
+  @param[in,out] CommBufferSize  Not used.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+MockChildCallback (
+  IN     EFI_HANDLE  DispatchHandle,
+  IN     CONST VOID  *Context,
+  IN OUT VOID        *CommBuffer,
+  IN OUT UINTN       *CommBufferSize
+  )
+{
+  UINTN            Child;
+  DATABASE_RECORD  *Record;
+
+  Child = ((CONST PCH_SMM_CONTEXT *) Context)->Sw.SwSmiInputValue;
+  ASSERT (Child < MOCK_CHILD_COUNT);
+  mChildCalls[Child]++;
+
+  if (mChildUnregisters[Child]) {
+    Record = DATABASE_RECORD_FROM_LINK (DispatchHandle);
+    SmmCoreRemoveRecord (Record);
+    FreePool (Record);
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Register a child for an SMI source.
+
+  @param[in]  SrcDesc         The SMI source.
+  @param[in]  Child           The child number, below MOCK_CHILD_COUNT.
+  @param[out] DispatchHandle  The handle of the child.
+
+  @return Status of SmmCoreInsertRecord().
+**/
+STATIC
+EFI_STATUS
+MockRegisterChild (
+  IN  CONST PCH_SMM_SOURCE_DESC  *SrcDesc,
+  IN  UINTN                      Child,
+  OUT EFI_HANDLE                 *DispatchHandle
+  )
+{
+  DATABASE_RECORD  Record;
+
+  ZeroMem (&Record, sizeof (Record));
+  Record.Signature                       = DATABASE_RECORD_SIGNATURE;
+  Record.ProtocolType                    = SwType;
+  Record.Callback                        = MockChildCallback;
+  Record.ChildContext.Sw.SwSmiInputValue = Child;
+  CopyMem (&Record.SrcDesc, SrcDesc, sizeof (Record.SrcDesc));
+  return SmmCoreInsertRecord (&Record, DispatchHandle);
+}
+
+/**
+  Unregister a child.
+
+  @param[in] DispatchHandle  The handle returned by MockRegisterChild().
+**/
+STATIC
+VOID
+MockUnregisterChild (
+  IN EFI_HANDLE  DispatchHandle
+  )
+{
+  DATABASE_RECORD  *Record;
+
+  Record = DATABASE_RECORD_FROM_LINK (DispatchHandle);
+  SmmCoreRemoveRecord (Record);
+  FreePool (Record);
+}
+
+/**
+  Set a bit in the mock ACPI I/O space, as the hardware would.
+
+  @param[in] BitDesc  The bit to set.
+**/
+STATIC
+VOID
+MockSetBit (
+  IN CONST PCH_SMM_BIT_DESC  *BitDesc
+  )
+{
+  UINTN  Offset;
+
+  Offset = BitDesc->Reg.Data.acpi + BitDesc->Bit / 8;
+  mMockAcpiIo[Offset] |= (UINT8) (1u << (BitDesc->Bit % 8));
+}
+
+/**
+  Make an SMI source pending: its enables and statuses set, and its top level
+  SMI_STS bit if it has one.
+
+  @param[in] SrcDesc  The SMI source.
+**/
+STATIC
+VOID
+MockRaiseSource (
+  IN CONST PCH_SMM_SOURCE_DESC  *SrcDesc
+  )
+{
+  MockSetBit (&SrcDesc->En[0]);
+  MockSetBit (&SrcDesc->Sts[0]);
+  if (!IS_BIT_DESC_NULL (SrcDesc->PmcSmiSts)) {
+    MockSetBit (&SrcDesc->PmcSmiSts);
+  }
+}
+
+/**
+  Start each test with an empty database and idle hardware.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  Always.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ResetDatabase (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Bucket;
+
+  InitializeListHead (&mPrivateData.CallbackDataBase);
+  for (Bucket = 0; Bucket < SMI_STS_BUCKET_COUNT; Bucket++) {
+    InitializeListHead (&mPrivateData.SmiStsDataBase[Bucket]);
+  }
+  mPrivateData.SmiStsBucketMask = 0;
+
+  mAcpiBaseAddr = MOCK_ACPI_BASE_ADDRESS;
+  mS3SusStart   = FALSE;
+  ZeroMem (mMockAcpiIo, sizeof (mMockAcpiIo));
+  ZeroMem (mChildCalls, sizeof (mChildCalls));
+  ZeroMem (mChildUnregisters, sizeof (mChildUnregisters));
+
+  mMockSmst.SmmAllocatePool = MockSmmAllocatePool;
+  mMockSmst.SmmFreePool     = MockSmmFreePool;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Unregister the children a test left behind.
+
+  @param[in] Context  Not used.
+**/
+STATIC
+VOID
+EFIAPI
+FreeDatabase (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  while (!IsListEmpty (&mPrivateData.CallbackDataBase)) {
+    MockUnregisterChild ((EFI_HANDLE) GetFirstNode (&mPrivateData.CallbackDataBase));
+  }
+}
+
+/**
+  Records go to the bucket of their SMI_STS bit, and the bucket mask follows
+  the buckets that are not empty.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestBucketIndex (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_HANDLE  Apm;
+  EFI_HANDLE  PowerButton;
+  EFI_HANDLE  PmeB0;
+
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mApmSourceDesc, 0, &Apm));
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mPowerButtonMockSourceDesc, 1, &PowerButton));
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mPmeB0SourceDesc, 2, &PmeB0));
+
+  UT_ASSERT_EQUAL (mPrivateData.SmiStsBucketMask, BIT5 | BIT8);
+  UT_ASSERT_FALSE (IsListEmpty (&mPrivateData.SmiStsDataBase[SMI_STS_BUCKET_UNINDEXED]));
+
+  MockUnregisterChild (PowerButton);
+  UT_ASSERT_EQUAL (mPrivateData.SmiStsBucketMask, BIT5);
+  MockUnregisterChild (PmeB0);
+  UT_ASSERT_TRUE (IsListEmpty (&mPrivateData.SmiStsDataBase[SMI_STS_BUCKET_UNINDEXED]));
+  MockUnregisterChild (Apm);
+  UT_ASSERT_EQUAL (mPrivateData.SmiStsBucketMask, 0);
+  UT_ASSERT_TRUE (IsListEmpty (&mPrivateData.CallbackDataBase));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  With several SMI_STS bits pending, the source of each bit is dispatched and
+  cleared in the same pass, and sources that are not pending are not called.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestMultiBitPending (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_HANDLE  Handle;
+  UINT32      SmiStsValue;
+  BOOLEAN     SxChildWasDispatched;
+
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mApmSourceDesc, 0, &Handle));
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mPowerButtonMockSourceDesc, 1, &Handle));
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mPmeB0SourceDesc, 2, &Handle));
+
+  MockRaiseSource (&mApmSourceDesc);
+  MockRaiseSource (&mPowerButtonMockSourceDesc);
+
+  SxChildWasDispatched = FALSE;
+  PchSmmDispatchPendingSources (FALSE, &SmiStsValue, &SxChildWasDispatched);
+
+  UT_ASSERT_EQUAL (SmiStsValue, BIT5 | BIT8);
+  UT_ASSERT_EQUAL (mChildCalls[0], 1);
+  UT_ASSERT_EQUAL (mChildCalls[1], 1);
+  UT_ASSERT_EQUAL (mChildCalls[2], 0);
+  UT_ASSERT_FALSE (SxChildWasDispatched);
+
+  //
+  // Each source is cleared through its own status bit
+  //
+  UT_ASSERT_FALSE (ReadBitDesc (&mApmSourceDesc.Sts[0]));
+  UT_ASSERT_FALSE (ReadBitDesc (&mPowerButtonMockSourceDesc.Sts[0]));
+
+  //
+  // A second pass with only the power button pending calls only its child
+  //
+  MockRaiseSource (&mPowerButtonMockSourceDesc);
+  PchSmmDispatchPendingSources (FALSE, &SmiStsValue, &SxChildWasDispatched);
+  UT_ASSERT_EQUAL (mChildCalls[0], 1);
+  UT_ASSERT_EQUAL (mChildCalls[1], 2);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A source without an SMI_STS bit is found through the unindexed bucket, even
+  when SMI_STS reads zero.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestUnindexedBucket (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_HANDLE  Handle;
+  UINT32      SmiStsValue;
+  BOOLEAN     SxChildWasDispatched;
+
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mPmeB0SourceDesc, 2, &Handle));
+  UT_ASSERT_EQUAL (mPrivateData.SmiStsBucketMask, 0);
+
+  SxChildWasDispatched = FALSE;
+  PchSmmDispatchPendingSources (FALSE, &SmiStsValue, &SxChildWasDispatched);
+  UT_ASSERT_EQUAL (mChildCalls[2], 0);
+
+  MockRaiseSource (&mPmeB0SourceDesc);
+  PchSmmDispatchPendingSources (FALSE, &SmiStsValue, &SxChildWasDispatched);
+  UT_ASSERT_EQUAL (SmiStsValue, 0);
+  UT_ASSERT_EQUAL (mChildCalls[2], 1);
+  UT_ASSERT_FALSE (ReadBitDesc (&mPmeB0SourceDesc.Sts[0]));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A child that unregisters itself from its callback does not stop the other
+  children of the same source from being dispatched, and the source is still
+  cleared. When the last child of a bucket goes, its mask bit goes too.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestSelfUnregisteringCallback (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_HANDLE  Handle;
+  UINT32      SmiStsValue;
+  BOOLEAN     SxChildWasDispatched;
+
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mApmSourceDesc, 0, &Handle));
+  UT_ASSERT_NOT_EFI_ERROR (MockRegisterChild (&mApmSourceDesc, 1, &Handle));
+  mChildUnregisters[0] = TRUE;
+
+  MockRaiseSource (&mApmSourceDesc);
+  SxChildWasDispatched = FALSE;
+  PchSmmDispatchPendingSources (FALSE, &SmiStsValue, &SxChildWasDispatched);
+
+  UT_ASSERT_EQUAL (mChildCalls[0], 1);
+  UT_ASSERT_EQUAL (mChildCalls[1], 1);
+  UT_ASSERT_FALSE (ReadBitDesc (&mApmSourceDesc.Sts[0]));
+  UT_ASSERT_EQUAL (mPrivateData.SmiStsBucketMask, BIT5);
+
+  //
+  // Now the last child of the bucket unregisters itself
+  //
+  mChildUnregisters[1] = TRUE;
+  MockRaiseSource (&mApmSourceDesc);
+  PchSmmDispatchPendingSources (FALSE, &SmiStsValue, &SxChildWasDispatched);
+
+  UT_ASSERT_EQUAL (mChildCalls[0], 1);
+  UT_ASSERT_EQUAL (mChildCalls[1], 2);
+  UT_ASSERT_FALSE (ReadBitDesc (&mApmSourceDesc.Sts[0]));
+  UT_ASSERT_EQUAL (mPrivateData.SmiStsBucketMask, 0);
+  UT_ASSERT_TRUE (IsListEmpty (&mPrivateData.CallbackDataBase));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests, and run them.
+
+  @retval EFI_SUCCESS           All test cases were dispatched.
+  @retval EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      DatabaseTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&DatabaseTests, Framework, "SMI_STS Dispatch Bucket Tests", "PchSmiDispatcher.Database", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for the database tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (DatabaseTests, "Records are grouped by SMI_STS bit", "BucketIndex", TestBucketIndex, ResetDatabase, FreeDatabase, NULL);
+  AddTestCase (DatabaseTests, "Every pending SMI_STS bit is dispatched", "MultiBitPending", TestMultiBitPending, ResetDatabase, FreeDatabase, NULL);
+  AddTestCase (DatabaseTests, "Sources without an SMI_STS bit are dispatched", "UnindexedBucket", TestUnindexedBucket, ResetDatabase, FreeDatabase, NULL);
+  AddTestCase (DatabaseTests, "A callback may unregister its own child", "SelfUnregister", TestSelfUnregisteringCallback, ResetDatabase, FreeDatabase, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
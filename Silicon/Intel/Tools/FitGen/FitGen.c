@@ -391,6 +391,13 @@ Returns:
   printf ("  Where:\n");
   printf ("\tInputFile              - Name of the input file.\n");
   printf ("\tFitTablePointerOffset  - FIT table pointer offset from end of file. 0x%x as default.\n", DEFAULT_FIT_TABLE_POINTER_OFFSET);
+  printf ("\nUsage (batch): %s -batch JobFile\n", UTILITY_NAME);
+  printf ("  Where:\n");
+  printf ("\tJobFile                - Text file with one generate or view command line per line, without the\n"
+          "\t                         utility name. Empty lines and lines starting with '#' are skipped.\n"
+          "\t                         Microcode FV files are read once and shared by all jobs.\n");
+  printf ("\nAny generate or view command line may also carry -J <ReportFile> to write the resulting\n"
+          "FIT table layout to ReportFile in JSON format.\n");
   printf ("\nTool return values:\n");
   printf ("\tSTATUS_SUCCESS=%d, STATUS_WARNING=%d, STATUS_ERROR=%d\n", STATUS_SUCCESS, STATUS_WARNING, STATUS_ERROR);
 }
@@ -540,6 +547,118 @@ Returns:
   return STATUS_SUCCESS;
 }
 
+//
+// Input files kept in memory for the whole run in batch mode, so that jobs
+// sharing a microcode FV do not read it again.
+//
+typedef struct {
+  CHAR8   *FileName;
+  UINT8   *FileData;
+  UINT32  FileSize;
+  UINT8   *FileBufferRaw;
+} INPUT_FILE_CACHE_ENTRY;
+
+#define MAX_INPUT_FILE_CACHE_ENTRY  0x20
+
+INPUT_FILE_CACHE_ENTRY  mInputFileCache[MAX_INPUT_FILE_CACHE_ENTRY];
+UINT32                  mInputFileCacheNumber = 0;
+BOOLEAN                 mBatchMode = FALSE;
+
+STATUS
+ReadCachedInputFile (
+  IN CHAR8    *FileName,
+  OUT UINT8   **FileData,
+  OUT UINT32  *FileSize,
+  OUT UINT8   **FileBufferRaw
+  )
+/*++
+
+Routine Description:
+
+  Read an input file that is not modified by the caller. In batch mode the
+  file data is kept for later jobs and must not be freed.
+
+Arguments:
+
+  FileName      - The input file name
+  FileData      - The input file data, the memory is aligned.
+  FileSize      - The input file size
+  FileBufferRaw - The memory to hold input file data. The caller must free the
+                  memory if it is not NULL.
+
+Returns:
+
+  STATUS_SUCCESS - The file found and data read
+  STATUS_ERROR   - The file data is not read
+  STATUS_WARNING - The file is not found
+
+--*/
+{
+  INPUT_FILE_CACHE_ENTRY  *Entry;
+  STATUS                  Status;
+  UINT32                  Index;
+
+  if (!mBatchMode) {
+    return ReadInputFile (FileName, FileData, FileSize, FileBufferRaw);
+  }
+
+  for (Index = 0; Index < mInputFileCacheNumber; Index++) {
+    if (strcmp (mInputFileCache[Index].FileName, FileName) == 0) {
+      *FileData      = mInputFileCache[Index].FileData;
+      *FileSize      = mInputFileCache[Index].FileSize;
+      *FileBufferRaw = NULL;
+      return STATUS_SUCCESS;
+    }
+  }
+
+  Status = ReadInputFile (FileName, FileData, FileSize, FileBufferRaw);
+  if ((Status != STATUS_SUCCESS) || (mInputFileCacheNumber >= MAX_INPUT_FILE_CACHE_ENTRY)) {
+    return Status;
+  }
+
+  Entry = &mInputFileCache[mInputFileCacheNumber];
+  Entry->FileName = strdup (FileName);
+  if (Entry->FileName == NULL) {
+    return Status;
+  }
+  Entry->FileData      = *FileData;
+  Entry->FileSize      = *FileSize;
+  Entry->FileBufferRaw = *FileBufferRaw;
+  mInputFileCacheNumber++;
+
+  *FileBufferRaw = NULL;
+  return STATUS_SUCCESS;
+}
+
+VOID
+FreeInputFileCache (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Free the input files kept in batch mode
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < mInputFileCacheNumber; Index++) {
+    free (mInputFileCache[Index].FileName);
+    free (mInputFileCache[Index].FileBufferRaw);
+  }
+  mInputFileCacheNumber = 0;
+}
+
 UINT8 *
 FindNextFvHeader (
   IN UINT8 *FileBuffer,
@@ -607,101 +726,221 @@ FindNextFvHeader (
   return NULL;
 }
 
-UINT8  *
-FindFileFromFvByGuid (
+//
+// Index of the FFS files found in a buffer, so that repeated GUID lookups do
+// not have to rescan the whole image for FV headers and walk every FV again.
+//
+typedef struct {
+  EFI_GUID  Name;
+  UINT8     *Data;
+  UINT32    DataSize;
+} FFS_INDEX_ENTRY;
+
+typedef struct {
+  UINT8            *Buffer;
+  UINTN            BufferSize;
+  UINTN            FileNumber;
+  UINTN            MaxFileNumber;
+  FFS_INDEX_ENTRY  *File;
+} FV_INDEX;
+
+#define MAX_FV_INDEX       4
+#define FV_INDEX_GROWTH    0x100
+
+FV_INDEX   mFvIndex[MAX_FV_INDEX];
+UINTN      mFvIndexNext = 0;
+
+VOID
+ReleaseFvIndex (
+  IN UINT8     *Buffer,
+  IN UINTN     BufferSize
+  )
+/*++
+
+Routine Description:
+
+  Drop the FFS indexes built for buffers within a memory range. This must be
+  called before such a buffer is freed, as its address may be reused.
+
+Arguments:
+
+  Buffer         - Start of the memory range, NULL for all indexes
+  BufferSize     - Size of the memory range
+
+Returns:
+
+  None
+
+--*/
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < MAX_FV_INDEX; Index++) {
+    if (mFvIndex[Index].Buffer == NULL) {
+      continue;
+    }
+    if ((Buffer != NULL) &&
+        (((UINTN)mFvIndex[Index].Buffer >= (UINTN)Buffer + BufferSize) ||
+         ((UINTN)mFvIndex[Index].Buffer + mFvIndex[Index].BufferSize <= (UINTN)Buffer))) {
+      continue;
+    }
+    free (mFvIndex[Index].File);
+    SetMem (&mFvIndex[Index], sizeof (FV_INDEX), 0);
+  }
+}
+
+FV_INDEX *
+GetFvIndex (
   IN UINT8     *FvBuffer,
-  IN UINT32    FvSize,
-  IN EFI_GUID  *Guid,
-  OUT UINT32   *FileSize
+  IN UINT32    FvSize
   )
 /*++
 
 Routine Description:
 
-  Find File with GUID in an FV
+  Get the index of all FFS files of the FVs in a buffer, building it on the
+  first request for that buffer.
 
 Arguments:
 
   FvBuffer       - FV binary buffer
   FvSize         - FV size
-  Guid           - File GUID value to be searched
-  FileSize       - Guid File size
 
 Returns:
 
-  FileLocation   - Guid File location.
-  NULL           - Guid File is not found.
+  FvIndex        - The index of the buffer.
+  NULL           - No memory to build the index.
 
 --*/
 {
+  FV_INDEX                    *FvIndex;
+  FFS_INDEX_ENTRY             *File;
   EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
   EFI_FFS_FILE_HEADER         *FileHeader;
   UINT64                      FvLength;
-  EFI_GUID                    *TempGuid;
-  UINT8                       *FixPoint;
+  UINTN                       Index;
   UINTN                       Offset;
   UINTN                       FileLength;
   UINTN                       FileOccupiedSize;
 
+  for (Index = 0; Index < MAX_FV_INDEX; Index++) {
+    if ((mFvIndex[Index].Buffer == FvBuffer) && (mFvIndex[Index].BufferSize == FvSize)) {
+      return &mFvIndex[Index];
+    }
+  }
+
   //
-  // Find the FFS file
+  // Reuse the oldest slot
   //
+  FvIndex = &mFvIndex[mFvIndexNext];
+  mFvIndexNext = (mFvIndexNext + 1) % MAX_FV_INDEX;
+  free (FvIndex->File);
+  SetMem (FvIndex, sizeof (FV_INDEX), 0);
+
   FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *)FindNextFvHeader (FvBuffer, FvSize);
-  if (NULL == FvHeader) {
-    return NULL;
-  }
-  while (TRUE) {
+  while (FvHeader != NULL) {
     FvLength         = FvHeader->FvLength;
-
-    //
-    // Prepare to walk the FV image
-    //
-    InitializeFvLib (FvHeader, (UINT32)FvLength);
+    if (FvLength == 0) {
+      break;
+    }
 
     FileHeader       = (EFI_FFS_FILE_HEADER *)((UINTN)FvHeader + FvHeader->HeaderLength);
     Offset           = (UINTN) FileHeader - (UINTN) FvHeader;
 
     while (Offset < FvLength) {
-      TempGuid = (EFI_GUID *)&(FileHeader->Name);
       FileLength = (*(UINT32 *)(FileHeader->Size)) & 0x00FFFFFF;
       FileOccupiedSize = GETOCCUPIEDSIZE(FileLength, 8);
-      if ((CompareGuid (TempGuid, Guid)) == 0) {
-        //
-        // Good! Find it.
-        //
-        FixPoint = ((UINT8 *)FileHeader + sizeof(EFI_FFS_FILE_HEADER));
-        //
-        // Find the position of file module, the offset
-        // between the position and the end of FvRecovery.fv file
-        // should not exceed 128kB to prevent reset vector from
-        // outside legacy E and F segment
-        //
-        if ((UINTN)FvHeader + FvLength - (UINTN)FixPoint > 0x20000) {
-  //        printf ("WARNING: The position of file module is not in E and F segment!\n");
-  //        return NULL;
+      if (FileOccupiedSize == 0) {
+        break;
+      }
+
+      if (FvIndex->FileNumber == FvIndex->MaxFileNumber) {
+        File = (FFS_INDEX_ENTRY *) realloc (
+                                     FvIndex->File,
+                                     (FvIndex->MaxFileNumber + FV_INDEX_GROWTH) * sizeof (FFS_INDEX_ENTRY)
+                                     );
+        if (File == NULL) {
+          Error (NULL, 0, 0, "No sufficient memory to allocate!", NULL);
+          free (FvIndex->File);
+          SetMem (FvIndex, sizeof (FV_INDEX), 0);
+          return NULL;
         }
-        *FileSize = FileLength - sizeof(EFI_FFS_FILE_HEADER);
+        FvIndex->File = File;
+        FvIndex->MaxFileNumber += FV_INDEX_GROWTH;
+      }
+
+      File = &FvIndex->File[FvIndex->FileNumber++];
+      memcpy (&File->Name, &FileHeader->Name, sizeof (EFI_GUID));
+      File->Data     = (UINT8 *)FileHeader + sizeof(EFI_FFS_FILE_HEADER);
+      File->DataSize = (UINT32)(FileLength - sizeof(EFI_FFS_FILE_HEADER));
   #if (PI_SPECIFICATION_VERSION < 0x00010000)
-        if (FileHeader->Attributes & FFS_ATTRIB_TAIL_PRESENT) {
-          *FileSize -= sizeof(EFI_FFS_FILE_TAIL);
-        }
-  #endif
-        return FixPoint;
+      if (FileHeader->Attributes & FFS_ATTRIB_TAIL_PRESENT) {
+        File->DataSize -= sizeof(EFI_FFS_FILE_TAIL);
       }
+  #endif
+
       FileHeader = (EFI_FFS_FILE_HEADER *)((UINTN)FileHeader + FileOccupiedSize);
       Offset = (UINTN) FileHeader - (UINTN) FvHeader;
     }
 
     //
-    // Not found, check next FV
+    // Next FV
     //
     if ((UINTN)FvBuffer + FvSize > (UINTN)FvHeader + FvLength) {
       FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *)FindNextFvHeader ((UINT8 *)FvHeader + (UINTN)FvLength, (UINTN)FvBuffer + FvSize - ((UINTN)FvHeader + (UINTN)FvLength));
-      if (FvHeader == NULL) {
-        break;
-      }
     } else {
-      break;
+      FvHeader = NULL;
+    }
+  }
+
+  FvIndex->Buffer     = FvBuffer;
+  FvIndex->BufferSize = FvSize;
+  return FvIndex;
+}
+
+UINT8  *
+FindFileFromFvByGuid (
+  IN UINT8     *FvBuffer,
+  IN UINT32    FvSize,
+  IN EFI_GUID  *Guid,
+  OUT UINT32   *FileSize
+  )
+/*++
+
+Routine Description:
+
+  Find File with GUID in an FV
+
+Arguments:
+
+  FvBuffer       - FV binary buffer
+  FvSize         - FV size
+  Guid           - File GUID value to be searched
+  FileSize       - Guid File size
+
+Returns:
+
+  FileLocation   - Guid File location.
+  NULL           - Guid File is not found.
+
+--*/
+{
+  FV_INDEX  *FvIndex;
+  UINTN     Index;
+
+  FvIndex = GetFvIndex (FvBuffer, FvSize);
+  if (FvIndex == NULL) {
+    return NULL;
+  }
+
+  //
+  // The index is in FV order, so the first match is the same file a scan of
+  // the buffer would find.
+  //
+  for (Index = 0; Index < FvIndex->FileNumber; Index++) {
+    if ((CompareGuid (&FvIndex->File[Index].Name, Guid)) == 0) {
+      *FileSize = FvIndex->File[Index].DataSize;
+      return FvIndex->File[Index].Data;
     }
   }
 
@@ -1531,7 +1770,7 @@ Returns:
       if (Index + 2 >= argc) {
         break;
       }
-      Status = ReadInputFile (argv[Index + 1], &MicrocodeFileBuffer, &MicrocodeFileSize, &MicrocodeFileBufferRaw);
+      Status = ReadCachedInputFile (argv[Index + 1], &MicrocodeFileBuffer, &MicrocodeFileSize, &MicrocodeFileBufferRaw);
       if (Status != STATUS_SUCCESS) {
         MicrocodeRegionOffset = xtoi (argv[Index + 1]);
         MicrocodeRegionSize   = xtoi (argv[Index + 2]);
@@ -1613,6 +1852,7 @@ Returns:
     }
 
     if (MicrocodeFileBufferRaw != NULL) {
+      ReleaseFvIndex (MicrocodeFileBuffer, MicrocodeFileSize);
       free ((VOID *)MicrocodeFileBufferRaw);
       MicrocodeFileBufferRaw = NULL;
     }
@@ -2314,6 +2554,146 @@ Returns:
   printf ("====== ================ ====== ======== ============== ==== ======== (====== ==== ====== ==== ======)\n");
 }
 
+CHAR8 *mFitReportFileName = NULL;
+
+VOID
+PrintJsonTypeName (
+  IN FILE                            *Fp,
+  IN FIRMWARE_INTERFACE_TABLE_ENTRY  *FitEntry
+  )
+/*++
+
+Routine Description:
+
+  Print the type name of a FIT entry as a JSON string
+
+Arguments:
+
+  Fp       - Report file
+  FitEntry - Fit entry
+
+Returns:
+
+  None
+
+--*/
+{
+  CHAR8   *TypeStr;
+  UINTN   Length;
+
+  if (FitEntry->Type == FIT_TABLE_TYPE_HEADER) {
+    TypeStr = "HEADER";
+  } else {
+    TypeStr = FitTypeToStr (FitEntry);
+  }
+
+  //
+  // The names are padded for the text table
+  //
+  Length = strlen (TypeStr);
+  while ((Length > 0) && (TypeStr[Length - 1] == ' ')) {
+    Length--;
+  }
+  fprintf (Fp, "\"%.*s\"", (int)Length, TypeStr);
+}
+
+STATUS
+WriteFitReport (
+  IN CHAR8                       *FileName,
+  IN UINT8                       *FvBuffer,
+  IN UINT32                      FvSize
+  )
+/*++
+
+Routine Description:
+
+  Write the Fit table in flash image to a file in JSON format
+
+Arguments:
+
+  FileName       - Name of the report file
+  FvBuffer       - FvRecovery binary buffer
+  FvSize         - FvRecovery size
+
+Returns:
+
+  STATUS_SUCCESS - The report is written
+  STATUS_ERROR   - No valid FIT table is found or the file is not written
+
+--*/
+{
+  FIRMWARE_INTERFACE_TABLE_ENTRY       *FitEntry;
+  FIRMWARE_INTERFACE_TABLE_ENTRY_PORT  *FitEntryPort;
+  FILE                                 *Fp;
+  UINT32                               EntryNum;
+  UINT32                               Index;
+  UINT32                               FitTableOffset;
+
+  FitTableOffset = *(UINT32 *)(FvBuffer + FvSize - gFitTableContext.FitTablePointerOffset);
+  FitEntry = (FIRMWARE_INTERFACE_TABLE_ENTRY *)FLASH_TO_MEMORY(FitTableOffset, FvBuffer, FvSize);
+  if ((((UINTN)FitEntry & 0xF) != 0) ||
+      ((UINT8 *)FitEntry < FvBuffer) ||
+      ((UINT8 *)(FitEntry + 1) > FvBuffer + FvSize) ||
+      (FitEntry[0].Type != FIT_TABLE_TYPE_HEADER) ||
+      (FitEntry[0].Address != *(UINT64 *)"_FIT_   ")) {
+    Error (NULL, 0, 0, "No valid FIT table to report", NULL);
+    return STATUS_ERROR;
+  }
+
+  EntryNum = *(UINT32 *)(&FitEntry[0].Size[0]) & 0xFFFFFF;
+  if ((UINT8 *)(FitEntry + EntryNum) > FvBuffer + FvSize) {
+    Error (NULL, 0, 0, "FIT table exceeds the image", NULL);
+    return STATUS_ERROR;
+  }
+
+  if ((Fp = fopen (FileName, "w")) == NULL) {
+    Error (NULL, 0, 0, "Unable to open file", "%s", FileName);
+    return STATUS_ERROR;
+  }
+
+  fprintf (Fp, "{\n");
+  fprintf (Fp, "  \"FitPointerOffset\": %u,\n", gFitTableContext.FitTablePointerOffset);
+  fprintf (Fp, "  \"FitTableAddress\": %u,\n", FitTableOffset);
+  fprintf (Fp, "  \"Entries\": [\n");
+  for (Index = 0; Index < EntryNum; Index++) {
+    fprintf (Fp, "    { \"Index\": %u, \"Address\": %llu, \"Size\": %u, \"Version\": %u, \"Type\": %u, \"TypeName\": ",
+      Index,
+      (unsigned long long) FitEntry[Index].Address,
+      *(UINT32 *)(&FitEntry[Index].Size[0]) & 0xFFFFFF,
+      FitEntry[Index].Version,
+      FitEntry[Index].Type
+      );
+    PrintJsonTypeName (Fp, &FitEntry[Index]);
+    fprintf (Fp, ", \"C_V\": %u, \"Checksum\": %u",
+      FitEntry[Index].C_V,
+      FitEntry[Index].Checksum
+      );
+
+    if (((FitEntry[Index].Type == FIT_TABLE_TYPE_TPM_POLICY) ||
+         (FitEntry[Index].Type == FIT_TABLE_TYPE_TXT_POLICY)) &&
+        (FitEntry[Index].Version == 0)) {
+      FitEntryPort = (FIRMWARE_INTERFACE_TABLE_ENTRY_PORT *)&FitEntry[Index];
+      fprintf (Fp, ", \"Port\": { \"IndexPort\": %u, \"DataPort\": %u, \"Width\": %u, \"Bit\": %u, \"Index\": %u }",
+        FitEntryPort->IndexPort,
+        FitEntryPort->DataPort,
+        FitEntryPort->Width,
+        FitEntryPort->Bit,
+        FitEntryPort->Index
+        );
+    }
+    fprintf (Fp, " }%s\n", (Index + 1 < EntryNum) ? "," : "");
+  }
+  fprintf (Fp, "  ]\n");
+  fprintf (Fp, "}\n");
+
+  if (fclose (Fp) != 0) {
+    Error (NULL, 0, 0, "Write report file error!", "%s", FileName);
+    return STATUS_ERROR;
+  }
+
+  return STATUS_SUCCESS;
+}
+
 /**
 
   This function dump raw data.
@@ -3255,6 +3635,13 @@ Returns:
     // For debug
     //
     PrintFitTable (FdFileBuffer, FdFileSize);
+
+    if (mFitReportFileName != NULL) {
+      Status = WriteFitReport (mFitReportFileName, FdFileBuffer, FdFileSize);
+      if (Status != STATUS_SUCCESS) {
+        goto exitFunc;
+      }
+    }
   } else {
     printf ("Clear FIT table ...\n");
     //
@@ -3288,6 +3675,7 @@ Returns:
   }
 
 exitFunc:
+  ReleaseFvIndex (NULL, 0);
   if (FileBufferRaw != NULL) {
     free ((VOID *)FileBufferRaw);
   }
@@ -3351,18 +3739,218 @@ Returns:
     goto exitFunc;
   }
 
+  //
+  // The image is assumed to end at 4G, as it does when generating
+  //
+  gFitTableContext.TopFlashAddressRemapValue = 0x100000000;
+
   //
   // For debug
   //
   PrintFitTable (FileBuffer, FvRecoveryFileSize);
 
+  if (mFitReportFileName != NULL) {
+    Status = WriteFitReport (mFitReportFileName, FileBuffer, FvRecoveryFileSize);
+  }
+
 exitFunc:
+  ReleaseFvIndex (NULL, 0);
   if (FileBufferRaw != NULL) {
     free ((VOID *)FileBufferRaw);
   }
   return Status;
 }
 
+STATUS
+RunFitCommand (
+  IN INTN   argc,
+  IN CHAR8  **argv
+  )
+/*++
+
+Routine Description:
+
+  Run one generate or view command line.
+
+Arguments:
+
+  argc - Number of command line parameters.
+  argv - Array of pointers to parameter strings.
+
+Returns:
+  STATUS_SUCCESS - Utility exits successfully.
+  STATUS_ERROR   - Some error occurred during execution.
+
+--*/
+{
+  CHAR8   **Args;
+  INTN    ArgCount;
+  INTN    Index;
+  STATUS  Status;
+
+  //
+  // Take -J <ReportFile> out, the remaining options are positional
+  //
+  Args = (CHAR8 **) malloc ((argc + 1) * sizeof (CHAR8 *));
+  if (Args == NULL) {
+    Error (NULL, 0, 0, "No sufficient memory to allocate!", NULL);
+    return STATUS_ERROR;
+  }
+  mFitReportFileName = NULL;
+  ArgCount = 0;
+  for (Index = 0; Index < argc; Index++) {
+    if ((Index > 0) && (Index + 1 < argc) &&
+        ((strcmp (argv[Index], "-J") == 0) || (strcmp (argv[Index], "-j") == 0))) {
+      mFitReportFileName = argv[Index + 1];
+      Index++;
+      continue;
+    }
+    Args[ArgCount++] = argv[Index];
+  }
+  Args[ArgCount] = NULL;
+
+  //
+  // Verify the correct number of arguments
+  //
+  if (ArgCount >= MIN_VIEW_ARGS && stricmp (Args[1], "-view") == 0) {
+    Status = FitView (ArgCount, Args);
+  } else if (ArgCount >= MIN_ARGS) {
+    Status = FitGen (ArgCount, Args);
+  } else {
+    Error (NULL, 0, 0, "invalid number of input parameters specified", NULL);
+    PrintUsage ();
+    Status = STATUS_ERROR;
+  }
+
+  mFitReportFileName = NULL;
+  free (Args);
+  return Status;
+}
+
+STATUS
+RunFitBatch (
+  IN CHAR8  *JobFileName
+  )
+/*++
+
+Routine Description:
+
+  Run all command lines of a job file in one process.
+
+Arguments:
+
+  JobFileName - Name of the job file.
+
+Returns:
+  STATUS_SUCCESS - All jobs completed successfully.
+  STATUS_WARNING - At least one job reported a warning.
+  STATUS_ERROR   - At least one job failed.
+
+--*/
+{
+  FILE      *FpJob;
+  CHAR8     *Line;
+  CHAR8     *Ptr;
+  CHAR8     *Args[MAX_JOB_ARGS];
+  INTN      ArgCount;
+  UINT32    LineNumber;
+  UINT32    JobNumber;
+  STATUS    Status;
+  STATUS    JobStatus;
+
+  if (!CheckPath (JobFileName)) {
+    Error (NULL, 0, 0, "File path is invalid!", NULL);
+    return STATUS_ERROR;
+  }
+  if ((FpJob = fopen (JobFileName, "r")) == NULL) {
+    Error (NULL, 0, 0, "Unable to open file", "%s", JobFileName);
+    return STATUS_ERROR;
+  }
+  Line = (CHAR8 *) malloc (MAX_JOB_LINE_LENGTH);
+  if (Line == NULL) {
+    Error (NULL, 0, 0, "No sufficient memory to allocate!", NULL);
+    fclose (FpJob);
+    return STATUS_ERROR;
+  }
+
+  mBatchMode = TRUE;
+  Status     = STATUS_SUCCESS;
+  LineNumber = 0;
+  JobNumber  = 0;
+  while (fgets (Line, MAX_JOB_LINE_LENGTH, FpJob) != NULL) {
+    LineNumber++;
+    if ((strchr (Line, '\n') == NULL) && !feof (FpJob)) {
+      Error (JobFileName, LineNumber, 0, "Job line too long", NULL);
+      Status = STATUS_ERROR;
+      break;
+    }
+
+    //
+    // Split the line into arguments, double quotes group an argument with spaces
+    //
+    Args[0]  = UTILITY_NAME;
+    ArgCount = 1;
+    Ptr      = Line;
+    while (TRUE) {
+      while ((*Ptr == ' ') || (*Ptr == '\t') || (*Ptr == '\r') || (*Ptr == '\n')) {
+        Ptr++;
+      }
+      if ((*Ptr == '\0') || ((ArgCount == 1) && (*Ptr == '#'))) {
+        break;
+      }
+      if (ArgCount >= MAX_JOB_ARGS - 1) {
+        Error (JobFileName, LineNumber, 0, "Too many job arguments", NULL);
+        ArgCount = 0;
+        break;
+      }
+      if (*Ptr == '"') {
+        Args[ArgCount++] = ++Ptr;
+        while ((*Ptr != '\0') && (*Ptr != '"')) {
+          Ptr++;
+        }
+      } else {
+        Args[ArgCount++] = Ptr;
+        while ((*Ptr != '\0') && (*Ptr != ' ') && (*Ptr != '\t') && (*Ptr != '\r') && (*Ptr != '\n')) {
+          Ptr++;
+        }
+      }
+      if (*Ptr != '\0') {
+        *Ptr++ = '\0';
+      }
+    }
+
+    if (ArgCount == 0) {
+      Status = STATUS_ERROR;
+      continue;
+    }
+    if (ArgCount == 1) {
+      continue;
+    }
+    Args[ArgCount] = NULL;
+
+    JobNumber++;
+    printf ("FitGen job %d (%s line %d)\n", JobNumber, JobFileName, LineNumber);
+
+    //
+    // Every job starts from a clean FIT context
+    //
+    SetMem (&gFitTableContext, sizeof (gFitTableContext), 0);
+    JobStatus = RunFitCommand (ArgCount, Args);
+    if (JobStatus != STATUS_SUCCESS) {
+      Error (JobFileName, LineNumber, 0, "Job failed", NULL);
+      if (Status != STATUS_ERROR) {
+        Status = JobStatus;
+      }
+    }
+  }
+
+  FreeInputFileCache ();
+  mBatchMode = FALSE;
+  free (Line);
+  fclose (FpJob);
+  return Status;
+}
+
 int
 main (
   int   argc,
@@ -3392,18 +3980,11 @@ Returns:
   //
   PrintUtilityInfo ();
 
-  //
-  // Verify the correct number of arguments
-  //
-  if (argc >= MIN_VIEW_ARGS && stricmp (argv[1], "-view") == 0) {
-    return FitView (argc, argv);
-  } else if (argc >= MIN_ARGS) {
-    return FitGen (argc, argv);
-  } else {
-    Error (NULL, 0, 0, "invalid number of input parameters specified", NULL);
-    PrintUsage ();
-    return STATUS_ERROR;
+  if (argc == 3 && stricmp (argv[1], "-batch") == 0) {
+    return RunFitBatch (argv[2]);
   }
+
+  return RunFitCommand (argc, argv);
 }
 
 unsigned int
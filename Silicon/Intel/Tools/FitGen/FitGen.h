@@ -41,6 +41,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define MIN_ARGS        4
 #define BUF_SIZE        (8 * 1024)
 
+//
+// Limits of a batch mode job line
+//
+#define MAX_JOB_LINE_LENGTH  (16 * 1024)
+#define MAX_JOB_ARGS         512
+
 #define GETOCCUPIEDSIZE(ActualSize, Alignment) \
   (ActualSize) + (((Alignment) - ((ActualSize) & ((Alignment) - 1))) & ((Alignment) - 1))
 ;
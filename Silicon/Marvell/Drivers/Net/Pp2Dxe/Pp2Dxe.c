@@ -98,50 +98,11 @@ EFI_SIMPLE_NETWORK_MODE Pp2SnpModeTemplate = {
   },                                                    // Permanent Address
   NET_IFTYPE_ETHERNET,                                  // IfType
   TRUE,                                                 // MacAddressChangeable
-  FALSE,                                                // MultipleTxSupported
+  TRUE,                                                 // MultipleTxSupported
   TRUE,                                                 // MediaPresentSupported
   FALSE                                                 // MediaPresent
 };
 
-#define QueueNext(off)  ((((off) + 1) >= QUEUE_DEPTH) ? 0 : ((off) + 1))
-
-STATIC
-EFI_STATUS
-QueueInsert (
-  IN PP2DXE_CONTEXT *Pp2Context,
-  IN VOID *Buffer
-  )
-{
-
-  if (QueueNext (Pp2Context->CompletionQueueTail) == Pp2Context->CompletionQueueHead) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  Pp2Context->CompletionQueue[Pp2Context->CompletionQueueTail] = Buffer;
-  Pp2Context->CompletionQueueTail = QueueNext (Pp2Context->CompletionQueueTail);
-
-  return EFI_SUCCESS;
-}
-
-STATIC
-VOID *
-QueueRemove (
-  IN PP2DXE_CONTEXT *Pp2Context
-  )
-{
-  VOID *Buffer;
-
-  if (Pp2Context->CompletionQueueTail == Pp2Context->CompletionQueueHead) {
-    return NULL;
-  }
-
-  Buffer = Pp2Context->CompletionQueue[Pp2Context->CompletionQueueHead];
-  Pp2Context->CompletionQueue[Pp2Context->CompletionQueueHead] = NULL;
-  Pp2Context->CompletionQueueHead = QueueNext (Pp2Context->CompletionQueueHead);
-
-  return Buffer;
-}
-
 STATIC
 EFI_STATUS
 Pp2DxeBmPoolInit (
@@ -515,6 +476,37 @@ Pp2DxePhyInitialize (
   return EFI_SUCCESS;
 }
 
+/*
+ * Hand the buffers still lent out through MARVELL_PP2_RX_PROTOCOL back to BM
+ * and report the descriptors of a partially processed batch to HW, so that
+ * RX starts over from a consistent state.
+ */
+STATIC
+VOID
+Pp2DxeRxReclaim (
+  IN PP2DXE_CONTEXT *Pp2Context
+  )
+{
+  PP2DXE_PORT *Port = &Pp2Context->Port;
+  PP2DXE_RX_LOAN *Loan;
+  INTN Index;
+
+  for (Index = 0; Index < MVPP2_MAX_RX_LOANS; Index++) {
+    Loan = &Pp2Context->RxLoans[Index];
+    if (Loan->Frame != NULL) {
+      Mvpp2BmPoolPut(Port->Priv, Loan->PoolId, Loan->PhysAddr, Loan->VirtAddr);
+      Loan->Frame = NULL;
+    }
+  }
+
+  if (Pp2Context->RxProcessed > 0) {
+    Mvpp2RxqStatusUpdate(Port, Port->Rxqs[0].Id, Pp2Context->RxProcessed, Pp2Context->RxProcessed);
+  }
+
+  Pp2Context->RxPending = 0;
+  Pp2Context->RxProcessed = 0;
+}
+
 EFI_STATUS
 EFIAPI
 Pp2DxeSnpInitialize (
@@ -554,6 +546,7 @@ Pp2DxeSnpInitialize (
   This->Mode->State = EfiSimpleNetworkInitialized;
 
   if (Pp2Context->Initialized) {
+    Pp2DxeRxReclaim (Pp2Context);
     ReturnUnlock(SavedTpl, EFI_SUCCESS);
   }
 
@@ -619,6 +612,8 @@ Pp2SnpStop (
     }
   }
 
+  Pp2DxeRxReclaim (Pp2Context);
+
   This->Mode->State = EfiSimpleNetworkStopped;
   ReturnUnlock (SavedTpl, EFI_SUCCESS);
 }
@@ -630,7 +625,16 @@ Pp2SnpReset (
   IN BOOLEAN                     ExtendedVerification
   )
 {
-  return EFI_SUCCESS;
+  PP2DXE_CONTEXT *Pp2Context = INSTANCE_FROM_SNP(This);
+  EFI_TPL SavedTpl;
+
+  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  if (This->Mode->State == EfiSimpleNetworkInitialized) {
+    Pp2DxeRxReclaim (Pp2Context);
+  }
+
+  ReturnUnlock (SavedTpl, EFI_SUCCESS);
 }
 
 VOID
@@ -645,6 +649,8 @@ Pp2DxeHalt (
   MVPP2_SHARED *Mvpp2Shared = Pp2Context->Port.Priv;
   INTN Index;
 
+  Pp2DxeRxReclaim (Pp2Context);
+
   if (Mvpp2Shared->BmEnabled) {
     for (Index = 0; Index < MVPP2_MAX_PORT; Index++) {
       Mvpp2BmStop(Mvpp2Shared, Index);
@@ -685,6 +691,10 @@ Pp2SnpShutdown (
     }
   }
 
+  Pp2DxeTxDrain (Pp2Context);
+
+  Pp2DxeRxReclaim (Pp2Context);
+
   ReturnUnlock (SavedTpl, EFI_SUCCESS);
 }
 
@@ -807,162 +817,52 @@ Pp2SnpNvData (
   return EFI_UNSUPPORTED;
 }
 
-EFI_STATUS
-EFIAPI
-Pp2SnpGetStatus (
-  IN EFI_SIMPLE_NETWORK_PROTOCOL *Snp,
-  OUT UINT32                     *InterruptStatus OPTIONAL,
-  OUT VOID                       **TxBuf OPTIONAL
+/*
+ * Return the next received descriptor without consuming it. The number of
+ * occupied descriptors is read from HW only once per batch and the batch
+ * is then processed from the ring without further register accesses.
+ */
+STATIC
+MVPP2_RX_DESC *
+Pp2DxeRxPeek (
+  IN PP2DXE_CONTEXT *Pp2Context
   )
 {
-  PP2DXE_CONTEXT *Pp2Context = INSTANCE_FROM_SNP(Snp);
   PP2DXE_PORT *Port = &Pp2Context->Port;
-  BOOLEAN LinkUp;
-  EFI_TPL SavedTpl;
-
-  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
-
-  if (!Pp2Context->Initialized)
-    ReturnUnlock(SavedTpl, EFI_NOT_READY);
-
-  LinkUp = Port->AlwaysUp ? TRUE : MvGop110PortIsLinkUp(Port);
-
-  if (LinkUp != Snp->Mode->MediaPresent) {
-    DEBUG((DEBUG_INFO, "Pp2Dxe%d: Link ", Pp2Context->Instance));
-    DEBUG((DEBUG_INFO, LinkUp ? "up\n" : "down\n"));
-  }
-  Snp->Mode->MediaPresent = LinkUp;
+  MVPP2_RX_QUEUE *Rxq = &Port->Rxqs[0];
 
-  if (TxBuf != NULL) {
-    *TxBuf = QueueRemove (Pp2Context);
+  if (Pp2Context->RxPending == 0) {
+    Pp2Context->RxPending = Mvpp2RxqReceived(Port, Rxq->Id);
+    if (Pp2Context->RxPending == 0) {
+      return NULL;
+    }
   }
 
-  ReturnUnlock(SavedTpl, EFI_SUCCESS);
+  return Rxq->Descs + Rxq->NextDescToProc;
 }
 
-EFI_STATUS
-EFIAPI
-Pp2SnpTransmit (
-  IN EFI_SIMPLE_NETWORK_PROTOCOL *This,
-  IN UINTN                       HeaderSize,
-  IN UINTN                       BufferSize,
-  IN VOID                        *Buffer,
-  IN EFI_MAC_ADDRESS             *SrcAddr  OPTIONAL,
-  IN EFI_MAC_ADDRESS             *DestAddr OPTIONAL,
-  IN UINT16                      *EtherTypePtr OPTIONAL
+/*
+ * Consume the descriptor returned by Pp2DxeRxPeek. Descriptors are handed
+ * back to HW with a single status update once the whole batch is processed.
+ */
+STATIC
+VOID
+Pp2DxeRxConsume (
+  IN PP2DXE_CONTEXT *Pp2Context
   )
 {
-  PP2DXE_CONTEXT *Pp2Context = INSTANCE_FROM_SNP(This);
   PP2DXE_PORT *Port = &Pp2Context->Port;
-  MVPP2_SHARED *Mvpp2Shared = Pp2Context->Port.Priv;
-  MVPP2_TX_QUEUE *AggrTxq = Mvpp2Shared->AggrTxqs;
-  MVPP2_TX_DESC *TxDesc;
-  EFI_STATUS Status;
-  INTN PollingCount;
-  INTN TxSent;
-  UINT8 *DataPtr = Buffer;
-  UINT16 EtherType;
-  UINT32 State = This->Mode->State;
-  EFI_TPL SavedTpl;
-
-  if (This == NULL || Buffer == NULL) {
-    DEBUG((DEBUG_ERROR, "Pp2Dxe: NULL Snp or Buffer\n"));
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (HeaderSize != 0) {
-    ASSERT (HeaderSize == This->Mode->MediaHeaderSize);
-    ASSERT (EtherTypePtr != NULL);
-    ASSERT (DestAddr != NULL);
-  }
-
-  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
-
-  /* Check that driver was started and initialised */
-  if (State != EfiSimpleNetworkInitialized) {
-    switch (State) {
-    case EfiSimpleNetworkStopped:
-      DEBUG((DEBUG_WARN, "Pp2Dxe%d: not started\n", Pp2Context->Instance));
-      ReturnUnlock (SavedTpl, EFI_NOT_STARTED);
-    case EfiSimpleNetworkStarted:
-    /* Fall through */
-    default:
-      DEBUG((DEBUG_ERROR, "Pp2Dxe%d: wrong state\n", Pp2Context->Instance));
-      ReturnUnlock (SavedTpl, EFI_DEVICE_ERROR);
-    }
-  }
-
-  if (!This->Mode->MediaPresent) {
-    DEBUG((DEBUG_ERROR, "Pp2Dxe: link not ready\n"));
-    ReturnUnlock(SavedTpl, EFI_NOT_READY);
-  }
-
-  EtherType = HTONS (*EtherTypePtr);
-
-  /* Fetch next descriptor */
-  TxDesc = Mvpp2TxqNextDescGet(AggrTxq);
-
-  if (!TxDesc) {
-    DEBUG((DEBUG_ERROR, "No tx descriptor to use\n"));
-    ReturnUnlock(SavedTpl, EFI_OUT_OF_RESOURCES);
-  }
-
-  if (HeaderSize != 0) {
-    CopyMem(DataPtr, DestAddr, NET_ETHER_ADDR_LEN);
-
-    if (SrcAddr != NULL)
-      CopyMem(DataPtr + NET_ETHER_ADDR_LEN, SrcAddr, NET_ETHER_ADDR_LEN);
-    else
-      CopyMem(DataPtr + NET_ETHER_ADDR_LEN, &This->Mode->CurrentAddress, NET_ETHER_ADDR_LEN);
-
-    CopyMem(DataPtr + NET_ETHER_ADDR_LEN * 2, &EtherType, 2);
-  }
-
-  /* Set descriptor fields */
-  TxDesc->command =  MVPP2_TXD_IP_CSUM_DISABLE | MVPP2_TXD_L4_CSUM_NOT |
-                     MVPP2_TXD_F_DESC | MVPP2_TXD_L_DESC;
-  TxDesc->DataSize = BufferSize;
-  TxDesc->PacketOffset = (PhysAddrT)DataPtr & MVPP2_TX_DESC_ALIGN;
-  Mvpp2x2TxdescPhysAddrSet((PhysAddrT)DataPtr & ~MVPP2_TX_DESC_ALIGN, TxDesc);
-  TxDesc->PhysTxq = Mvpp2TxqPhys(Port->Id, 0);
-
-  InvalidateDataCacheRange (DataPtr, BufferSize);
+  MVPP2_RX_QUEUE *Rxq = &Port->Rxqs[0];
 
-  /* Issue send */
-  Mvpp2AggrTxqPendDescAdd(Port, 1);
+  Mvpp2RxqNextDescGet(Rxq);
+  Pp2Context->RxPending--;
+  Pp2Context->RxProcessed++;
 
-  /*
-   * Egress processing:
-   * Wait until packet is passed from per-cpu aggregated queue
-   * to physical per-port TXQ.
-   */
-  PollingCount = 0;
-  TxSent = Mvpp2AggrTxqPendDescNumGet(Mvpp2Shared, 0);
-  do {
-    if (PollingCount++ > MVPP2_TX_SEND_MAX_POLLING_COUNT) {
-      DEBUG((DEBUG_ERROR, "Pp2Dxe: transmit polling failed\n"));
-      ReturnUnlock(SavedTpl, EFI_TIMEOUT);
-    }
-    TxSent = Mvpp2AggrTxqPendDescNumGet(Mvpp2Shared, 0);
-  } while (TxSent);
-
-  /* Wait for packet to be transmitted by hardware. */
-  PollingCount = 0;
-  TxSent = Mvpp2TxqSentDescProc(Port, &Port->Txqs[0]);
-  while (!TxSent) {
-    if (PollingCount++ > MVPP2_TX_SEND_MAX_POLLING_COUNT) {
-      DEBUG((DEBUG_ERROR, "Pp2Dxe: transmit polling failed\n"));
-      ReturnUnlock(SavedTpl, EFI_TIMEOUT);
-    }
-    TxSent = Mvpp2TxqSentDescProc(Port, &Port->Txqs[0]);
+  if (Pp2Context->RxPending == 0) {
+    /* Update counters with processed packets and refilled descriptors */
+    Mvpp2RxqStatusUpdate(Port, Rxq->Id, Pp2Context->RxProcessed, Pp2Context->RxProcessed);
+    Pp2Context->RxProcessed = 0;
   }
-
-  /*
-   * At this point TxSent has increased - HW sent the packet
-   * Add buffer to completion queue and return.
-   */
-  Status = QueueInsert (Pp2Context, Buffer);
-  ReturnUnlock (SavedTpl, Status);
 }
 
 EFI_STATUS
@@ -977,9 +877,7 @@ Pp2SnpReceive (
   OUT UINT16                     *EtherType OPTIONAL
   )
 {
-  INTN ReceivedPackets;
   PP2DXE_CONTEXT *Pp2Context = INSTANCE_FROM_SNP(This);
-  PP2DXE_PORT *Port = &Pp2Context->Port;
   MVPP2_SHARED *Mvpp2Shared = Pp2Context->Port.Priv;
   UINTN PhysAddr, VirtAddr;
   EFI_STATUS Status = EFI_SUCCESS;
@@ -989,21 +887,18 @@ Pp2SnpReceive (
   UINTN PktLength;
   UINT8 *DataPtr;
   MVPP2_RX_DESC *RxDesc;
-  MVPP2_RX_QUEUE *Rxq = &Port->Rxqs[0];
-
-  ASSERT (Port != NULL);
-  ASSERT (Rxq != NULL);
 
   SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
-  ReceivedPackets = Mvpp2RxqReceived(Port, Rxq->Id);
 
-  if (ReceivedPackets == 0) {
+  /* Process one packet per call */
+  RxDesc = Pp2DxeRxPeek (Pp2Context);
+  if (RxDesc == NULL) {
     ReturnUnlock(SavedTpl, EFI_NOT_READY);
   }
 
-  /* Process one packet per call */
-  RxDesc = Mvpp2RxqNextDescGet(Rxq);
+  /* Read the descriptor only once */
   StatusReg = RxDesc->status;
+  PktLength = (UINTN) RxDesc->DataSize - 2;
 
   /* extract addresses from descriptor */
   PhysAddr = RxDesc->BufPhysAddrKeyHash & MVPP22_ADDR_MASK;
@@ -1016,7 +911,7 @@ Pp2SnpReceive (
     goto drop;
   }
 
-  PktLength = (UINTN) RxDesc->DataSize - 2;
+  /* Leave the descriptor in place, so that the caller can retry */
   if (PktLength > *BufferSize) {
     *BufferSize = PktLength;
     DEBUG((DEBUG_ERROR, "Pp2Dxe: buffer too small\n"));
@@ -1054,12 +949,125 @@ drop:
   PoolId = (StatusReg & MVPP2_RXD_BM_POOL_ID_MASK) >> MVPP2_RXD_BM_POOL_ID_OFFS;
   Mvpp2BmPoolPut(Mvpp2Shared, PoolId, PhysAddr, VirtAddr);
 
-  /* Update counters with 1 packet received and 1 packet refilled */
-  Mvpp2RxqStatusUpdate(Port, Rxq->Id, 1, 1);
+  Pp2DxeRxConsume (Pp2Context);
 
   ReturnUnlock(SavedTpl, Status);
 }
 
+/*
+ * Zero-copy counterpart of Pp2SnpReceive. Instead of copying the frame and
+ * refilling BM right away, the BM buffer is lent to the caller until it is
+ * given back with Pp2RxRelease.
+ */
+STATIC
+EFI_STATUS
+EFIAPI
+Pp2RxReceive (
+  IN MARVELL_PP2_RX_PROTOCOL *This,
+  OUT VOID **Frame,
+  OUT UINTN *FrameSize
+  )
+{
+  PP2DXE_CONTEXT *Pp2Context;
+  MVPP2_SHARED *Mvpp2Shared;
+  PP2DXE_RX_LOAN *Loan;
+  MVPP2_RX_DESC *RxDesc;
+  EFI_STATUS Status;
+  EFI_TPL SavedTpl;
+  UINTN PhysAddr, VirtAddr;
+  UINT32 StatusReg;
+  INTN PoolId;
+  INTN Index;
+
+  if (This == NULL || Frame == NULL || FrameSize == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Pp2Context = INSTANCE_FROM_PP2RX(This);
+  Mvpp2Shared = Pp2Context->Port.Priv;
+
+  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  if (Pp2Context->Snp.Mode->State != EfiSimpleNetworkInitialized) {
+    ReturnUnlock (SavedTpl, EFI_NOT_STARTED);
+  }
+
+  Loan = NULL;
+  for (Index = 0; Index < MVPP2_MAX_RX_LOANS; Index++) {
+    if (Pp2Context->RxLoans[Index].Frame == NULL) {
+      Loan = &Pp2Context->RxLoans[Index];
+      break;
+    }
+  }
+
+  if (Loan == NULL) {
+    ReturnUnlock (SavedTpl, EFI_OUT_OF_RESOURCES);
+  }
+
+  RxDesc = Pp2DxeRxPeek (Pp2Context);
+  if (RxDesc == NULL) {
+    ReturnUnlock (SavedTpl, EFI_NOT_READY);
+  }
+
+  StatusReg = RxDesc->status;
+  PhysAddr = RxDesc->BufPhysAddrKeyHash & MVPP22_ADDR_MASK;
+  VirtAddr = RxDesc->BufCookieBmQsetClsInfo & MVPP22_ADDR_MASK;
+  PoolId = (StatusReg & MVPP2_RXD_BM_POOL_ID_MASK) >> MVPP2_RXD_BM_POOL_ID_OFFS;
+
+  if ((StatusReg & MVPP2_RXD_BUF_HDR) || (StatusReg & MVPP2_RXD_ERR_SUMMARY)) {
+    DEBUG((DEBUG_WARN, "Pp2Dxe: dropping packet\n"));
+    Mvpp2BmPoolPut(Mvpp2Shared, PoolId, PhysAddr, VirtAddr);
+    Status = EFI_DEVICE_ERROR;
+  } else {
+    /* Skip the 2 bytes of HW header */
+    Loan->Frame = (VOID *) (PhysAddr + 2);
+    Loan->PhysAddr = PhysAddr;
+    Loan->VirtAddr = VirtAddr;
+    Loan->PoolId = PoolId;
+
+    *Frame = Loan->Frame;
+    *FrameSize = (UINTN) RxDesc->DataSize - 2;
+    Status = EFI_SUCCESS;
+  }
+
+  Pp2DxeRxConsume (Pp2Context);
+
+  ReturnUnlock (SavedTpl, Status);
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+Pp2RxRelease (
+  IN MARVELL_PP2_RX_PROTOCOL *This,
+  IN VOID *Frame
+  )
+{
+  PP2DXE_CONTEXT *Pp2Context;
+  PP2DXE_RX_LOAN *Loan;
+  EFI_TPL SavedTpl;
+  INTN Index;
+
+  if (This == NULL || Frame == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Pp2Context = INSTANCE_FROM_PP2RX(This);
+
+  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  for (Index = 0; Index < MVPP2_MAX_RX_LOANS; Index++) {
+    Loan = &Pp2Context->RxLoans[Index];
+    if (Loan->Frame == Frame) {
+      Mvpp2BmPoolPut(Pp2Context->Port.Priv, Loan->PoolId, Loan->PhysAddr, Loan->VirtAddr);
+      Loan->Frame = NULL;
+      ReturnUnlock (SavedTpl, EFI_SUCCESS);
+    }
+  }
+
+  ReturnUnlock (SavedTpl, EFI_NOT_FOUND);
+}
+
 EFI_STATUS
 Pp2DxeSnpInstall (
   IN PP2DXE_CONTEXT *Pp2Context
@@ -1082,6 +1090,8 @@ Pp2DxeSnpInstall (
 
   /* Copy SNP data from templates */
   CopyMem (&Pp2Context->Snp, &Pp2SnpTemplate, sizeof (EFI_SIMPLE_NETWORK_PROTOCOL));
+  Pp2Context->Pp2Rx.Receive = Pp2RxReceive;
+  Pp2Context->Pp2Rx.Release = Pp2RxRelease;
   CopyMem (SnpMode, &Pp2SnpModeTemplate, sizeof (EFI_SIMPLE_NETWORK_MODE));
 
   /* Handle device path of the controller */
@@ -1104,6 +1114,7 @@ Pp2DxeSnpInstall (
       &gEfiSimpleNetworkProtocolGuid, &Pp2Context->Snp,
       &gEfiDevicePathProtocolGuid, Pp2DevicePath,
       &gEfiAdapterInformationProtocolGuid, &Pp2Context->Aip,
+      &gMarvellPp2RxProtocolGuid, &Pp2Context->Pp2Rx,
       NULL
       );
 
@@ -15,6 +15,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/Ip4.h>
 #include <Protocol/Ip6.h>
 #include <Protocol/MvPhy.h>
+#include <Protocol/MvPp2Rx.h>
 #include <Protocol/SimpleNetwork.h>
 
 #include <Library/BaseLib.h>
@@ -35,6 +36,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define PP2DXE_SIGNATURE                    SIGNATURE_32('P', 'P', '2', 'D')
 #define INSTANCE_FROM_AIP(a)                CR((a), PP2DXE_CONTEXT, Aip, PP2DXE_SIGNATURE)
 #define INSTANCE_FROM_SNP(a)                CR((a), PP2DXE_CONTEXT, Snp, PP2DXE_SIGNATURE)
+#define INSTANCE_FROM_PP2RX(a)              CR((a), PP2DXE_CONTEXT, Pp2Rx, PP2DXE_SIGNATURE)
 
 /* OS API */
 #define Mvpp2Alloc(v)                       AllocateZeroPool(v)
@@ -324,6 +326,19 @@ typedef struct {
 } PP2_DEVICE_PATH;
 
 #define QUEUE_DEPTH 64
+
+/*
+ * Maximum number of BM buffers lent out through MARVELL_PP2_RX_PROTOCOL,
+ * kept well below MVPP2_BM_SIZE so that HW does not run out of buffers.
+ */
+#define MVPP2_MAX_RX_LOANS 16
+typedef struct {
+  VOID                        *Frame;
+  UINTN                       PhysAddr;
+  UINTN                       VirtAddr;
+  INTN                        PoolId;
+} PP2DXE_RX_LOAN;
+
 typedef struct {
   UINT32                      Signature;
   INTN                        Instance;
@@ -338,6 +353,15 @@ typedef struct {
   VOID                        *CompletionQueue[QUEUE_DEPTH];
   UINTN                       CompletionQueueHead;
   UINTN                       CompletionQueueTail;
+  /* Buffers handed to HW, in descriptor order, not yet reported as sent */
+  VOID                        *TxInFlight[MVPP2_MAX_TXD];
+  UINTN                       TxInFlightHead;
+  UINTN                       TxInFlightCount;
+  /* Received descriptors read from HW and not yet processed */
+  INTN                        RxPending;
+  INTN                        RxProcessed;
+  MARVELL_PP2_RX_PROTOCOL     Pp2Rx;
+  PP2DXE_RX_LOAN              RxLoans[MVPP2_MAX_RX_LOANS];
   EFI_EVENT                   EfiExitBootServicesEvent;
   PP2_DEVICE_PATH             *DevicePath;
   EFI_ADAPTER_INFORMATION_PROTOCOL Aip;
@@ -596,4 +620,10 @@ Pp2SnpReceive (
   OUT EFI_MAC_ADDRESS            *DstAddr OPTIONAL,
   OUT UINT16                     *EtherType OPTIONAL
   );
+
+/* Transmit path, see Pp2DxeTx.c */
+VOID
+Pp2DxeTxDrain (
+  IN PP2DXE_CONTEXT *Pp2Context
+  );
 #endif
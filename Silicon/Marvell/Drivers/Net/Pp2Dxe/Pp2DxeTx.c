@@ -0,0 +1,267 @@
+/********************************************************************************
+Copyright (C) 2016 Marvell International Ltd.
+Copyright (c) 2020, Arm Limited. All rights reserved.<BR>
+Copyright (c) 2026, agent <agent@local>
+
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+*******************************************************************************/
+
+#include <Protocol/SimpleNetwork.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/NetLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include "Mvpp2LibHw.h"
+#include "Mvpp2Lib.h"
+#include "Pp2Dxe.h"
+
+#define ReturnUnlock(tpl, status) do { gBS->RestoreTPL (tpl); return (status); } while(0)
+
+#define QueueNext(off)  ((((off) + 1) >= QUEUE_DEPTH) ? 0 : ((off) + 1))
+
+STATIC
+EFI_STATUS
+QueueInsert (
+  IN PP2DXE_CONTEXT *Pp2Context,
+  IN VOID *Buffer
+  )
+{
+
+  if (QueueNext (Pp2Context->CompletionQueueTail) == Pp2Context->CompletionQueueHead) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Pp2Context->CompletionQueue[Pp2Context->CompletionQueueTail] = Buffer;
+  Pp2Context->CompletionQueueTail = QueueNext (Pp2Context->CompletionQueueTail);
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID *
+QueueRemove (
+  IN PP2DXE_CONTEXT *Pp2Context
+  )
+{
+  VOID *Buffer;
+
+  if (Pp2Context->CompletionQueueTail == Pp2Context->CompletionQueueHead) {
+    return NULL;
+  }
+
+  Buffer = Pp2Context->CompletionQueue[Pp2Context->CompletionQueueHead];
+  Pp2Context->CompletionQueue[Pp2Context->CompletionQueueHead] = NULL;
+  Pp2Context->CompletionQueueHead = QueueNext (Pp2Context->CompletionQueueHead);
+
+  return Buffer;
+}
+
+STATIC
+UINTN
+QueueCount (
+  IN PP2DXE_CONTEXT *Pp2Context
+  )
+{
+  return (Pp2Context->CompletionQueueTail + QUEUE_DEPTH -
+          Pp2Context->CompletionQueueHead) % QUEUE_DEPTH;
+}
+
+/*
+ * Move buffers of the packets already sent by HW from the in-flight
+ * list to the completion queue. The in-flight list is kept in descriptor
+ * order, so the oldest entries are the ones the HW has completed.
+ */
+STATIC
+VOID
+Pp2DxeTxReap (
+  IN PP2DXE_CONTEXT *Pp2Context
+  )
+{
+  PP2DXE_PORT *Port = &Pp2Context->Port;
+  INTN TxSent;
+
+  if (Pp2Context->TxInFlightCount == 0) {
+    return;
+  }
+
+  /* Reading the counter resets it, so account for all reported packets */
+  TxSent = Mvpp2TxqSentDescProc(Port, &Port->Txqs[0]);
+
+  while (TxSent-- > 0 && Pp2Context->TxInFlightCount > 0) {
+    /* Space is reserved in Pp2SnpTransmit, so this cannot fail */
+    QueueInsert (Pp2Context, Pp2Context->TxInFlight[Pp2Context->TxInFlightHead]);
+    Pp2Context->TxInFlight[Pp2Context->TxInFlightHead] = NULL;
+    Pp2Context->TxInFlightHead = (Pp2Context->TxInFlightHead + 1) % MVPP2_MAX_TXD;
+    Pp2Context->TxInFlightCount--;
+  }
+}
+
+/*
+ * Wait, bounded by MVPP2_TX_SEND_MAX_POLLING_COUNT, for HW to finish the
+ * packets still in flight, so their buffers can be recycled.
+ */
+VOID
+Pp2DxeTxDrain (
+  IN PP2DXE_CONTEXT *Pp2Context
+  )
+{
+  INTN PollingCount;
+
+  for (PollingCount = 0; Pp2Context->TxInFlightCount > 0; PollingCount++) {
+    if (PollingCount > MVPP2_TX_SEND_MAX_POLLING_COUNT) {
+      DEBUG((DEBUG_ERROR, "Pp2Dxe%d: transmit polling failed\n", Pp2Context->Instance));
+      break;
+    }
+    Pp2DxeTxReap (Pp2Context);
+  }
+}
+
+EFI_STATUS
+EFIAPI
+Pp2SnpGetStatus (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL *Snp,
+  OUT UINT32                     *InterruptStatus OPTIONAL,
+  OUT VOID                       **TxBuf OPTIONAL
+  )
+{
+  PP2DXE_CONTEXT *Pp2Context = INSTANCE_FROM_SNP(Snp);
+  PP2DXE_PORT *Port = &Pp2Context->Port;
+  BOOLEAN LinkUp;
+  EFI_TPL SavedTpl;
+
+  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  if (!Pp2Context->Initialized)
+    ReturnUnlock(SavedTpl, EFI_NOT_READY);
+
+  LinkUp = Port->AlwaysUp ? TRUE : MvGop110PortIsLinkUp(Port);
+
+  if (LinkUp != Snp->Mode->MediaPresent) {
+    DEBUG((DEBUG_INFO, "Pp2Dxe%d: Link ", Pp2Context->Instance));
+    DEBUG((DEBUG_INFO, LinkUp ? "up\n" : "down\n"));
+  }
+  Snp->Mode->MediaPresent = LinkUp;
+
+  if (TxBuf != NULL) {
+    Pp2DxeTxReap (Pp2Context);
+    *TxBuf = QueueRemove (Pp2Context);
+  }
+
+  ReturnUnlock(SavedTpl, EFI_SUCCESS);
+}
+
+EFI_STATUS
+EFIAPI
+Pp2SnpTransmit (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL *This,
+  IN UINTN                       HeaderSize,
+  IN UINTN                       BufferSize,
+  IN VOID                        *Buffer,
+  IN EFI_MAC_ADDRESS             *SrcAddr  OPTIONAL,
+  IN EFI_MAC_ADDRESS             *DestAddr OPTIONAL,
+  IN UINT16                      *EtherTypePtr OPTIONAL
+  )
+{
+  PP2DXE_CONTEXT *Pp2Context = INSTANCE_FROM_SNP(This);
+  PP2DXE_PORT *Port = &Pp2Context->Port;
+  MVPP2_SHARED *Mvpp2Shared = Pp2Context->Port.Priv;
+  MVPP2_TX_QUEUE *AggrTxq = Mvpp2Shared->AggrTxqs;
+  MVPP2_TX_DESC *TxDesc;
+  UINTN Index;
+  UINT8 *DataPtr = Buffer;
+  UINT16 EtherType;
+  UINT32 State = This->Mode->State;
+  EFI_TPL SavedTpl;
+
+  if (This == NULL || Buffer == NULL) {
+    DEBUG((DEBUG_ERROR, "Pp2Dxe: NULL Snp or Buffer\n"));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (HeaderSize != 0) {
+    ASSERT (HeaderSize == This->Mode->MediaHeaderSize);
+    ASSERT (EtherTypePtr != NULL);
+    ASSERT (DestAddr != NULL);
+  }
+
+  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  /* Check that driver was started and initialised */
+  if (State != EfiSimpleNetworkInitialized) {
+    switch (State) {
+    case EfiSimpleNetworkStopped:
+      DEBUG((DEBUG_WARN, "Pp2Dxe%d: not started\n", Pp2Context->Instance));
+      ReturnUnlock (SavedTpl, EFI_NOT_STARTED);
+    case EfiSimpleNetworkStarted:
+    /* Fall through */
+    default:
+      DEBUG((DEBUG_ERROR, "Pp2Dxe%d: wrong state\n", Pp2Context->Instance));
+      ReturnUnlock (SavedTpl, EFI_DEVICE_ERROR);
+    }
+  }
+
+  if (!This->Mode->MediaPresent) {
+    DEBUG((DEBUG_ERROR, "Pp2Dxe: link not ready\n"));
+    ReturnUnlock(SavedTpl, EFI_NOT_READY);
+  }
+
+  EtherType = HTONS (*EtherTypePtr);
+
+  /*
+   * Do not wait for earlier packets - only make sure there is a free
+   * TXQ descriptor and a completion queue slot for this buffer.
+   */
+  Pp2DxeTxReap (Pp2Context);
+  if (Pp2Context->TxInFlightCount >= MVPP2_MAX_TXD ||
+      QueueCount (Pp2Context) + Pp2Context->TxInFlightCount >= QUEUE_DEPTH - 1) {
+    ReturnUnlock(SavedTpl, EFI_NOT_READY);
+  }
+
+  /* Fetch next descriptor */
+  TxDesc = Mvpp2TxqNextDescGet(AggrTxq);
+
+  if (!TxDesc) {
+    DEBUG((DEBUG_ERROR, "No tx descriptor to use\n"));
+    ReturnUnlock(SavedTpl, EFI_OUT_OF_RESOURCES);
+  }
+
+  if (HeaderSize != 0) {
+    CopyMem(DataPtr, DestAddr, NET_ETHER_ADDR_LEN);
+
+    if (SrcAddr != NULL)
+      CopyMem(DataPtr + NET_ETHER_ADDR_LEN, SrcAddr, NET_ETHER_ADDR_LEN);
+    else
+      CopyMem(DataPtr + NET_ETHER_ADDR_LEN, &This->Mode->CurrentAddress, NET_ETHER_ADDR_LEN);
+
+    CopyMem(DataPtr + NET_ETHER_ADDR_LEN * 2, &EtherType, 2);
+  }
+
+  /* Set descriptor fields */
+  TxDesc->command =  MVPP2_TXD_IP_CSUM_DISABLE | MVPP2_TXD_L4_CSUM_NOT |
+                     MVPP2_TXD_F_DESC | MVPP2_TXD_L_DESC;
+  TxDesc->DataSize = BufferSize;
+  TxDesc->PacketOffset = (PhysAddrT)DataPtr & MVPP2_TX_DESC_ALIGN;
+  Mvpp2x2TxdescPhysAddrSet((PhysAddrT)DataPtr & ~MVPP2_TX_DESC_ALIGN, TxDesc);
+  TxDesc->PhysTxq = Mvpp2TxqPhys(Port->Id, 0);
+
+  InvalidateDataCacheRange (DataPtr, BufferSize);
+
+  /*
+   * Track the buffer until HW reports it sent. Completion is reaped
+   * in Pp2SnpGetStatus, which hands the buffer back to the caller.
+   */
+  Index = (Pp2Context->TxInFlightHead + Pp2Context->TxInFlightCount) % MVPP2_MAX_TXD;
+  Pp2Context->TxInFlight[Index] = Buffer;
+  Pp2Context->TxInFlightCount++;
+
+  /* Issue send */
+  Mvpp2AggrTxqPendDescAdd(Port, 1);
+
+  ReturnUnlock (SavedTpl, EFI_SUCCESS);
+}
@@ -0,0 +1,623 @@
+/** @file
+  Host-based unit tests of the Pp2Dxe transmit path, see Pp2DxeTx.c.
+
+  The PP2 is modelled by an MMIO mock: descriptors are consumed from the
+  aggregated TXQ ring in order, and the TXQ sent counter is cleared when it
+  is read, like the hardware.
+
+  Copyright (c) 2026, agent <agent@local>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <Uefi.h>
+#include <Library/UnitTestLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include "../Mvpp2LibHw.h"
+#include "../Mvpp2Lib.h"
+#include "../Pp2Dxe.h"
+
+#define UNIT_TEST_APP_NAME     "Pp2Dxe Transmit Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define MOCK_PP2_BASE          0x10000000
+#define MOCK_AGGR_TXQ_SIZE     8
+#define MOCK_PACKET_COUNT      QUEUE_DEPTH
+#define MOCK_PACKET_SIZE       128
+#define MOCK_HEADER_SIZE       14
+
+STATIC PP2DXE_CONTEXT           *mPp2Context;
+STATIC EFI_SIMPLE_NETWORK_MODE  mSnpMode;
+STATIC MVPP2_SHARED             mMvpp2Shared;
+STATIC MVPP2_TX_QUEUE           mAggrTxq;
+STATIC MVPP2_TX_QUEUE           mTxq;
+STATIC MVPP2_TX_DESC            mAggrTxDescs[MOCK_AGGR_TXQ_SIZE];
+
+STATIC UINT8                    mPackets[MOCK_PACKET_COUNT][MOCK_PACKET_SIZE];
+STATIC EFI_MAC_ADDRESS          mDestAddr = { { 0x00, 0x51, 0x82, 0x11, 0x22, 0x00 } };
+STATIC UINT16                   mEtherType = 0x0800;
+
+///
+/// Sequence numbers of the packets accepted by Transmit, sent by the
+/// modelled HW and handed back by GetStatus
+///
+STATIC UINTN                    mTxSeq;
+STATIC UINTN                    mHwSeq;
+STATIC UINTN                    mDoneSeq;
+
+///
+/// Modelled HW: aggregated TXQ read index, descriptors added and not yet
+/// fetched, descriptors fetched into the port TXQ and not yet sent, and the
+/// TXQ sent counter
+///
+STATIC INT32                    mHwDescIndex;
+STATIC UINT32                   mHwPending;
+STATIC UINT32                   mHwQueued;
+STATIC UINT32                   mHwSent;
+///
+/// Descriptors the modelled HW sends each time the TXQ sent counter is read
+///
+STATIC UINT32                   mHwSendPerPoll;
+STATIC UINTN                    mHwSentReads;
+STATIC BOOLEAN                  mHwDescMismatch;
+
+STATIC EFI_TPL                  mMockTpl = TPL_APPLICATION;
+STATIC EFI_BOOT_SERVICES        mMockBootServices;
+EFI_BOOT_SERVICES               *gBS = &mMockBootServices;
+
+STATIC
+EFI_TPL
+EFIAPI
+MockRaiseTpl (
+  IN EFI_TPL  NewTpl
+  )
+{
+  EFI_TPL  OldTpl;
+
+  ASSERT (NewTpl >= mMockTpl);
+  OldTpl   = mMockTpl;
+  mMockTpl = NewTpl;
+  return OldTpl;
+}
+
+STATIC
+VOID
+EFIAPI
+MockRestoreTpl (
+  IN EFI_TPL  OldTpl
+  )
+{
+  ASSERT (OldTpl <= mMockTpl);
+  mMockTpl = OldTpl;
+}
+
+/**
+  Size of the packet with the given sequence number, so that the modelled
+  HW can tell the packets apart.
+**/
+STATIC
+UINTN
+MockPacketSize (
+  IN UINTN  Seq
+  )
+{
+  return 64 + (Seq % 64);
+}
+
+/**
+  Move up to Count of the descriptors added to the aggregated TXQ to the port
+  TXQ, checking that each one describes the next packet in transmit order.
+**/
+STATIC
+VOID
+MockHwFetch (
+  IN UINT32  Count
+  )
+{
+  MVPP2_TX_DESC  *TxDesc;
+  UINT8          *Packet;
+  UINT64         PhysAddr;
+
+  while (Count-- > 0 && mHwPending > 0) {
+    TxDesc   = &mAggrTxDescs[mHwDescIndex];
+    Packet   = mPackets[mHwSeq % MOCK_PACKET_COUNT];
+    PhysAddr = (TxDesc->BufPhysAddrHwCmd2 & MVPP22_ADDR_MASK) + TxDesc->PacketOffset;
+    if ((TxDesc->DataSize != MockPacketSize (mHwSeq)) ||
+        (PhysAddr != ((UINT64)(UINTN)Packet & MVPP22_ADDR_MASK)) ||
+        (TxDesc->PhysTxq != mTxq.Id)) {
+      mHwDescMismatch = TRUE;
+    }
+
+    mHwDescIndex = MVPP2_QUEUE_NEXT_DESC (&mAggrTxq, mHwDescIndex);
+    mHwPending--;
+    mHwQueued++;
+    mHwSeq++;
+  }
+}
+
+/**
+  Send up to Count packets, fetching their descriptors first if needed.
+**/
+STATIC
+VOID
+MockHwSend (
+  IN UINT32  Count
+  )
+{
+  MockHwFetch (Count);
+  while (Count-- > 0 && mHwQueued > 0) {
+    mHwQueued--;
+    mHwSent++;
+  }
+}
+
+UINT32
+EFIAPI
+MmioRead32 (
+  IN UINTN  Address
+  )
+{
+  UINT32  Value;
+
+  ASSERT (Address == MOCK_PP2_BASE + MVPP22_TXQ_SENT_REG (mTxq.Id));
+
+  mHwSentReads++;
+  MockHwSend (mHwSendPerPoll);
+
+  //
+  // Reading the sent counter clears it
+  //
+  Value   = (mHwSent << MVPP2_TRANSMITTED_COUNT_OFFSET) & MVPP2_TRANSMITTED_COUNT_MASK;
+  mHwSent = 0;
+  return Value;
+}
+
+UINT32
+EFIAPI
+MmioWrite32 (
+  IN UINTN   Address,
+  IN UINT32  Value
+  )
+{
+  ASSERT (Address == MOCK_PP2_BASE + MVPP2_AGGR_TXQ_UPDATE_REG);
+
+  mHwPending += Value;
+  return Value;
+}
+
+//
+// Mvpp2Lib.c stand-ins, the aggregated TXQ accesses match the real ones
+//
+MVPP2_TX_DESC *
+Mvpp2TxqNextDescGet (
+  MVPP2_TX_QUEUE *Txq
+  )
+{
+  INT32  TxDesc;
+
+  TxDesc              = Txq->NextDescToProc;
+  Txq->NextDescToProc = MVPP2_QUEUE_NEXT_DESC (Txq, TxDesc);
+
+  return Txq->Descs + TxDesc;
+}
+
+VOID
+Mvpp2AggrTxqPendDescAdd (
+  IN PP2DXE_PORT *Port,
+  IN INT32 Pending
+  )
+{
+  Mvpp2Write (Port->Priv, MVPP2_AGGR_TXQ_UPDATE_REG, Pending);
+}
+
+BOOLEAN
+MvGop110PortIsLinkUp (
+  IN PP2DXE_PORT *Port
+  )
+{
+  return TRUE;
+}
+
+/**
+  Transmit the packet with the next sequence number.
+
+  @return  The status returned by Pp2SnpTransmit.
+**/
+STATIC
+EFI_STATUS
+MockTransmit (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = Pp2SnpTransmit (
+             &mPp2Context->Snp,
+             MOCK_HEADER_SIZE,
+             MockPacketSize (mTxSeq),
+             mPackets[mTxSeq % MOCK_PACKET_COUNT],
+             NULL,
+             &mDestAddr,
+             &mEtherType
+             );
+  if (!EFI_ERROR (Status)) {
+    mTxSeq++;
+  }
+
+  return Status;
+}
+
+/**
+  Collect one transmitted buffer through Pp2SnpGetStatus.
+
+  @retval TRUE   The next buffer in transmit order was returned.
+  @retval FALSE  No buffer, or a buffer out of order, was returned.
+**/
+STATIC
+BOOLEAN
+MockCollect (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  VOID        *TxBuf;
+
+  TxBuf  = NULL;
+  Status = Pp2SnpGetStatus (&mPp2Context->Snp, NULL, &TxBuf);
+  if (EFI_ERROR (Status) || (TxBuf != mPackets[mDoneSeq % MOCK_PACKET_COUNT])) {
+    return FALSE;
+  }
+
+  mDoneSeq++;
+  return TRUE;
+}
+
+/**
+  Set up an initialized port whose aggregated TXQ and modelled HW are empty.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED                      The port is ready.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  Out of memory.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ResetPort (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  mMockBootServices.RaiseTPL   = MockRaiseTpl;
+  mMockBootServices.RestoreTPL = MockRestoreTpl;
+  mMockTpl                     = TPL_APPLICATION;
+
+  mPp2Context = AllocateZeroPool (sizeof (PP2DXE_CONTEXT));
+  if (mPp2Context == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  ZeroMem (&mSnpMode, sizeof (mSnpMode));
+  ZeroMem (&mMvpp2Shared, sizeof (mMvpp2Shared));
+  ZeroMem (&mAggrTxq, sizeof (mAggrTxq));
+  ZeroMem (&mTxq, sizeof (mTxq));
+  ZeroMem (mAggrTxDescs, sizeof (mAggrTxDescs));
+
+  mSnpMode.State           = EfiSimpleNetworkInitialized;
+  mSnpMode.MediaHeaderSize = MOCK_HEADER_SIZE;
+  mSnpMode.MediaPresent    = TRUE;
+
+  mAggrTxq.Size     = MOCK_AGGR_TXQ_SIZE;
+  mAggrTxq.Descs    = mAggrTxDescs;
+  mAggrTxq.LastDesc = MOCK_AGGR_TXQ_SIZE - 1;
+  mTxq.Id           = (UINT8)Mvpp2TxqPhys (0, 0);
+
+  mMvpp2Shared.Base     = MOCK_PP2_BASE;
+  mMvpp2Shared.AggrTxqs = &mAggrTxq;
+
+  mPp2Context->Signature     = PP2DXE_SIGNATURE;
+  mPp2Context->Snp.Mode      = &mSnpMode;
+  mPp2Context->Initialized   = TRUE;
+  mPp2Context->Port.Priv     = &mMvpp2Shared;
+  mPp2Context->Port.Txqs     = &mTxq;
+  mPp2Context->Port.AlwaysUp = TRUE;
+
+  mTxSeq          = 0;
+  mHwSeq          = 0;
+  mDoneSeq        = 0;
+  mHwDescIndex    = 0;
+  mHwPending      = 0;
+  mHwQueued       = 0;
+  mHwSent         = 0;
+  mHwSendPerPoll  = 0;
+  mHwSentReads    = 0;
+  mHwDescMismatch = FALSE;
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Release the port set up by ResetPort.
+
+  @param[in] Context  Not used.
+**/
+STATIC
+VOID
+EFIAPI
+FreePort (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  FreePool (mPp2Context);
+  mPp2Context = NULL;
+}
+
+/**
+  Transmit does not wait for the HW, and GetStatus hands the buffers back
+  only once the TXQ sent counter has reported them, in transmit order.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+TestPipelinedTransmit (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < 4; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (MockTransmit ());
+  }
+
+  UT_ASSERT_EQUAL (mHwPending, 4);
+  UT_ASSERT_EQUAL (mPp2Context->TxInFlightCount, 4);
+  UT_ASSERT_FALSE (MockCollect ());
+
+  MockHwSend (3);
+  for (Index = 0; Index < 3; Index++) {
+    UT_ASSERT_TRUE (MockCollect ());
+  }
+
+  UT_ASSERT_FALSE (MockCollect ());
+  UT_ASSERT_EQUAL (mPp2Context->TxInFlightCount, 1);
+
+  MockHwSend (1);
+  UT_ASSERT_TRUE (MockCollect ());
+  UT_ASSERT_FALSE (MockCollect ());
+  UT_ASSERT_FALSE (mHwDescMismatch);
+  UT_ASSERT_EQUAL (mMockTpl, TPL_APPLICATION);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The aggregated TXQ ring and the in-flight ring both wrap around without
+  losing or reordering packets.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+TestRingWrapAround (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Round;
+  UINTN  Index;
+
+  //
+  // 5 packets per round, never more than the aggregated TXQ holds
+  //
+  for (Round = 0; Round < 3 * MVPP2_MAX_TXD / 5; Round++) {
+    for (Index = 0; Index < 5; Index++) {
+      UT_ASSERT_NOT_EFI_ERROR (MockTransmit ());
+    }
+
+    MockHwSend (5);
+    for (Index = 0; Index < 5; Index++) {
+      UT_ASSERT_TRUE (MockCollect ());
+    }
+  }
+
+  UT_ASSERT_TRUE (mTxSeq > 2 * MVPP2_MAX_TXD);
+  UT_ASSERT_EQUAL (mDoneSeq, mTxSeq);
+  UT_ASSERT_EQUAL (mPp2Context->TxInFlightCount, 0);
+  UT_ASSERT_FALSE (mHwDescMismatch);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Transmit returns EFI_NOT_READY, without using a descriptor, when the
+  in-flight ring is full, and accepts packets again once the HW has sent
+  one, without GetStatus being called.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+TestInFlightRingFull (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+  INT32  NextDesc;
+
+  //
+  // The HW keeps the aggregated TXQ empty but sends nothing, so only the
+  // in-flight ring limits Transmit.
+  //
+  for (Index = 0; Index < MVPP2_MAX_TXD; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (MockTransmit ());
+    MockHwFetch (1);
+  }
+
+  NextDesc = mAggrTxq.NextDescToProc;
+  UT_ASSERT_STATUS_EQUAL (MockTransmit (), EFI_NOT_READY);
+  UT_ASSERT_EQUAL (mAggrTxq.NextDescToProc, NextDesc);
+  UT_ASSERT_EQUAL (mPp2Context->TxInFlightCount, MVPP2_MAX_TXD);
+
+  //
+  // Transmit reaps the completion itself
+  //
+  MockHwSend (1);
+  UT_ASSERT_NOT_EFI_ERROR (MockTransmit ());
+  UT_ASSERT_EQUAL (mPp2Context->TxInFlightCount, MVPP2_MAX_TXD);
+  UT_ASSERT_TRUE (MockCollect ());
+  UT_ASSERT_EQUAL (mMockTpl, TPL_APPLICATION);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Transmit returns EFI_NOT_READY when the completion queue could not take
+  the buffers in flight, and every accepted buffer is still handed back.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+TestCompletionQueueFull (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  //
+  // The HW sends every packet right away, but nobody collects them
+  //
+  while (!EFI_ERROR (MockTransmit ())) {
+    MockHwSend (1);
+    UT_ASSERT_TRUE (mTxSeq < 2 * QUEUE_DEPTH);
+  }
+
+  UT_ASSERT_EQUAL (mTxSeq, QUEUE_DEPTH - 1);
+  UT_ASSERT_STATUS_EQUAL (MockTransmit (), EFI_NOT_READY);
+
+  UT_ASSERT_TRUE (MockCollect ());
+  UT_ASSERT_NOT_EFI_ERROR (MockTransmit ());
+  MockHwSend (1);
+
+  for (Index = 1; Index < QUEUE_DEPTH; Index++) {
+    UT_ASSERT_TRUE (MockCollect ());
+  }
+
+  UT_ASSERT_FALSE (MockCollect ());
+  UT_ASSERT_EQUAL (mDoneSeq, QUEUE_DEPTH);
+  UT_ASSERT_FALSE (mHwDescMismatch);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Pp2DxeTxDrain waits for the packets in flight, and gives up after
+  MVPP2_TX_SEND_MAX_POLLING_COUNT polls when the HW makes no progress.
+
+  @param[in] Context  Not used.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+TestShutdownDrain (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < 6; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (MockTransmit ());
+  }
+
+  mHwSendPerPoll = 2;
+  mHwSentReads   = 0;
+  Pp2DxeTxDrain (mPp2Context);
+  UT_ASSERT_EQUAL (mPp2Context->TxInFlightCount, 0);
+  UT_ASSERT_EQUAL (mHwSentReads, 3);
+  for (Index = 0; Index < 6; Index++) {
+    UT_ASSERT_TRUE (MockCollect ());
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (MockTransmit ());
+  mHwSendPerPoll = 0;
+  mHwSentReads   = 0;
+  Pp2DxeTxDrain (mPp2Context);
+  UT_ASSERT_EQUAL (mPp2Context->TxInFlightCount, 1);
+  UT_ASSERT_EQUAL (mHwSentReads, MVPP2_TX_SEND_MAX_POLLING_COUNT + 1);
+  UT_ASSERT_FALSE (mHwDescMismatch);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests, and run them.
+
+  @retval EFI_SUCCESS           All test cases were dispatched.
+  @retval EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      TxTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&TxTests, Framework, "Transmit Path Tests", "Pp2Dxe.Transmit", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for the transmit tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (TxTests, "Transmit does not wait for the HW", "Pipelined", TestPipelinedTransmit, ResetPort, FreePort, NULL);
+  AddTestCase (TxTests, "Descriptor rings wrap around in order", "WrapAround", TestRingWrapAround, ResetPort, FreePort, NULL);
+  AddTestCase (TxTests, "A full in-flight ring pushes back", "InFlightFull", TestInFlightRingFull, ResetPort, FreePort, NULL);
+  AddTestCase (TxTests, "A full completion queue pushes back", "CompletionQueueFull", TestCompletionQueueFull, ResetPort, FreePort, NULL);
+  AddTestCase (TxTests, "Shutdown drain is bounded", "ShutdownDrain", TestShutdownDrain, ResetPort, FreePort, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
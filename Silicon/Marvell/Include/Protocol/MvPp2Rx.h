@@ -0,0 +1,50 @@
+/********************************************************************************
+Copyright (c) 2026, agent <agent@local>
+
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+*******************************************************************************/
+
+#ifndef __MV_PP2_RX_H__
+#define __MV_PP2_RX_H__
+
+#define MARVELL_PP2_RX_PROTOCOL_GUID { 0x27e68355, 0x9196, 0x42c1, { 0x91, 0x6d, 0x32, 0x7b, 0x5f, 0xdd, 0x15, 0xe6 }}
+
+typedef struct _MARVELL_PP2_RX_PROTOCOL MARVELL_PP2_RX_PROTOCOL;
+
+/*
+ * MARVELL_PP2_RX_RECEIVE lends the buffer holding the next received frame
+ * to the caller instead of copying it, as SNP Receive does. *Frame points
+ * to the Ethernet header. The buffer is owned by the controller's buffer
+ * manager and has to be handed back with MARVELL_PP2_RX_RELEASE as soon as
+ * the caller is done with it. The number of frames lent at once is limited,
+ * EFI_OUT_OF_RESOURCES is returned when the limit is reached.
+ * Frames still lent out are reclaimed by the driver when the SNP instance is
+ * stopped, shut down, reset or re-initialized, and at ExitBootServices.
+ */
+typedef
+EFI_STATUS
+(EFIAPI *MARVELL_PP2_RX_RECEIVE) (
+  IN MARVELL_PP2_RX_PROTOCOL *This,
+  OUT VOID **Frame,
+  OUT UINTN *FrameSize
+  );
+
+/*
+ * MARVELL_PP2_RX_RELEASE returns a frame obtained with MARVELL_PP2_RX_RECEIVE
+ * to the buffer manager. Frame must not be accessed afterwards.
+ */
+typedef
+EFI_STATUS
+(EFIAPI *MARVELL_PP2_RX_RELEASE) (
+  IN MARVELL_PP2_RX_PROTOCOL *This,
+  IN VOID *Frame
+  );
+
+struct _MARVELL_PP2_RX_PROTOCOL {
+  MARVELL_PP2_RX_RECEIVE Receive;
+  MARVELL_PP2_RX_RELEASE Release;
+};
+
+extern EFI_GUID gMarvellPp2RxProtocolGuid;
+#endif
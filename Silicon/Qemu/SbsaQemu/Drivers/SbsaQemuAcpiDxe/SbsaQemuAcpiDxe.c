@@ -21,6 +21,13 @@
 #include <Library/UefiLib.h>
 #include <Protocol/AcpiTable.h>
 
+// Offsets of the PPTT processor nodes a cpu belongs to
+typedef struct {
+  UINT32  Socket;
+  UINT32  Cluster;
+  UINT32  Core;
+} PPTT_NODE_OFFSETS;
+
 /*
  * A Function to Compute the ACPI Table Checksum
  */
@@ -294,27 +301,106 @@ AddSsdtTable (
 }
 
 /*
- * A function that adds the SSDT ACPI table.
+ * Update a PPTT cache structure with the properties the device tree gives
+ * for the first cpu. All cores are identical, so this applies to all of them.
+ */
+STATIC
+BOOLEAN
+UpdateCacheFromFdt (
+  IN OUT EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE  *Cache,
+  IN     UINT32                             Level,
+  IN     BOOLEAN                            Instruction
+  )
+{
+  FDT_HELPER_CACHE_INFO  Info;
+
+  if (!FdtHelperGetCpuCacheInfo (0, Level, Instruction, &Info)) {
+    return FALSE;
+  }
+
+  Cache->Size = Info.Size;
+  Cache->NumberOfSets = Info.Sets;
+  Cache->LineSize = (UINT16) Info.LineSize;
+  Cache->Associativity = (UINT8) (Info.Size / (Info.Sets * Info.LineSize));
+
+  return TRUE;
+}
+
+/*
+ * Add a processor hierarchy node to the PPTT and return its offset.
+ */
+STATIC
+UINT32
+AddPpttProcessorNode (
+  IN OUT UINT8                                  **New,
+  IN     UINT8                                  *TableStart,
+  IN     EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR  *Template,
+  IN     UINT32                                 Parent,
+  IN     UINT32                                 AcpiProcessorId,
+  IN     UINT32                                 NumResources,
+  IN     UINT32                                 *Resources
+  )
+{
+  EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *NodePtr;
+  UINT32                                Offset;
+
+  Offset = (UINT32) (*New - TableStart);
+
+  CopyMem (*New, Template, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
+  NodePtr = (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *) *New;
+  NodePtr->Length = sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) +
+                    (NumResources * sizeof (UINT32));
+  NodePtr->Parent = Parent;
+  NodePtr->AcpiProcessorId = AcpiProcessorId;
+  NodePtr->NumberOfPrivateResources = NumResources;
+  *New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
+
+  CopyMem (*New, Resources, NumResources * sizeof (UINT32));
+  *New += NumResources * sizeof (UINT32);
+
+  return Offset;
+}
+
+/*
+ * A function that adds the PPTT ACPI table.
+ *
+ * The processor hierarchy follows the /cpus/cpu-map node of the device tree:
+ * a node per socket, cluster and core, and per thread for SMT cores. L1 and
+ * L2 caches are private to each core; an L3 cache, if the device tree
+ * describes one, is shared by all cores of a socket.
  */
 EFI_STATUS
 AddPpttTable (
   IN EFI_ACPI_TABLE_PROTOCOL   *AcpiTable
   )
 {
-  EFI_STATUS            Status;
-  UINTN                 TableHandle;
-  UINT32                TableSize;
-  EFI_PHYSICAL_ADDRESS  PageAddress;
-  UINT8                 *New;
-  UINT32                CpuId;
-  UINT32                NumCores = PcdGet32 (PcdCoreCount);
+  EFI_STATUS               Status;
+  UINTN                    TableHandle;
+  UINT32                   TableSize;
+  EFI_PHYSICAL_ADDRESS     PageAddress;
+  UINT8                    *New;
+  UINT32                   CpuId;
+  UINT32                   PrevId;
+  UINT32                   NumCores = PcdGet32 (PcdCoreCount);
+  BOOLEAN                  HasL3;
+  FDT_HELPER_CPU_TOPOLOGY  *Topology;
+  PPTT_NODE_OFFSETS        *Offsets;
+  UINT32                   SocketOffset;
+  UINT32                   ClusterOffset;
+  UINT32                   CoreOffset;
+  UINT32                   CoreResources[2] = { L1_D_CACHE_INDEX, L1_I_CACHE_INDEX };
+  UINT32                   SocketResources[1] = { L3_CACHE_INDEX };
 
   EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE L1DCache = SBSAQEMU_ACPI_PPTT_L1_D_CACHE_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE L1ICache = SBSAQEMU_ACPI_PPTT_L1_I_CACHE_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE L2Cache = SBSAQEMU_ACPI_PPTT_L2_CACHE_STRUCT;
+  EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE L3Cache = SBSAQEMU_ACPI_PPTT_L3_CACHE_STRUCT;
 
+  EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Socket = SBSAQEMU_ACPI_PPTT_SOCKET_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Cluster = SBSAQEMU_ACPI_PPTT_CLUSTER_STRUCT;
   EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Core = SBSAQEMU_ACPI_PPTT_CORE_STRUCT;
+  EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR SmtCore = SBSAQEMU_ACPI_PPTT_SMT_CORE_STRUCT;
+  EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR Thread = SBSAQEMU_ACPI_PPTT_THREAD_STRUCT;
 
   EFI_ACPI_DESCRIPTION_HEADER Header =
     SBSAQEMU_ACPI_HEADER (
@@ -322,11 +408,32 @@ AddPpttTable (
       EFI_ACPI_DESCRIPTION_HEADER,
       EFI_ACPI_6_3_PROCESSOR_PROPERTIES_TOPOLOGY_TABLE_REVISION);
 
+  Topology = AllocateZeroPool (NumCores * sizeof (FDT_HELPER_CPU_TOPOLOGY));
+  Offsets = AllocateZeroPool (NumCores * sizeof (PPTT_NODE_OFFSETS));
+  if (Topology == NULL || Offsets == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  // Without a cpu-map, put all cores in a single cluster
+  for (CpuId = 0; CpuId < NumCores; CpuId++) {
+    if (!FdtHelperGetCpuTopology (CpuId, &Topology[CpuId])) {
+      ZeroMem (&Topology[CpuId], sizeof (FDT_HELPER_CPU_TOPOLOGY));
+      Topology[CpuId].Core = CpuId;
+    }
+  }
+
+  // Cache properties default to the values above if not in the device tree
+  UpdateCacheFromFdt (&L1DCache, 1, FALSE);
+  UpdateCacheFromFdt (&L1ICache, 1, TRUE);
+  UpdateCacheFromFdt (&L2Cache, 2, FALSE);
+  HasL3 = UpdateCacheFromFdt (&L3Cache, 3, FALSE);
+
+  // Worst case, every cpu is in its own socket, cluster and core
   TableSize = sizeof (EFI_ACPI_DESCRIPTION_HEADER) +
-    sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) +
-    (sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE) * 3) +
-    (sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) * NumCores) +
-    (sizeof (UINT32) * 2 * NumCores);
+    (sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE) * 4) +
+    (((sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) * 4) +
+      (sizeof (UINT32) * 3)) * NumCores);
 
   Status = gBS->AllocatePages (
                   AllocateAnyPages,
@@ -336,7 +443,8 @@ AddPpttTable (
                   );
   if (EFI_ERROR(Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to allocate pages for PPTT table\n"));
-    return EFI_OUT_OF_RESOURCES;
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
   }
 
   New = (UINT8 *)(UINTN) PageAddress;
@@ -344,13 +452,8 @@ AddPpttTable (
 
   // Add the ACPI Description table header
   CopyMem (New, &Header, sizeof (EFI_ACPI_DESCRIPTION_HEADER));
-  ((EFI_ACPI_DESCRIPTION_HEADER*) New)->Length = TableSize;
   New += sizeof (EFI_ACPI_DESCRIPTION_HEADER);
 
-  // Add the Cluster PPTT structure
-  CopyMem (New, &Cluster, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
-  New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
-
   // Add L1 D Cache structure
   CopyMem (New, &L1DCache, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE));
   ((EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE*) New)->NextLevelOfCache = L2_CACHE_INDEX;
@@ -361,27 +464,76 @@ AddPpttTable (
   ((EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE*) New)->NextLevelOfCache = L2_CACHE_INDEX;
   New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE);
 
-  // Add L2 Cache structure
+  // Add L2 Cache structure. The L3 is not chained to it, since it is
+  // shared at the socket level rather than private to the core.
   CopyMem (New, &L2Cache, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE));
-  ((EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE*) New)->NextLevelOfCache = 0; /* L2 is LLC */
+  ((EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE*) New)->NextLevelOfCache = 0;
   New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE);
 
-  for (CpuId = 0; CpuId < NumCores; CpuId++) {
-    EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *CorePtr;
-    UINT32                                *PrivateResourcePtr;
-
-    CopyMem (New, &Core, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR));
-    CorePtr = (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR *) New;
-    CorePtr->Parent = CLUSTER_INDEX;
-    CorePtr->AcpiProcessorId = CpuId;
-    New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR);
+  // Add L3 Cache structure
+  if (HasL3) {
+    CopyMem (New, &L3Cache, sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE));
+    New += sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE);
+  }
 
-    PrivateResourcePtr = (UINT32 *) New;
-    PrivateResourcePtr[0] = L1_D_CACHE_INDEX;
-    PrivateResourcePtr[1] = L1_I_CACHE_INDEX;
-    New += (2 * sizeof (UINT32));
+  for (CpuId = 0; CpuId < NumCores; CpuId++) {
+    SocketOffset = 0;
+    ClusterOffset = 0;
+    CoreOffset = 0;
+
+    // Reuse the nodes already added for cpus of the same socket, cluster
+    // and core
+    for (PrevId = 0; PrevId < CpuId; PrevId++) {
+      if (Topology[PrevId].Socket != Topology[CpuId].Socket) {
+        continue;
+      }
+      SocketOffset = Offsets[PrevId].Socket;
+      if (Topology[PrevId].Cluster != Topology[CpuId].Cluster) {
+        continue;
+      }
+      ClusterOffset = Offsets[PrevId].Cluster;
+      if (Topology[PrevId].Core != Topology[CpuId].Core) {
+        continue;
+      }
+      CoreOffset = Offsets[PrevId].Core;
+      break;
+    }
+
+    if (SocketOffset == 0) {
+      SocketOffset = AddPpttProcessorNode (&New, (UINT8 *)(UINTN) PageAddress,
+                       &Socket, 0, Topology[CpuId].Socket,
+                       HasL3 ? 1 : 0, SocketResources);
+    }
+
+    if (ClusterOffset == 0) {
+      ClusterOffset = AddPpttProcessorNode (&New, (UINT8 *)(UINTN) PageAddress,
+                        &Cluster, SocketOffset, Topology[CpuId].Cluster,
+                        0, NULL);
+    }
+
+    if (Topology[CpuId].IsThread) {
+      // The caches belong to the core, so that its threads share them
+      if (CoreOffset == 0) {
+        CoreOffset = AddPpttProcessorNode (&New, (UINT8 *)(UINTN) PageAddress,
+                       &SmtCore, ClusterOffset, Topology[CpuId].Core,
+                       2, CoreResources);
+      }
+      AddPpttProcessorNode (&New, (UINT8 *)(UINTN) PageAddress,
+        &Thread, CoreOffset, CpuId, 0, NULL);
+    } else {
+      CoreOffset = AddPpttProcessorNode (&New, (UINT8 *)(UINTN) PageAddress,
+                     &Core, ClusterOffset, CpuId, 2, CoreResources);
+    }
+
+    Offsets[CpuId].Socket = SocketOffset;
+    Offsets[CpuId].Cluster = ClusterOffset;
+    Offsets[CpuId].Core = CoreOffset;
   }
 
+  // Shrink the table to what was actually used
+  TableSize = (UINT32) (New - (UINT8 *)(UINTN) PageAddress);
+  ((EFI_ACPI_DESCRIPTION_HEADER*)(UINTN) PageAddress)->Length = TableSize;
+
   // Perform Checksum
   AcpiPlatformChecksum ((UINT8*) PageAddress, TableSize);
 
@@ -395,6 +547,398 @@ AddPpttTable (
     DEBUG ((DEBUG_ERROR, "Failed to install PPTT table\n"));
   }
 
+Exit:
+  if (Topology != NULL) {
+    FreePool (Topology);
+  }
+  if (Offsets != NULL) {
+    FreePool (Offsets);
+  }
+
+  return Status;
+}
+
+/*
+ * A function that adds the SRAT ACPI table.
+ */
+EFI_STATUS
+AddSratTable (
+  IN EFI_ACPI_TABLE_PROTOCOL   *AcpiTable
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 TableHandle;
+  UINT32                TableSize;
+  EFI_PHYSICAL_ADDRESS  PageAddress;
+  UINT8                 *New;
+  UINT32                NumCores;
+  UINT32                CoreIndex;
+  UINTN                 NumMemNodes;
+  INT32                 FdtNode;
+  UINT64                MemBase;
+  UINT64                MemSize;
+  UINT32                NumaNodeId;
+
+  EFI_ACPI_6_3_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER Header = {
+    SBSAQEMU_ACPI_HEADER (EFI_ACPI_6_3_SYSTEM_RESOURCE_AFFINITY_TABLE_SIGNATURE,
+                          EFI_ACPI_6_3_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER,
+                          EFI_ACPI_6_3_SYSTEM_RESOURCE_AFFINITY_TABLE_REVISION),
+    1, 0 };
+
+  NumCores = PcdGet32 (PcdCoreCount);
+
+  NumMemNodes = 0;
+  FdtNode = -1;
+  while (FdtHelperGetNextMemoryNode (&FdtNode, &MemBase, &MemSize, &NumaNodeId)) {
+    NumMemNodes++;
+  }
+
+  TableSize = sizeof (EFI_ACPI_6_3_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER) +
+              (sizeof (EFI_ACPI_6_3_MEMORY_AFFINITY_STRUCTURE) * NumMemNodes) +
+              (sizeof (EFI_ACPI_6_3_GICC_AFFINITY_STRUCTURE) * NumCores);
+
+  Status = gBS->AllocatePages (
+                  AllocateAnyPages,
+                  EfiACPIReclaimMemory,
+                  EFI_SIZE_TO_PAGES (TableSize),
+                  &PageAddress
+                  );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate pages for SRAT table\n"));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  New = (UINT8 *)(UINTN) PageAddress;
+  ZeroMem (New, TableSize);
+
+  // Add the ACPI Description table header
+  CopyMem (New, &Header, sizeof (EFI_ACPI_6_3_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER));
+  ((EFI_ACPI_DESCRIPTION_HEADER*) New)->Length = TableSize;
+  New += sizeof (EFI_ACPI_6_3_SYSTEM_RESOURCE_AFFINITY_TABLE_HEADER);
+
+  // Add Memory Affinity structures for the memory nodes
+  FdtNode = -1;
+  while (NumMemNodes-- > 0 &&
+         FdtHelperGetNextMemoryNode (&FdtNode, &MemBase, &MemSize, &NumaNodeId)) {
+    EFI_ACPI_6_3_MEMORY_AFFINITY_STRUCTURE *MemAffPtr;
+
+    MemAffPtr = (EFI_ACPI_6_3_MEMORY_AFFINITY_STRUCTURE *) New;
+    MemAffPtr->Type = EFI_ACPI_6_3_MEMORY_AFFINITY;
+    MemAffPtr->Length = sizeof (EFI_ACPI_6_3_MEMORY_AFFINITY_STRUCTURE);
+    MemAffPtr->ProximityDomain = NumaNodeId;
+    MemAffPtr->AddressBaseLow = (UINT32) MemBase;
+    MemAffPtr->AddressBaseHigh = (UINT32) (MemBase >> 32);
+    MemAffPtr->LengthLow = (UINT32) MemSize;
+    MemAffPtr->LengthHigh = (UINT32) (MemSize >> 32);
+    MemAffPtr->Flags = EFI_ACPI_6_3_MEMORY_ENABLED;
+    New += sizeof (EFI_ACPI_6_3_MEMORY_AFFINITY_STRUCTURE);
+  }
+
+  // Add GICC Affinity structures for the Cores
+  for (CoreIndex = 0; CoreIndex < NumCores; CoreIndex++) {
+    EFI_ACPI_6_3_GICC_AFFINITY_STRUCTURE *GiccAffPtr;
+
+    GiccAffPtr = (EFI_ACPI_6_3_GICC_AFFINITY_STRUCTURE *) New;
+    GiccAffPtr->Type = EFI_ACPI_6_3_GICC_AFFINITY;
+    GiccAffPtr->Length = sizeof (EFI_ACPI_6_3_GICC_AFFINITY_STRUCTURE);
+    GiccAffPtr->ProximityDomain = FdtHelperGetCpuNumaNode (CoreIndex);
+    GiccAffPtr->AcpiProcessorUid = CoreIndex;
+    GiccAffPtr->Flags = EFI_ACPI_6_3_GICC_ENABLED;
+    New += sizeof (EFI_ACPI_6_3_GICC_AFFINITY_STRUCTURE);
+  }
+
+  AcpiPlatformChecksum ((UINT8*) PageAddress, TableSize);
+
+  Status = AcpiTable->InstallAcpiTable (
+                        AcpiTable,
+                        (EFI_ACPI_COMMON_HEADER *)PageAddress,
+                        TableSize,
+                        &TableHandle
+                        );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to install SRAT table\n"));
+  }
+
+  return Status;
+}
+
+/*
+ * A function that adds the SLIT ACPI table.
+ */
+EFI_STATUS
+AddSlitTable (
+  IN EFI_ACPI_TABLE_PROTOCOL   *AcpiTable,
+  IN UINT32                    NumNodes
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 TableHandle;
+  UINT32                TableSize;
+  EFI_PHYSICAL_ADDRESS  PageAddress;
+  UINT8                 *New;
+  UINT32                From;
+  UINT32                To;
+
+  EFI_ACPI_6_3_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER Header = {
+    SBSAQEMU_ACPI_HEADER (EFI_ACPI_6_3_SYSTEM_LOCALITY_INFORMATION_TABLE_SIGNATURE,
+                          EFI_ACPI_6_3_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER,
+                          EFI_ACPI_6_3_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_REVISION),
+    0 };
+
+  Header.NumberOfSystemLocalities = NumNodes;
+
+  TableSize = sizeof (EFI_ACPI_6_3_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER) +
+              (NumNodes * NumNodes);
+
+  Status = gBS->AllocatePages (
+                  AllocateAnyPages,
+                  EfiACPIReclaimMemory,
+                  EFI_SIZE_TO_PAGES (TableSize),
+                  &PageAddress
+                  );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate pages for SLIT table\n"));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  New = (UINT8 *)(UINTN) PageAddress;
+  ZeroMem (New, TableSize);
+
+  // Add the ACPI Description table header
+  CopyMem (New, &Header, sizeof (EFI_ACPI_6_3_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER));
+  ((EFI_ACPI_DESCRIPTION_HEADER*) New)->Length = TableSize;
+  New += sizeof (EFI_ACPI_6_3_SYSTEM_LOCALITY_DISTANCE_INFORMATION_TABLE_HEADER);
+
+  // Add the distance matrix, 0xFF marks an unreachable node
+  for (From = 0; From < NumNodes; From++) {
+    for (To = 0; To < NumNodes; To++) {
+      *New++ = (UINT8) MIN (FdtHelperGetNumaDistance (From, To),
+                            SBSAQEMU_SLIT_DISTANCE_MAX);
+    }
+  }
+
+  AcpiPlatformChecksum ((UINT8*) PageAddress, TableSize);
+
+  Status = AcpiTable->InstallAcpiTable (
+                        AcpiTable,
+                        (EFI_ACPI_COMMON_HEADER *)PageAddress,
+                        TableSize,
+                        &TableHandle
+                        );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to install SLIT table\n"));
+  }
+
+  return Status;
+}
+
+/*
+ * A function that adds a System Locality Latency and Bandwidth Information
+ * structure to the HMAT, derived from the NUMA distances.
+ */
+STATIC
+UINT8 *
+AddHmatLocalityInfo (
+  IN UINT8      *New,
+  IN UINT8      DataType,
+  IN UINT32     NumNodes,
+  IN BOOLEAN    *IsInitiator,
+  IN UINT32     NumInitiators,
+  IN BOOLEAN    *IsTarget,
+  IN UINT32     NumTargets
+  )
+{
+  EFI_ACPI_6_3_HMAT_STRUCTURE_SYSTEM_LOCALITY_LATENCY_AND_BANDWIDTH_INFO *InfoPtr;
+  UINT32        *DomainPtr;
+  UINT16        *EntryPtr;
+  UINT32        Initiator;
+  UINT32        Target;
+  UINT32        Distance;
+
+  InfoPtr = (EFI_ACPI_6_3_HMAT_STRUCTURE_SYSTEM_LOCALITY_LATENCY_AND_BANDWIDTH_INFO *) New;
+  InfoPtr->Type = EFI_ACPI_6_3_HMAT_TYPE_SYSTEM_LOCALITY_LATENCY_AND_BANDWIDTH_INFO;
+  InfoPtr->Length = sizeof (EFI_ACPI_6_3_HMAT_STRUCTURE_SYSTEM_LOCALITY_LATENCY_AND_BANDWIDTH_INFO) +
+                    (sizeof (UINT32) * (NumInitiators + NumTargets)) +
+                    (sizeof (UINT16) * NumInitiators * NumTargets);
+  InfoPtr->DataType = DataType;
+  InfoPtr->NumberOfInitiatorProximityDomains = NumInitiators;
+  InfoPtr->NumberOfTargetProximityDomains = NumTargets;
+  InfoPtr->EntryBaseUnit = (DataType == SBSAQEMU_HMAT_DATA_TYPE_ACCESS_LATENCY) ?
+                             SBSAQEMU_HMAT_LATENCY_UNIT : SBSAQEMU_HMAT_BANDWIDTH_UNIT;
+  New += sizeof (EFI_ACPI_6_3_HMAT_STRUCTURE_SYSTEM_LOCALITY_LATENCY_AND_BANDWIDTH_INFO);
+
+  // Initiator and Target Proximity Domain lists
+  DomainPtr = (UINT32 *) New;
+  for (Initiator = 0; Initiator < NumNodes; Initiator++) {
+    if (IsInitiator[Initiator]) {
+      *DomainPtr++ = Initiator;
+    }
+  }
+  for (Target = 0; Target < NumNodes; Target++) {
+    if (IsTarget[Target]) {
+      *DomainPtr++ = Target;
+    }
+  }
+
+  // Entries, one row per Initiator
+  EntryPtr = (UINT16 *) DomainPtr;
+  for (Initiator = 0; Initiator < NumNodes; Initiator++) {
+    if (!IsInitiator[Initiator]) {
+      continue;
+    }
+    for (Target = 0; Target < NumNodes; Target++) {
+      if (!IsTarget[Target]) {
+        continue;
+      }
+      Distance = MAX (FdtHelperGetNumaDistance (Initiator, Target), 1);
+      if (DataType == SBSAQEMU_HMAT_DATA_TYPE_ACCESS_LATENCY) {
+        *EntryPtr++ = (UINT16) MIN ((SBSAQEMU_HMAT_LOCAL_LATENCY * Distance) /
+                                      SBSAQEMU_HMAT_LOCAL_DISTANCE, MAX_UINT16 - 1);
+      } else {
+        *EntryPtr++ = (UINT16) MIN ((SBSAQEMU_HMAT_LOCAL_BANDWIDTH * SBSAQEMU_HMAT_LOCAL_DISTANCE) /
+                                      Distance, MAX_UINT16 - 1);
+      }
+    }
+  }
+
+  return (UINT8 *) EntryPtr;
+}
+
+/*
+ * A function that adds the HMAT ACPI table.
+ */
+EFI_STATUS
+AddHmatTable (
+  IN EFI_ACPI_TABLE_PROTOCOL   *AcpiTable,
+  IN UINT32                    NumNodes
+  )
+{
+  EFI_STATUS            Status;
+  UINTN                 TableHandle;
+  UINT32                TableSize;
+  UINT32                LocalityInfoSize;
+  EFI_PHYSICAL_ADDRESS  PageAddress;
+  UINT8                 *New;
+  BOOLEAN               *IsInitiator;
+  BOOLEAN               *IsTarget;
+  UINT32                NumInitiators;
+  UINT32                NumTargets;
+  UINT32                CoreIndex;
+  UINT32                Node;
+  INT32                 FdtNode;
+  UINT64                MemBase;
+  UINT64                MemSize;
+  UINT32                NumaNodeId;
+
+  EFI_ACPI_6_3_HETEROGENEOUS_MEMORY_ATTRIBUTE_TABLE_HEADER Header = {
+    SBSAQEMU_ACPI_HEADER (EFI_ACPI_6_3_HETEROGENEOUS_MEMORY_ATTRIBUTE_TABLE_SIGNATURE,
+                          EFI_ACPI_6_3_HETEROGENEOUS_MEMORY_ATTRIBUTE_TABLE_HEADER,
+                          EFI_ACPI_6_3_HETEROGENEOUS_MEMORY_ATTRIBUTE_TABLE_REVISION),
+    { EFI_ACPI_RESERVED_BYTE, EFI_ACPI_RESERVED_BYTE,
+      EFI_ACPI_RESERVED_BYTE, EFI_ACPI_RESERVED_BYTE } };
+
+  IsInitiator = AllocateZeroPool (NumNodes * sizeof (BOOLEAN));
+  IsTarget = AllocateZeroPool (NumNodes * sizeof (BOOLEAN));
+  if (IsInitiator == NULL || IsTarget == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  // Nodes with cores are initiators, nodes with memory are targets
+  for (CoreIndex = 0; CoreIndex < PcdGet32 (PcdCoreCount); CoreIndex++) {
+    Node = FdtHelperGetCpuNumaNode (CoreIndex);
+    if (Node < NumNodes) {
+      IsInitiator[Node] = TRUE;
+    }
+  }
+  FdtNode = -1;
+  while (FdtHelperGetNextMemoryNode (&FdtNode, &MemBase, &MemSize, &NumaNodeId)) {
+    if (NumaNodeId < NumNodes) {
+      IsTarget[NumaNodeId] = TRUE;
+    }
+  }
+
+  NumInitiators = 0;
+  NumTargets = 0;
+  for (Node = 0; Node < NumNodes; Node++) {
+    NumInitiators += IsInitiator[Node] ? 1 : 0;
+    NumTargets += IsTarget[Node] ? 1 : 0;
+  }
+
+  LocalityInfoSize = sizeof (EFI_ACPI_6_3_HMAT_STRUCTURE_SYSTEM_LOCALITY_LATENCY_AND_BANDWIDTH_INFO) +
+                     (sizeof (UINT32) * (NumInitiators + NumTargets)) +
+                     (sizeof (UINT16) * NumInitiators * NumTargets);
+
+  // Memory Proximity Domain Attributes for each target, plus latency and
+  // bandwidth information
+  TableSize = sizeof (EFI_ACPI_6_3_HETEROGENEOUS_MEMORY_ATTRIBUTE_TABLE_HEADER) +
+              (sizeof (EFI_ACPI_6_3_HMAT_STRUCTURE_MEMORY_PROXIMITY_DOMAIN_ATTRIBUTES) * NumTargets) +
+              (LocalityInfoSize * 2);
+
+  Status = gBS->AllocatePages (
+                  AllocateAnyPages,
+                  EfiACPIReclaimMemory,
+                  EFI_SIZE_TO_PAGES (TableSize),
+                  &PageAddress
+                  );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate pages for HMAT table\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  New = (UINT8 *)(UINTN) PageAddress;
+  ZeroMem (New, TableSize);
+
+  // Add the ACPI Description table header
+  CopyMem (New, &Header, sizeof (EFI_ACPI_6_3_HETEROGENEOUS_MEMORY_ATTRIBUTE_TABLE_HEADER));
+  ((EFI_ACPI_DESCRIPTION_HEADER*) New)->Length = TableSize;
+  New += sizeof (EFI_ACPI_6_3_HETEROGENEOUS_MEMORY_ATTRIBUTE_TABLE_HEADER);
+
+  // Memory attached to a node with cores is local to those cores
+  for (Node = 0; Node < NumNodes; Node++) {
+    EFI_ACPI_6_3_HMAT_STRUCTURE_MEMORY_PROXIMITY_DOMAIN_ATTRIBUTES *AttrPtr;
+
+    if (!IsTarget[Node]) {
+      continue;
+    }
+
+    AttrPtr = (EFI_ACPI_6_3_HMAT_STRUCTURE_MEMORY_PROXIMITY_DOMAIN_ATTRIBUTES *) New;
+    AttrPtr->Type = EFI_ACPI_6_3_HMAT_TYPE_MEMORY_PROXIMITY_DOMAIN_ATTRIBUTES;
+    AttrPtr->Length = sizeof (EFI_ACPI_6_3_HMAT_STRUCTURE_MEMORY_PROXIMITY_DOMAIN_ATTRIBUTES);
+    if (IsInitiator[Node]) {
+      AttrPtr->Flags.InitiatorProximityDomainValid = 1;
+      AttrPtr->InitiatorProximityDomain = Node;
+    }
+    AttrPtr->MemoryProximityDomain = Node;
+    New += sizeof (EFI_ACPI_6_3_HMAT_STRUCTURE_MEMORY_PROXIMITY_DOMAIN_ATTRIBUTES);
+  }
+
+  New = AddHmatLocalityInfo (New, SBSAQEMU_HMAT_DATA_TYPE_ACCESS_LATENCY, NumNodes,
+          IsInitiator, NumInitiators, IsTarget, NumTargets);
+  New = AddHmatLocalityInfo (New, SBSAQEMU_HMAT_DATA_TYPE_ACCESS_BANDWIDTH, NumNodes,
+          IsInitiator, NumInitiators, IsTarget, NumTargets);
+
+  AcpiPlatformChecksum ((UINT8*) PageAddress, TableSize);
+
+  Status = AcpiTable->InstallAcpiTable (
+                        AcpiTable,
+                        (EFI_ACPI_COMMON_HEADER *)PageAddress,
+                        TableSize,
+                        &TableHandle
+                        );
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to install HMAT table\n"));
+  }
+
+Exit:
+  if (IsInitiator != NULL) {
+    FreePool (IsInitiator);
+  }
+  if (IsTarget != NULL) {
+    FreePool (IsTarget);
+  }
+
   return Status;
 }
 
@@ -408,6 +952,7 @@ InitializeSbsaQemuAcpiDxe (
   EFI_STATUS                     Status;
   EFI_ACPI_TABLE_PROTOCOL        *AcpiTable;
   UINT32                         NumCores;
+  UINT32                         NumNodes;
 
   // Parse the device tree and get the number of CPUs
   NumCores = FdtHelperCountCpus ();
@@ -440,5 +985,24 @@ InitializeSbsaQemuAcpiDxe (
     DEBUG ((DEBUG_ERROR, "Failed to add PPTT table\n"));
   }
 
+  // Describe the NUMA topology if Qemu was started with several nodes
+  NumNodes = FdtHelperCountNumaNodes ();
+  if (NumNodes > 1) {
+    Status = AddSratTable (AcpiTable);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to add SRAT table\n"));
+    }
+
+    Status = AddSlitTable (AcpiTable, NumNodes);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to add SLIT table\n"));
+    }
+
+    Status = AddHmatTable (AcpiTable, NumNodes);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to add HMAT table\n"));
+    }
+  }
+
   return EFI_SUCCESS;
 }
@@ -37,6 +37,21 @@
    SBSAQEMU_MADT_GICR_SIZE                   /* DiscoveryRangeLength */        \
    }
 
+// Defines for SLIT
+#define SBSAQEMU_SLIT_DISTANCE_MAX       0xFF
+
+// Defines for HMAT
+#define SBSAQEMU_HMAT_DATA_TYPE_ACCESS_LATENCY    0
+#define SBSAQEMU_HMAT_DATA_TYPE_ACCESS_BANDWIDTH  3
+
+// Qemu does not model memory performance, so HMAT reports nominal values
+// for a NUMA distance of 10, scaled by the distance between the nodes.
+#define SBSAQEMU_HMAT_LOCAL_LATENCY      100    /* ns */
+#define SBSAQEMU_HMAT_LOCAL_BANDWIDTH    16000  /* MB/s */
+#define SBSAQEMU_HMAT_LOCAL_DISTANCE     10
+#define SBSAQEMU_HMAT_LATENCY_UNIT       1000   /* ps */
+#define SBSAQEMU_HMAT_BANDWIDTH_UNIT     1      /* MB/s */
+
 #define SBSAQEMU_ACPI_SCOPE_OP_MAX_LENGTH 5
 
 #define SBSAQEMU_ACPI_SCOPE_NAME         { '_', 'S', 'B', '_' }
@@ -75,10 +90,16 @@ typedef struct {
 #define SBSAQEMU_L2_CACHE_SETS           1024
 #define SBSAQEMU_L2_CACHE_ASSC           8
 
-#define CLUSTER_INDEX    (sizeof (EFI_ACPI_DESCRIPTION_HEADER))
-#define L1_D_CACHE_INDEX (CLUSTER_INDEX + sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR))
+#define SBSAQEMU_L3_CACHE_SIZE           SIZE_8MB
+#define SBSAQEMU_L3_CACHE_SETS           8192
+#define SBSAQEMU_L3_CACHE_ASSC           16
+
+// The cache structures directly follow the PPTT header, the processor
+// hierarchy nodes come after them.
+#define L1_D_CACHE_INDEX (sizeof (EFI_ACPI_DESCRIPTION_HEADER))
 #define L1_I_CACHE_INDEX (L1_D_CACHE_INDEX + sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE))
 #define L2_CACHE_INDEX   (L1_I_CACHE_INDEX + sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE))
+#define L3_CACHE_INDEX   (L2_CACHE_INDEX + sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE))
 
 #define SBSAQEMU_ACPI_PPTT_L1_D_CACHE_STRUCT {                                 \
     EFI_ACPI_6_3_PPTT_TYPE_CACHE,                                              \
@@ -155,7 +176,32 @@ typedef struct {
     64            /* LineSize */                                               \
   }
 
-#define SBSAQEMU_ACPI_PPTT_CLUSTER_STRUCT  {                                   \
+#define SBSAQEMU_ACPI_PPTT_L3_CACHE_STRUCT  {                                  \
+    EFI_ACPI_6_3_PPTT_TYPE_CACHE,                                              \
+    sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_CACHE),                                \
+    { EFI_ACPI_RESERVED_BYTE, EFI_ACPI_RESERVED_BYTE },                        \
+    {                                                                          \
+      1,                     /* SizePropertyValid */                           \
+      1,                     /* NumberOfSetsValid */                           \
+      1,                     /* AssociativityValid */                          \
+      1,                     /* AllocationTypeValid */                         \
+      1,                     /* CacheTypeValid */                              \
+      1,                     /* WritePolicyValid */                            \
+      1,                     /* LineSizeValid */                               \
+    },                                                                         \
+    0,                       /* NextLevelOfCache */                            \
+    SBSAQEMU_L3_CACHE_SIZE,  /* Size */                                        \
+    SBSAQEMU_L3_CACHE_SETS,  /* NumberOfSets */                                \
+    SBSAQEMU_L3_CACHE_ASSC,  /* Associativity */                               \
+    {                                                                          \
+      EFI_ACPI_6_2_CACHE_ATTRIBUTES_ALLOCATION_READ_WRITE,                     \
+      EFI_ACPI_6_2_CACHE_ATTRIBUTES_CACHE_TYPE_UNIFIED,                        \
+      EFI_ACPI_6_2_CACHE_ATTRIBUTES_WRITE_POLICY_WRITE_BACK,                   \
+    },                                                                         \
+    64            /* LineSize */                                               \
+  }
+
+#define SBSAQEMU_ACPI_PPTT_SOCKET_STRUCT  {                                    \
     EFI_ACPI_6_3_PPTT_TYPE_PROCESSOR,                                          \
     sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR),                            \
     { EFI_ACPI_RESERVED_BYTE, EFI_ACPI_RESERVED_BYTE },                        \
@@ -171,6 +217,22 @@ typedef struct {
     0,                                        /* NumberOfPrivateResources */   \
   }
 
+#define SBSAQEMU_ACPI_PPTT_CLUSTER_STRUCT  {                                   \
+    EFI_ACPI_6_3_PPTT_TYPE_PROCESSOR,                                          \
+    sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR),                            \
+    { EFI_ACPI_RESERVED_BYTE, EFI_ACPI_RESERVED_BYTE },                        \
+    {                                                                          \
+      EFI_ACPI_6_3_PPTT_PACKAGE_NOT_PHYSICAL,     /* PhysicalPackage */        \
+      EFI_ACPI_6_3_PPTT_PROCESSOR_ID_INVALID,     /* AcpiProcessorIdValid */   \
+      EFI_ACPI_6_3_PPTT_PROCESSOR_IS_NOT_THREAD,  /* Is not a Thread */        \
+      EFI_ACPI_6_3_PPTT_NODE_IS_NOT_LEAF,         /* Not Leaf */               \
+      EFI_ACPI_6_3_PPTT_IMPLEMENTATION_IDENTICAL, /* Identical Cores */        \
+    },                                                                         \
+    0,                                        /* Parent */                     \
+    0,                                        /* AcpiProcessorId */            \
+    0,                                        /* NumberOfPrivateResources */   \
+  }
+
 #define SBSAQEMU_ACPI_PPTT_CORE_STRUCT  {                                      \
     EFI_ACPI_6_3_PPTT_TYPE_PROCESSOR,                                          \
     (sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) + (2 * sizeof (UINT32))),  \
@@ -187,4 +249,37 @@ typedef struct {
     2,                                        /* NumberOfPrivateResources */   \
   }
 
+// Core of an SMT processor, its threads are the leaf nodes
+#define SBSAQEMU_ACPI_PPTT_SMT_CORE_STRUCT  {                                  \
+    EFI_ACPI_6_3_PPTT_TYPE_PROCESSOR,                                          \
+    (sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR) + (2 * sizeof (UINT32))),  \
+    { EFI_ACPI_RESERVED_BYTE, EFI_ACPI_RESERVED_BYTE },                        \
+    {                                                                          \
+      EFI_ACPI_6_3_PPTT_PACKAGE_NOT_PHYSICAL,     /* PhysicalPackage */        \
+      EFI_ACPI_6_3_PPTT_PROCESSOR_ID_INVALID,     /* AcpiProcessorIdValid */   \
+      EFI_ACPI_6_3_PPTT_PROCESSOR_IS_NOT_THREAD,  /* Is not a Thread */        \
+      EFI_ACPI_6_3_PPTT_NODE_IS_NOT_LEAF,         /* Not Leaf */               \
+      EFI_ACPI_6_3_PPTT_IMPLEMENTATION_IDENTICAL, /* Identical Cores */        \
+    },                                                                         \
+    0,                                        /* Parent */                     \
+    0,                                        /* AcpiProcessorId */            \
+    2,                                        /* NumberOfPrivateResources */   \
+  }
+
+#define SBSAQEMU_ACPI_PPTT_THREAD_STRUCT  {                                    \
+    EFI_ACPI_6_3_PPTT_TYPE_PROCESSOR,                                          \
+    sizeof (EFI_ACPI_6_3_PPTT_STRUCTURE_PROCESSOR),                            \
+    { EFI_ACPI_RESERVED_BYTE, EFI_ACPI_RESERVED_BYTE },                        \
+    {                                                                          \
+      EFI_ACPI_6_3_PPTT_PACKAGE_NOT_PHYSICAL,     /* PhysicalPackage */        \
+      EFI_ACPI_6_3_PPTT_PROCESSOR_ID_VALID,       /* AcpiProcessorValid */     \
+      EFI_ACPI_6_3_PPTT_PROCESSOR_IS_THREAD,      /* Is a Thread */            \
+      EFI_ACPI_6_3_PPTT_NODE_IS_LEAF,             /* Leaf */                   \
+      EFI_ACPI_6_3_PPTT_IMPLEMENTATION_IDENTICAL, /* Identical Cores */        \
+    },                                                                         \
+    0,                                        /* Parent */                     \
+    0,                                        /* AcpiProcessorId */            \
+    0,                                        /* NumberOfPrivateResources */   \
+  }
+
 #endif
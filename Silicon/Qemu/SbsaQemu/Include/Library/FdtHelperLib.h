@@ -10,6 +10,22 @@
 #ifndef FDT_HELPER_LIB_
 #define FDT_HELPER_LIB_
 
+// Position of a cpu in the /cpus/cpu-map topology of the device tree
+typedef struct {
+  UINT32   Socket;
+  UINT32   Cluster;
+  UINT32   Core;
+  UINT32   Thread;
+  BOOLEAN  IsThread;     // The cpu is a thread of an SMT core
+} FDT_HELPER_CPU_TOPOLOGY;
+
+// Cache properties from the device tree
+typedef struct {
+  UINT32   Size;
+  UINT32   Sets;
+  UINT32   LineSize;
+} FDT_HELPER_CACHE_INFO;
+
 /**
   Get MPIDR for a given cpu from device tree passed by Qemu.
 
@@ -25,6 +41,9 @@ FdtHelperGetMpidr (
 /** Walks through the Device Tree created by Qemu and counts the number
     of CPUs present in it.
 
+    The cpu nodes are parsed on the first call and the result is kept for
+    the lookups by cpu index.
+
     @return The number of CPUs present.
 **/
 EFIAPI
@@ -33,4 +52,126 @@ FdtHelperCountCpus (
   VOID
   );
 
+/**
+  Get the NUMA node of a given cpu from device tree passed by Qemu.
+
+  @param [in]   CpuId    Index of cpu to retrieve the NUMA node for.
+
+  @retval                Value of the numa-node-id property of the cpu,
+                         0 if the property is not present.
+**/
+UINT32
+FdtHelperGetCpuNumaNode (
+  IN UINTN   CpuId
+  );
+
+/**
+  Get the next memory node from device tree passed by Qemu. Walking all
+  memory nodes this way costs a single pass over the device tree.
+
+  @param [in, out]  Node        Memory node to continue the search after, -1
+                                to start from the root. Updated to the node
+                                found.
+  @param [out]      Base        Base address of the memory node.
+  @param [out]      Size        Size of the memory node.
+  @param [out]      NumaNodeId  Value of the numa-node-id property of the
+                                memory node, 0 if the property is not present.
+
+  @retval TRUE                  A memory node was found.
+  @retval FALSE                 There are no more memory nodes.
+**/
+BOOLEAN
+FdtHelperGetNextMemoryNode (
+  IN OUT INT32    *Node,
+  OUT    UINT64   *Base,
+  OUT    UINT64   *Size,
+  OUT    UINT32   *NumaNodeId
+  );
+
+/**
+  Get a memory node from device tree passed by Qemu.
+
+  @param [in]   Index       Index of the memory node to retrieve.
+  @param [out]  Base        Base address of the memory node.
+  @param [out]  Size        Size of the memory node.
+  @param [out]  NumaNodeId  Value of the numa-node-id property of the memory
+                            node, 0 if the property is not present.
+
+  @retval TRUE              The memory node was found.
+  @retval FALSE             There are less than Index + 1 memory nodes.
+**/
+BOOLEAN
+FdtHelperGetMemoryNode (
+  IN  UINTN    Index,
+  OUT UINT64   *Base,
+  OUT UINT64   *Size,
+  OUT UINT32   *NumaNodeId
+  );
+
+/** Walks through the cpu and memory nodes of the Device Tree created by Qemu
+    and counts the number of NUMA nodes they refer to.
+
+    @return The number of NUMA nodes, 1 if no numa-node-id is present.
+**/
+UINT32
+FdtHelperCountNumaNodes (
+  VOID
+  );
+
+/**
+  Get the distance between two NUMA nodes from the distance-map node of the
+  device tree passed by Qemu.
+
+  @param [in]   From     NUMA node the distance is measured from.
+  @param [in]   To       NUMA node the distance is measured to.
+
+  @retval                Distance between the nodes. If the device tree does
+                         not provide it, 10 for a node to itself and 20 for
+                         any other node, as assumed by the ACPI SLIT.
+**/
+UINT32
+FdtHelperGetNumaDistance (
+  IN UINT32  From,
+  IN UINT32  To
+  );
+
+/**
+  Get the position of a given cpu in the /cpus/cpu-map node of the device tree
+  passed by Qemu.
+
+  @param [in]   CpuId     Index of cpu to retrieve the topology for.
+  @param [out]  Topology  Socket, cluster, core and thread of the cpu. Levels
+                          not present in the cpu-map are 0.
+
+  @retval TRUE            The cpu was found in the cpu-map.
+  @retval FALSE           There is no cpu-map or the cpu is not part of it.
+**/
+BOOLEAN
+FdtHelperGetCpuTopology (
+  IN  UINTN                    CpuId,
+  OUT FDT_HELPER_CPU_TOPOLOGY  *Topology
+  );
+
+/**
+  Get the properties of a cache of a given cpu from the device tree passed by
+  Qemu. Level 1 caches are described in the cpu node, further levels in the
+  nodes reached through next-level-cache.
+
+  @param [in]   CpuId        Index of cpu to retrieve the cache for.
+  @param [in]   Level        Cache level, starting at 1.
+  @param [in]   Instruction  For level 1, TRUE for the instruction cache and
+                             FALSE for the data cache. Ignored otherwise.
+  @param [out]  Info         Size, number of sets and line size of the cache.
+
+  @retval TRUE               The cache is described in the device tree.
+  @retval FALSE              The cache is not described.
+**/
+BOOLEAN
+FdtHelperGetCpuCacheInfo (
+  IN  UINTN                  CpuId,
+  IN  UINT32                 Level,
+  IN  BOOLEAN                Instruction,
+  OUT FDT_HELPER_CACHE_INFO  *Info
+  );
+
 #endif /* FDT_HELPER_LIB_ */
@@ -9,13 +9,302 @@
 **/
 
 #include <Uefi.h>
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/FdtHelperLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
 #include <libfdt.h>
 
-STATIC INT32 mFdtFirstCpuOffset;
-STATIC INT32 mFdtCpuNodeSize;
+// Levels of the /cpus/cpu-map node, from the outermost one
+#define CPU_MAP_LEVEL_SOCKET     0
+#define CPU_MAP_LEVEL_CLUSTER    1
+#define CPU_MAP_LEVEL_CORE       2
+#define CPU_MAP_LEVEL_THREAD     3
+#define CPU_MAP_LEVELS           4
+
+STATIC CONST CHAR8 *mCpuMapLevelNames[CPU_MAP_LEVELS] = {
+  "socket", "cluster", "core", "thread"
+};
+
+// Distances the ACPI SLIT assumes when no distance-map is present
+#define NUMA_DISTANCE_LOCAL      10
+#define NUMA_DISTANCE_REMOTE     20
+
+// Properties of a cpu node, gathered once when the cpu table is built
+typedef struct {
+  INT32                    Node;
+  UINT32                   Phandle;
+  UINT64                   Mpidr;
+  UINT32                   NumaNodeId;
+  BOOLEAN                  HasTopology;
+  FDT_HELPER_CPU_TOPOLOGY  Topology;
+} FDT_HELPER_CPU_ENTRY;
+
+STATIC FDT_HELPER_CPU_ENTRY  *mCpuTable;
+STATIC UINT32                mCpuCount;
+
+/**
+  Read a 32-bit property of a device tree node.
+
+  @param [in]   DeviceTreeBase  Base of the device tree blob.
+  @param [in]   Node            Node to read the property from.
+  @param [in]   Name            Name of the property.
+
+  @retval                       Value of the property, 0 if not present.
+**/
+STATIC
+UINT32
+FdtHelperGetU32Prop (
+  IN VOID         *DeviceTreeBase,
+  IN INT32        Node,
+  IN CONST CHAR8  *Name
+  )
+{
+  CONST UINT32  *Prop;
+  INT32         Len;
+
+  Prop = fdt_getprop (DeviceTreeBase, Node, Name, &Len);
+  if (!Prop || Len != sizeof (UINT32)) {
+    return 0;
+  }
+
+  return fdt32_to_cpu (ReadUnaligned32 (Prop));
+}
+
+/**
+  Check whether a subnode of /cpus describes a cpu. The cpu-map node, for
+  instance, lives next to the cpu nodes.
+
+  @param [in]   DeviceTreeBase  Base of the device tree blob.
+  @param [in]   Node            Node to check.
+
+  @retval TRUE                  The node is a cpu node.
+  @retval FALSE                 The node is not a cpu node.
+**/
+STATIC
+BOOLEAN
+FdtHelperIsCpuNode (
+  IN VOID   *DeviceTreeBase,
+  IN INT32  Node
+  )
+{
+  CONST CHAR8  *Type;
+  INT32        Len;
+
+  Type = fdt_getprop (DeviceTreeBase, Node, "device_type", &Len);
+  return (Type != NULL && Len == sizeof ("cpu") &&
+          AsciiStrCmp (Type, "cpu") == 0);
+}
+
+/**
+  Look up the cpu table entry of a cpu node by its phandle.
+
+  cpu-map leaves normally list the cpus in the order of the cpu nodes, so the
+  search starts right after the previous match and usually succeeds at once.
+
+  @param [in]       Phandle  Phandle of the cpu node.
+  @param [in, out]  Hint     Index of the previous match, updated on success.
+
+  @retval                    The cpu table entry, NULL if there is none.
+**/
+STATIC
+FDT_HELPER_CPU_ENTRY *
+FdtHelperFindCpuByPhandle (
+  IN     UINT32  Phandle,
+  IN OUT UINT32  *Hint
+  )
+{
+  UINT32  Count;
+  UINT32  Index;
+
+  Index = *Hint;
+  for (Count = 0; Count < mCpuCount; Count++) {
+    Index = (Index + 1) % mCpuCount;
+    if (mCpuTable[Index].Phandle == Phandle) {
+      *Hint = Index;
+      return &mCpuTable[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Walk a cpu-map node and record the position of every cpu it refers to in
+  the cpu table.
+
+  @param [in]       DeviceTreeBase  Base of the device tree blob.
+  @param [in]       Node            cpu-map node to walk.
+  @param [in, out]  Ids             Index at each level of the map of the node
+                                    being walked.
+  @param [in, out]  Hint            Index of the last cpu found in the map.
+**/
+STATIC
+VOID
+FdtHelperWalkCpuMap (
+  IN     VOID    *DeviceTreeBase,
+  IN     INT32   Node,
+  IN OUT UINT32  *Ids,
+  IN OUT UINT32  *Hint
+  )
+{
+  FDT_HELPER_CPU_ENTRY  *Entry;
+  CONST CHAR8           *Name;
+  CONST UINT32          *CpuProp;
+  INT32                 Child;
+  INT32                 Len;
+  UINTN                 Level;
+  UINTN                 Index;
+  UINTN                 NameLen;
+
+  for (Child = fdt_first_subnode (DeviceTreeBase, Node);
+       Child >= 0;
+       Child = fdt_next_subnode (DeviceTreeBase, Child)) {
+    Name = fdt_get_name (DeviceTreeBase, Child, NULL);
+    if (Name == NULL) {
+      continue;
+    }
+
+    // Nodes are named after their level and index, e.g. "core3"
+    for (Level = 0; Level < CPU_MAP_LEVELS; Level++) {
+      NameLen = AsciiStrLen (mCpuMapLevelNames[Level]);
+      if (AsciiStrnCmp (Name, mCpuMapLevelNames[Level], NameLen) == 0) {
+        break;
+      }
+    }
+    if (Level == CPU_MAP_LEVELS) {
+      continue;
+    }
+
+    // Levels below this one may hold indexes of the previous branch
+    Ids[Level] = (UINT32)AsciiStrDecimalToUintn (Name + NameLen);
+    for (Index = Level + 1; Index < CPU_MAP_LEVELS; Index++) {
+      Ids[Index] = 0;
+    }
+
+    CpuProp = fdt_getprop (DeviceTreeBase, Child, "cpu", &Len);
+    if (!CpuProp || Len != sizeof (UINT32)) {
+      FdtHelperWalkCpuMap (DeviceTreeBase, Child, Ids, Hint);
+      continue;
+    }
+
+    Entry = FdtHelperFindCpuByPhandle (fdt32_to_cpu (ReadUnaligned32 (CpuProp)),
+              Hint);
+    if (Entry == NULL) {
+      DEBUG ((DEBUG_WARN, "cpu-map node %a refers to an unknown cpu\n", Name));
+      continue;
+    }
+
+    Entry->Topology.Socket   = Ids[CPU_MAP_LEVEL_SOCKET];
+    Entry->Topology.Cluster  = Ids[CPU_MAP_LEVEL_CLUSTER];
+    Entry->Topology.Core     = Ids[CPU_MAP_LEVEL_CORE];
+    Entry->Topology.Thread   = Ids[CPU_MAP_LEVEL_THREAD];
+    Entry->Topology.IsThread = (Level == CPU_MAP_LEVEL_THREAD);
+    Entry->HasTopology       = TRUE;
+  }
+}
+
+/**
+  Build the cpu table from the device tree passed by Qemu, unless this was
+  already done.
+
+  The /cpus subnodes are not necessarily of the same size, so every property
+  needed to index the cpus is read here, once, rather than locating the cpu
+  node again on each lookup.
+
+  @retval TRUE    The cpu table is available.
+  @retval FALSE   The device tree has no /cpus node or memory ran out.
+**/
+STATIC
+BOOLEAN
+FdtHelperBuildCpuTable (
+  VOID
+  )
+{
+  VOID                  *DeviceTreeBase;
+  FDT_HELPER_CPU_ENTRY  *Entry;
+  CONST UINT32          *RegVal;
+  INT32                 CpuNode;
+  INT32                 CpuMap;
+  INT32                 Node;
+  INT32                 Len;
+  UINT32                CpuCount;
+  UINT32                Ids[CPU_MAP_LEVELS];
+  UINT32                Hint;
+
+  if (mCpuTable != NULL) {
+    return TRUE;
+  }
+
+  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
+  ASSERT (DeviceTreeBase != NULL);
+
+  // Make sure we have a valid device tree blob
+  ASSERT (fdt_check_header (DeviceTreeBase) == 0);
+
+  CpuNode = fdt_path_offset (DeviceTreeBase, "/cpus");
+  if (CpuNode <= 0) {
+    DEBUG ((DEBUG_ERROR, "Unable to locate /cpus in device tree\n"));
+    return FALSE;
+  }
+
+  CpuCount = 0;
+  for (Node = fdt_first_subnode (DeviceTreeBase, CpuNode);
+       Node >= 0;
+       Node = fdt_next_subnode (DeviceTreeBase, Node)) {
+    if (FdtHelperIsCpuNode (DeviceTreeBase, Node)) {
+      CpuCount++;
+    }
+  }
+
+  if (CpuCount == 0) {
+    DEBUG ((DEBUG_ERROR, "No cpu nodes found below /cpus\n"));
+    return FALSE;
+  }
+
+  mCpuTable = AllocateZeroPool (CpuCount * sizeof (FDT_HELPER_CPU_ENTRY));
+  if (mCpuTable == NULL) {
+    DEBUG ((DEBUG_ERROR, "Unable to allocate the cpu table\n"));
+    return FALSE;
+  }
+
+  Entry = mCpuTable;
+  for (Node = fdt_first_subnode (DeviceTreeBase, CpuNode);
+       Node >= 0;
+       Node = fdt_next_subnode (DeviceTreeBase, Node)) {
+    if (!FdtHelperIsCpuNode (DeviceTreeBase, Node)) {
+      continue;
+    }
+
+    Entry->Node       = Node;
+    Entry->Phandle    = fdt_get_phandle (DeviceTreeBase, Node);
+    Entry->NumaNodeId = FdtHelperGetU32Prop (DeviceTreeBase, Node, "numa-node-id");
+
+    // Qemu uses two cells for the cpu address, older trees may use one.
+    RegVal = fdt_getprop (DeviceTreeBase, Node, "reg", &Len);
+    if (RegVal && Len == sizeof (UINT64)) {
+      Entry->Mpidr = fdt64_to_cpu (ReadUnaligned64 ((CONST UINT64 *)RegVal));
+    } else if (RegVal && Len == sizeof (UINT32)) {
+      Entry->Mpidr = fdt32_to_cpu (ReadUnaligned32 (RegVal));
+    } else {
+      DEBUG ((DEBUG_ERROR, "Couldn't find reg property for CPU:%d\n",
+        (UINT32)(Entry - mCpuTable)));
+    }
+
+    Entry++;
+  }
+  mCpuCount = CpuCount;
+
+  CpuMap = fdt_path_offset (DeviceTreeBase, "/cpus/cpu-map");
+  if (CpuMap >= 0) {
+    ZeroMem (Ids, sizeof (Ids));
+    Hint = CpuCount - 1;
+    FdtHelperWalkCpuMap (DeviceTreeBase, CpuMap, Ids, &Hint);
+  }
+
+  return TRUE;
+}
 
 /**
   Get MPIDR for a given cpu from device tree passed by Qemu.
@@ -29,28 +318,20 @@ FdtHelperGetMpidr (
   IN UINTN   CpuId
   )
 {
-  VOID           *DeviceTreeBase;
-  CONST UINT64   *RegVal;
-  INT32          Len;
-
-  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
-  ASSERT (DeviceTreeBase != NULL);
-
-  RegVal = fdt_getprop (DeviceTreeBase,
-             mFdtFirstCpuOffset + (CpuId * mFdtCpuNodeSize),
-             "reg",
-             &Len);
-  if (!RegVal) {
-    DEBUG ((DEBUG_ERROR, "Couldn't find reg property for CPU:%d\n", CpuId));
+  if (!FdtHelperBuildCpuTable () || CpuId >= mCpuCount) {
+    DEBUG ((DEBUG_ERROR, "Couldn't get MPIDR for CPU:%d (CPU table not built or index out of range)\n", CpuId));
     return 0;
   }
 
-  return (fdt64_to_cpu (ReadUnaligned64 (RegVal)));
+  return mCpuTable[CpuId].Mpidr;
 }
 
 /** Walks through the Device Tree created by Qemu and counts the number
     of CPUs present in it.
 
+    The cpu nodes are parsed on the first call and the result is kept for
+    the lookups by cpu index.
+
     @return The number of CPUs present.
 **/
 EFIAPI
@@ -59,40 +340,298 @@ FdtHelperCountCpus (
   VOID
   )
 {
-  VOID   *DeviceTreeBase;
-  INT32  Node;
-  INT32  Prev;
-  INT32  CpuNode;
-  UINT32 CpuCount;
+  if (!FdtHelperBuildCpuTable ()) {
+    return 0;
+  }
+
+  return mCpuCount;
+}
+
+/**
+  Get the NUMA node of a given cpu from device tree passed by Qemu.
+
+  @param [in]   CpuId    Index of cpu to retrieve the NUMA node for.
+
+  @retval                Value of the numa-node-id property of the cpu,
+                         0 if the property is not present.
+**/
+UINT32
+FdtHelperGetCpuNumaNode (
+  IN UINTN   CpuId
+  )
+{
+  if (!FdtHelperBuildCpuTable () || CpuId >= mCpuCount) {
+    return 0;
+  }
+
+  return mCpuTable[CpuId].NumaNodeId;
+}
+
+/**
+  Get the next memory node from device tree passed by Qemu. Walking all
+  memory nodes this way costs a single pass over the device tree.
+
+  @param [in, out]  Node        Memory node to continue the search after, -1
+                                to start from the root. Updated to the node
+                                found.
+  @param [out]      Base        Base address of the memory node.
+  @param [out]      Size        Size of the memory node.
+  @param [out]      NumaNodeId  Value of the numa-node-id property of the
+                                memory node, 0 if the property is not present.
+
+  @retval TRUE                  A memory node was found.
+  @retval FALSE                 There are no more memory nodes.
+**/
+BOOLEAN
+FdtHelperGetNextMemoryNode (
+  IN OUT INT32    *Node,
+  OUT    UINT64   *Base,
+  OUT    UINT64   *Size,
+  OUT    UINT32   *NumaNodeId
+  )
+{
+  VOID           *DeviceTreeBase;
+  CONST UINT64   *RegProp;
+  CONST UINT32   *NodeId;
+  INT32          Len;
+
+  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
+  ASSERT (DeviceTreeBase != NULL);
+
+  for (;;) {
+    *Node = fdt_node_offset_by_prop_value (DeviceTreeBase, *Node,
+              "device_type", "memory", sizeof ("memory"));
+    if (*Node < 0) {
+      return FALSE;
+    }
+
+    // Qemu uses two 8 byte quantities for base and size, respectively.
+    RegProp = fdt_getprop (DeviceTreeBase, *Node, "reg", &Len);
+    if (RegProp && Len == (2 * sizeof (UINT64))) {
+      break;
+    }
+
+    DEBUG ((DEBUG_ERROR, "Couldn't parse reg property of memory node\n"));
+  }
+
+  *Base = fdt64_to_cpu (ReadUnaligned64 (RegProp));
+  *Size = fdt64_to_cpu (ReadUnaligned64 (RegProp + 1));
+
+  NodeId = fdt_getprop (DeviceTreeBase, *Node, "numa-node-id", &Len);
+  if (NodeId && Len == sizeof (UINT32)) {
+    *NumaNodeId = fdt32_to_cpu (ReadUnaligned32 (NodeId));
+  } else {
+    *NumaNodeId = 0;
+  }
+
+  return TRUE;
+}
+
+/**
+  Get a memory node from device tree passed by Qemu.
+
+  @param [in]   Index       Index of the memory node to retrieve.
+  @param [out]  Base        Base address of the memory node.
+  @param [out]  Size        Size of the memory node.
+  @param [out]  NumaNodeId  Value of the numa-node-id property of the memory
+                            node, 0 if the property is not present.
+
+  @retval TRUE              The memory node was found.
+  @retval FALSE             There are less than Index + 1 memory nodes.
+**/
+BOOLEAN
+FdtHelperGetMemoryNode (
+  IN  UINTN    Index,
+  OUT UINT64   *Base,
+  OUT UINT64   *Size,
+  OUT UINT32   *NumaNodeId
+  )
+{
+  INT32          Node;
+
+  Node = -1;
+  do {
+    if (!FdtHelperGetNextMemoryNode (&Node, Base, Size, NumaNodeId)) {
+      return FALSE;
+    }
+  } while (Index-- > 0);
+
+  return TRUE;
+}
+
+/** Walks through the cpu and memory nodes of the Device Tree created by Qemu
+    and counts the number of NUMA nodes they refer to.
+
+    @return The number of NUMA nodes, 1 if no numa-node-id is present.
+**/
+UINT32
+FdtHelperCountNumaNodes (
+  VOID
+  )
+{
+  UINT32  NodeCount;
+  UINT32  NumaNodeId;
+  UINT32  CpuCount;
+  UINT32  CpuId;
+  UINT64  Base;
+  UINT64  Size;
+  INT32   Node;
+
+  NodeCount = 1;
+
+  CpuCount = FdtHelperCountCpus ();
+  for (CpuId = 0; CpuId < CpuCount; CpuId++) {
+    NumaNodeId = FdtHelperGetCpuNumaNode (CpuId);
+    if (NumaNodeId >= NodeCount) {
+      NodeCount = NumaNodeId + 1;
+    }
+  }
+
+  Node = -1;
+  while (FdtHelperGetNextMemoryNode (&Node, &Base, &Size, &NumaNodeId)) {
+    if (NumaNodeId >= NodeCount) {
+      NodeCount = NumaNodeId + 1;
+    }
+  }
+
+  return NodeCount;
+}
+
+/**
+  Get the distance between two NUMA nodes from the distance-map node of the
+  device tree passed by Qemu.
+
+  @param [in]   From     NUMA node the distance is measured from.
+  @param [in]   To       NUMA node the distance is measured to.
+
+  @retval                Distance between the nodes. If the device tree does
+                         not provide it, 10 for a node to itself and 20 for
+                         any other node, as assumed by the ACPI SLIT.
+**/
+UINT32
+FdtHelperGetNumaDistance (
+  IN UINT32  From,
+  IN UINT32  To
+  )
+{
+  VOID           *DeviceTreeBase;
+  CONST UINT32   *Matrix;
+  INT32          Node;
+  INT32          Len;
+  UINTN          Index;
 
   DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
   ASSERT (DeviceTreeBase != NULL);
 
-  // Make sure we have a valid device tree blob
-  ASSERT (fdt_check_header (DeviceTreeBase) == 0);
+  Node = fdt_path_offset (DeviceTreeBase, "/distance-map");
+  if (Node >= 0) {
+    // The matrix is a list of <from to distance> triplets. An entry may be
+    // given in one direction only, in which case it applies to both.
+    Matrix = fdt_getprop (DeviceTreeBase, Node, "distance-matrix", &Len);
+    for (Index = 0; Matrix && (Index + 3) * sizeof (UINT32) <= (UINTN)Len; Index += 3) {
+      if ((fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index])) == From &&
+           fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index + 1])) == To) ||
+          (fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index])) == To &&
+           fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index + 1])) == From)) {
+        return fdt32_to_cpu (ReadUnaligned32 (&Matrix[Index + 2]));
+      }
+    }
+  }
 
-  CpuNode = fdt_path_offset (DeviceTreeBase, "/cpus");
-  if (CpuNode <= 0) {
-    DEBUG ((DEBUG_ERROR, "Unable to locate /cpus in device tree\n"));
-    return 0;
+  return (From == To) ? NUMA_DISTANCE_LOCAL : NUMA_DISTANCE_REMOTE;
+}
+
+/**
+  Get the position of a given cpu in the /cpus/cpu-map node of the device tree
+  passed by Qemu.
+
+  @param [in]   CpuId     Index of cpu to retrieve the topology for.
+  @param [out]  Topology  Socket, cluster, core and thread of the cpu. Levels
+                          not present in the cpu-map are 0.
+
+  @retval TRUE            The cpu was found in the cpu-map.
+  @retval FALSE           There is no cpu-map or the cpu is not part of it.
+**/
+BOOLEAN
+FdtHelperGetCpuTopology (
+  IN  UINTN                    CpuId,
+  OUT FDT_HELPER_CPU_TOPOLOGY  *Topology
+  )
+{
+  if (!FdtHelperBuildCpuTable () || CpuId >= mCpuCount ||
+      !mCpuTable[CpuId].HasTopology) {
+    return FALSE;
   }
 
-  CpuCount = 0;
+  *Topology = mCpuTable[CpuId].Topology;
+
+  return TRUE;
+}
+
+/**
+  Get the properties of a cache of a given cpu from the device tree passed by
+  Qemu. Level 1 caches are described in the cpu node, further levels in the
+  nodes reached through next-level-cache.
+
+  @param [in]   CpuId        Index of cpu to retrieve the cache for.
+  @param [in]   Level        Cache level, starting at 1.
+  @param [in]   Instruction  For level 1, TRUE for the instruction cache and
+                             FALSE for the data cache. Ignored otherwise.
+  @param [out]  Info         Size, number of sets and line size of the cache.
 
-  // Walk through /cpus node and count the number of subnodes.
-  // The count of these subnodes corresponds to the number of
-  // CPUs created by Qemu.
-  Prev = fdt_first_subnode (DeviceTreeBase, CpuNode);
-  mFdtFirstCpuOffset = Prev;
-  while (1) {
-    CpuCount++;
-    Node = fdt_next_subnode (DeviceTreeBase, Prev);
+  @retval TRUE               The cache is described in the device tree.
+  @retval FALSE              The cache is not described.
+**/
+BOOLEAN
+FdtHelperGetCpuCacheInfo (
+  IN  UINTN                  CpuId,
+  IN  UINT32                 Level,
+  IN  BOOLEAN                Instruction,
+  OUT FDT_HELPER_CACHE_INFO  *Info
+  )
+{
+  VOID    *DeviceTreeBase;
+  INT32   Node;
+  UINT32  CurrentLevel;
+  UINT32  Phandle;
+
+  if (!FdtHelperBuildCpuTable () || CpuId >= mCpuCount) {
+    return FALSE;
+  }
+
+  DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
+  ASSERT (DeviceTreeBase != NULL);
+
+  Node = mCpuTable[CpuId].Node;
+
+  if (Level == 1) {
+    if (Instruction) {
+      Info->Size     = FdtHelperGetU32Prop (DeviceTreeBase, Node, "i-cache-size");
+      Info->Sets     = FdtHelperGetU32Prop (DeviceTreeBase, Node, "i-cache-sets");
+      Info->LineSize = FdtHelperGetU32Prop (DeviceTreeBase, Node, "i-cache-line-size");
+    } else {
+      Info->Size     = FdtHelperGetU32Prop (DeviceTreeBase, Node, "d-cache-size");
+      Info->Sets     = FdtHelperGetU32Prop (DeviceTreeBase, Node, "d-cache-sets");
+      Info->LineSize = FdtHelperGetU32Prop (DeviceTreeBase, Node, "d-cache-line-size");
+    }
+    return (Info->Size != 0 && Info->Sets != 0 && Info->LineSize != 0);
+  }
+
+  // Follow the next-level-cache chain from the cpu node
+  for (CurrentLevel = 2; CurrentLevel <= Level; CurrentLevel++) {
+    Phandle = FdtHelperGetU32Prop (DeviceTreeBase, Node, "next-level-cache");
+    if (Phandle == 0) {
+      return FALSE;
+    }
+    Node = fdt_node_offset_by_phandle (DeviceTreeBase, Phandle);
     if (Node < 0) {
-      break;
+      return FALSE;
     }
-    mFdtCpuNodeSize = Node - Prev;
-    Prev = Node;
   }
 
-  return CpuCount;
+  Info->Size     = FdtHelperGetU32Prop (DeviceTreeBase, Node, "cache-size");
+  Info->Sets     = FdtHelperGetU32Prop (DeviceTreeBase, Node, "cache-sets");
+  Info->LineSize = FdtHelperGetU32Prop (DeviceTreeBase, Node, "cache-line-size");
+
+  return (Info->Size != 0 && Info->Sets != 0 && Info->LineSize != 0);
 }
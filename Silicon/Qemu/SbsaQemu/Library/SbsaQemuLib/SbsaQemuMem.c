@@ -10,6 +10,7 @@
 #include <Library/ArmLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/FdtHelperLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
 #include <libfdt.h>
@@ -17,6 +18,9 @@
 // Number of Virtual Memory Map Descriptors
 #define MAX_VIRTUAL_MEMORY_MAP_DESCRIPTORS          4
 
+// Number of memory nodes considered, Qemu creates one per NUMA node
+#define MAX_MEMORY_NODES                            128
+
 RETURN_STATUS
 EFIAPI
 SbsaQemuLibConstructor (
@@ -24,16 +28,22 @@ SbsaQemuLibConstructor (
   )
 {
   VOID          *DeviceTreeBase;
-  INT32         Node, Prev;
+  INT32         Node;
   UINT64        NewBase, CurBase;
   UINT64        NewSize, CurSize;
-  CONST CHAR8   *Type;
-  INT32         Len;
-  CONST UINT64  *RegProp;
+  UINT64        NodeBase[MAX_MEMORY_NODES];
+  UINT64        NodeSize[MAX_MEMORY_NODES];
+  UINT32        NumaNodeId;
+  UINTN         NodeCount;
+  UINTN         SortedCount;
+  UINTN         CoveredCount;
+  UINTN         Index;
   RETURN_STATUS PcdStatus;
 
   NewBase = 0;
   NewSize = 0;
+  NodeCount = 0;
+  SortedCount = 0;
 
   DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
   ASSERT (DeviceTreeBase != NULL);
@@ -41,38 +51,47 @@ SbsaQemuLibConstructor (
   // Make sure we have a valid device tree blob
   ASSERT (fdt_check_header (DeviceTreeBase) == 0);
 
-  // Look for the lowest memory node
-  for (Prev = 0;; Prev = Node) {
-    Node = fdt_next_node (DeviceTreeBase, Prev, NULL);
-    if (Node < 0) {
-      break;
+  // With NUMA, Qemu creates one memory node per NUMA node. Walk them once
+  // and keep them sorted by base address.
+  Node = -1;
+  while (FdtHelperGetNextMemoryNode (&Node, &CurBase, &CurSize, &NumaNodeId)) {
+    DEBUG ((DEBUG_INFO, "%a: System RAM @ 0x%lx - 0x%lx (NUMA node %u)\n",
+      __FUNCTION__, CurBase, CurBase + CurSize - 1, NumaNodeId));
+
+    NodeCount++;
+    if (CurSize == 0 || SortedCount == MAX_MEMORY_NODES) {
+      continue;
     }
 
-    // Check for memory node
-    Type = fdt_getprop (DeviceTreeBase, Node, "device_type", &Len);
-    if (Type && AsciiStrnCmp (Type, "memory", Len) == 0) {
-      // Get the 'reg' property of this node. For now, we will assume
-      // two 8 byte quantities for base and size, respectively.
-      RegProp = fdt_getprop (DeviceTreeBase, Node, "reg", &Len);
-      if (RegProp != 0 && Len == (2 * sizeof (UINT64))) {
-
-        CurBase = fdt64_to_cpu (ReadUnaligned64 (RegProp));
-        CurSize = fdt64_to_cpu (ReadUnaligned64 (RegProp + 1));
-
-        DEBUG ((DEBUG_INFO, "%a: System RAM @ 0x%lx - 0x%lx\n",
-          __FUNCTION__, CurBase, CurBase + CurSize - 1));
-
-        if (NewBase > CurBase || NewBase == 0) {
-          NewBase = CurBase;
-          NewSize = CurSize;
-        }
-      } else {
-        DEBUG ((DEBUG_ERROR, "%a: Failed to parse FDT memory node\n",
-          __FUNCTION__));
+    for (Index = SortedCount; Index > 0 && NodeBase[Index - 1] > CurBase; Index--) {
+      NodeBase[Index] = NodeBase[Index - 1];
+      NodeSize[Index] = NodeSize[Index - 1];
+    }
+    NodeBase[Index] = CurBase;
+    NodeSize[Index] = CurSize;
+    SortedCount++;
+  }
+
+  // The memory of the other NUMA nodes follows the lowest one. Grow the
+  // system memory region for as long as another node starts where it ends,
+  // so that all DRAM is described, not just the first node.
+  CoveredCount = 0;
+  if (SortedCount > 0) {
+    NewBase = NodeBase[0];
+    NewSize = NodeSize[0];
+    for (CoveredCount = 1; CoveredCount < SortedCount; CoveredCount++) {
+      if (NodeBase[CoveredCount] != NewBase + NewSize) {
+        break;
       }
+      NewSize += NodeSize[CoveredCount];
     }
   }
 
+  if (CoveredCount != NodeCount) {
+    DEBUG ((DEBUG_WARN, "%a: %u memory node(s) not contiguous with System RAM ignored\n",
+      __FUNCTION__, NodeCount - CoveredCount));
+  }
+
   // Make sure the start of DRAM matches our expectation
   ASSERT (FixedPcdGet64 (PcdSystemMemoryBase) == NewBase);
   PcdStatus = PcdSet64S (PcdSystemMemorySize, NewSize);